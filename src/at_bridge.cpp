@@ -0,0 +1,175 @@
+#include "at_bridge.h"
+#include "bt1036_at.h"
+#include "bt_webui.h"
+#include "ring_buffer.h"
+
+static AtbSink        g_sink    = nullptr;
+static AtBridgeStats  g_stats   = {};
+
+// Строки от клиента; front() — та, что сейчас в драйвере (если g_ticket)
+static SpscRing<String, ATB_MAX_PENDING> g_lines;
+static uint32_t       g_ticket  = 0;
+static uint32_t       g_sentMs  = 0;
+static uint32_t       g_inputMs = 0;   // последний ввод (таймаут простоя)
+
+// Байты UART от bt1036_loop() до отправки
+static SpscRing<char, 1024> g_rx;
+static uint32_t       g_flushMs   = 0;
+static uint32_t       g_dropShown = 0;  // rxDropped на момент последнего сообщения
+
+static void say(const String &msg) {
+    if (!g_sink) return;
+    if (!g_sink(msg.c_str(), msg.length())) g_stats.sinkFails++;
+}
+
+static void onRxByte(char c) {
+    g_stats.rxBytes++;
+    if (!g_rx.push(c)) g_stats.rxDropped++;
+}
+
+bool atb_open(AtbSink sink) {
+    if (g_sink) return false;
+    g_sink      = sink;
+    g_ticket    = 0;
+    g_lines.clear();
+    g_rx.clear();
+    g_inputMs   = millis();
+    g_flushMs   = g_inputMs;
+    g_dropShown = g_stats.rxDropped;
+    g_stats.opens++;
+
+    bt1036_setRxTap(onRxByte);
+    bt1036_setBackgroundPoll(false);
+    btWebUI_log("[BT] AT bridge open", LogLevel::INFO);
+    say("[ATB] open, background poll paused");
+    return true;
+}
+
+void atb_close(const char *reason) {
+    if (!g_sink) return;
+    say(String("[ATB] closed: ") + reason);
+    bt1036_setRxTap(nullptr);
+    bt1036_setBackgroundPoll(true);
+    g_sink   = nullptr;
+    g_ticket = 0;    // команда в драйвере доработает сама
+    g_lines.clear();
+    g_rx.clear();
+    btWebUI_log(String("[BT] AT bridge closed: ") + reason, LogLevel::INFO);
+}
+
+bool atb_active() {
+    return g_sink != nullptr;
+}
+
+bool atb_submit(const String &lineIn) {
+    if (!g_sink) return false;
+    String line = lineIn;
+    line.trim();
+    g_inputMs = millis();
+
+    if (line.length() < 2 || !(line[0] == 'A' || line[0] == 'a') || !(line[1] == 'T' || line[1] == 't')) {
+        say("[ATB] not an AT command: " + line);
+        return false;
+    }
+    if (line.length() > ATB_MAX_LINE) {
+        say("[ATB] too long (max " + String(ATB_MAX_LINE) + ")");
+        return false;
+    }
+    if (!g_lines.push(line)) {
+        g_stats.busy++;
+        say("[ATB] busy: " + line);
+        return false;
+    }
+    return true;
+}
+
+// Принятые байты → "[ATR] ...": печатные как есть, \r \n \t тоже,
+// остальное \xHH (sendTXT требует валидный UTF-8)
+static void flushRx(uint32_t now) {
+    if (g_rx.empty()) return;
+    if (g_rx.size() < ATB_CHUNK && now - g_flushMs < ATB_FLUSH_MS) return;
+    g_flushMs = now;
+
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    String msg;
+    msg.reserve(6 + ATB_CHUNK + 16);
+    msg = "[ATR] ";
+    char c;
+    for (uint16_t n = 0; n < ATB_CHUNK && g_rx.pop(c); ++n) {
+        uint8_t b = (uint8_t)c;
+        if (b == '\\') {
+            msg += "\\\\";
+        } else if ((b >= 0x20 && b < 0x7F) || b == '\r' || b == '\n' || b == '\t') {
+            msg += c;
+        } else {
+            msg += "\\x";
+            msg += HEX_DIGITS[b >> 4];
+            msg += HEX_DIGITS[b & 15];
+        }
+    }
+    g_stats.chunks++;
+    say(msg);
+
+    if (g_stats.rxDropped != g_dropShown) {
+        say("[ATB] rx overflow: " + String(g_stats.rxDropped - g_dropShown) + " bytes dropped");
+        g_dropShown = g_stats.rxDropped;
+    }
+}
+
+void atb_poll() {
+    if (!g_sink) return;
+    uint32_t now = millis();
+
+    // результат команды в работе
+    if (g_ticket) {
+        BtCmdResult r = bt1036_cmdResult(g_ticket);
+        if (r != BtCmdResult::PENDING) {
+            uint32_t ms = now - g_sentMs;
+            g_stats.lastMs = ms;
+            if (ms > g_stats.maxMs) g_stats.maxMs = ms;
+            if (r == BtCmdResult::OK)           g_stats.ok++;
+            else if (r == BtCmdResult::TIMEOUT) g_stats.timeouts++;
+            else                                g_stats.errors++;
+
+            // сначала всё, что модуль успел прислать до OK/ERROR
+            g_flushMs = now - ATB_FLUSH_MS;
+            flushRx(now);
+
+            String done;
+            g_lines.pop(done);
+            say("[ATB] " + done + " -> " + bt1036_cmdResultName(r) + " (" + String(ms) + " ms)");
+            g_ticket = 0;
+        }
+    }
+
+    // следующая — только когда драйвер свободен: не мешаем его командам
+    // и не пишем в UART, пока модуль отвечает
+    if (!g_ticket && !g_lines.empty() && bt1036_isIdle()) {
+        const String &cmd = *g_lines.front();
+        bt1036_sendRaw(cmd);
+        g_ticket = bt1036_lastTicket();
+        g_sentMs = now;
+        if (g_ticket) {
+            g_stats.commands++;
+        } else {
+            String lost;
+            g_lines.pop(lost);
+            g_stats.errors++;
+            say("[ATB] " + lost + " -> DROPPED (driver queue full)");
+        }
+    }
+
+    flushRx(now);
+
+    if (!g_ticket && g_lines.empty() && now - g_inputMs >= ATB_IDLE_MS) {
+        atb_close("idle");
+    }
+}
+
+const AtBridgeStats &atb_getStats() {
+    return g_stats;
+}
+
+uint8_t atb_pending() {
+    return (uint8_t)g_lines.size();
+}
@@ -0,0 +1,67 @@
+/**
+ * @file at_bridge.h
+ * @brief Live AT terminal to the BT1036 over the WebSocket
+ *
+ * One client at a time owns the bridge. Lines it types go into the
+ * driver's own command queue (bt1036_sendRaw), so quirks, timeouts and
+ * the driver's state parsing keep working; every byte the module sends
+ * back is streamed to the owner as it arrives.
+ *
+ * Flow control:
+ *   - UART: one bridge command in flight, sent only when the driver is
+ *     idle; at most ATB_MAX_PENDING typed lines wait, the next one is
+ *     answered "[ATB] busy" and not queued;
+ *   - WebSocket: received bytes are batched into chunks of at most
+ *     ATB_CHUNK bytes, no more often than every ATB_FLUSH_MS; what doesn't
+ *     fit the RX ring meanwhile is dropped and counted.
+ *
+ * While the bridge is open the driver's background A2DPSTAT/DEVSTAT poll
+ * is paused, so the only traffic on the UART is what the user typed (plus
+ * whatever the firmware itself queues). An idle bridge closes after
+ * ATB_IDLE_MS.
+ *
+ * Owner → firmware (WS text):  "ATB open", "ATB close", "AT..." lines.
+ * Firmware → owner:            "[ATB] ..." status / command results,
+ *                              "[ATR] ..." raw received bytes.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+static const uint8_t  ATB_MAX_PENDING = 8;       // строк от клиента в очереди моста
+static const uint16_t ATB_MAX_LINE    = 128;     // длина одной команды
+static const uint16_t ATB_CHUNK       = 256;     // байт UART в одном WS сообщении
+static const uint32_t ATB_FLUSH_MS    = 20;      // не чаще одного сообщения [ATR]
+static const uint32_t ATB_IDLE_MS     = 300000;  // без ввода — закрыть мост
+
+// Отправка владельцу моста; false — сообщение потеряно (учитывается)
+typedef bool (*AtbSink)(const char *msg, size_t len);
+
+struct AtBridgeStats {
+    uint32_t opens;
+    uint32_t commands;    // отправлено в драйвер
+    uint32_t ok;
+    uint32_t errors;      // ERROR / SKIPPED / DROPPED
+    uint32_t timeouts;
+    uint32_t busy;        // отклонено: очередь моста полна
+    uint32_t rxBytes;
+    uint32_t rxDropped;   // не влезло в кольцо до отправки
+    uint32_t chunks;      // сообщений [ATR]
+    uint32_t sinkFails;   // sink вернул false
+    uint32_t lastMs;      // ответ на последнюю команду
+    uint32_t maxMs;
+};
+
+// false — мост уже открыт
+bool atb_open(AtbSink sink);
+void atb_close(const char *reason);
+bool atb_active();
+
+// Строка от владельца. false — не принята (причина уже отправлена в sink)
+bool atb_submit(const String &line);
+
+// Отправка следующей команды, результаты, поток принятых байт
+void atb_poll();
+
+const AtBridgeStats &atb_getStats();
+uint8_t atb_pending();  // строк ждёт отправки (включая ту, что в работе)
@@ -1,60 +1,234 @@
 #include "bt1036_at.h"
 #include "bt_webui.h"  // для btWebUI_log() и LogLevel
-#include "vw_cdc.h"    // для cdc_setPlayTime()
+#include "timer_wheel.h"
+#include "ring_buffer.h"
 
 static HardwareSerial *bt = nullptr;
 
 // ---------- очередь команд ----------
-static const size_t   CMD_QUEUE_SIZE    = 10;
-static String         cmdQueue[CMD_QUEUE_SIZE];
-static uint8_t        queueHead         = 0;
-static uint8_t        queueTail         = 0;
+static SpscRing<String, 16> cmdQueue;
+// Результаты выполненных команд по номеру (номер = позиция в очереди + 1)
+static BtCmdResult    cmdResults[16];
+static bool           cmdRaw[16];          // строка пользователя (AT-мост): таймауты не учим
+static uint32_t       lastTicket        = 0;
 static bool           cmdInProgress     = false;
-static uint32_t       cmdTimestamp      = 0;
 static const uint32_t CMD_TIMEOUT_MS    = 2000;
+static TimerId        cmdTimer          = TIMER_NONE;      // таймаут текущей команды (quirks)
+static uint32_t       cmdDeadlineMs     = 0;               // то же по millis(), если таймер не выделился
+static BtCmdCounters  cmdCounters       = {};
 
-static String          rxLine;
+static SpscRing<char, 256> rxLine;  // байты текущей строки до '\n'
 static BTConnState     btState           = BTConnState::DISCONNECTED;
 static BtDevStat       devStat{};
 
 // Информация о текущем треке (из +TRACKSTAT и +TRACKINFO)
-static TrackInfo       g_trackInfo       = {0, 0, "", "", "", false};
+static TrackInfo       g_trackInfo       = {0, 0, "", "", "", false, 0, 0};
 
 // Callback для смены состояния
 static BtStateCallback stateCb           = nullptr;
 
-// фоновый опрос статусов
-static uint32_t        lastStatPollMs    = 0;
+// фоновый опрос статусов (таймер ставит флаг, опрос — когда очередь свободна)
+static const uint32_t  STAT_POLL_MS      = 3000;
+static TimerId         statPollTimer     = TIMER_NONE;
+static bool            statPollDue       = false;
+static bool            statPollOn        = true;   // выключается на время AT-моста
+
+// сырой поток принятых байт (AT-мост)
+static BtRxTap         rxTap             = nullptr;
+
+// троттлинг лога TRACKSTAT
+static TimerId         trackLogHold      = TIMER_NONE;
+
+// ---------- идентификация модуля + quirks ----------
+static BtModuleIdentity g_identity        = {"", "", false, 0, 0, 0};
+
+// Что делать с командой на конкретной прошивке
+enum class BtQuirkAction : uint8_t {
+    SKIP,        // не отправлять (гарантированный таймаут/ERROR)
+    SUBSTITUTE,  // отправить replacement вместо команды
+    TIMEOUT      // отправить, но ждать ответ timeoutMs
+};
+
+struct BtQuirk {
+    const char*   version;      // подстрока в +VER= (nullptr = любая прошивка)
+    const char*   cmd;          // имя команды до '=' ("AT+DEVSTAT")
+    BtQuirkAction action;
+    const char*   replacement;  // для SUBSTITUTE (параметры исходной команды сохраняются)
+    uint16_t      timeoutMs;    // для TIMEOUT
+};
+
+// Таблица по версиям прошивки. Проверяется только после получения +VER.
+static const BtQuirk QUIRKS[] = {
+    // Ранние прошивки: нет фонового статуса устройства и AVRCP-конфига
+    { "V1.",  "AT+DEVSTAT",   BtQuirkAction::SKIP,       nullptr,        0    },
+    { "V1.",  "AT+AVRCPCFG",  BtQuirkAction::SKIP,       nullptr,        0    },
+    // ... и нет PLAYPAUSE — только раздельные PLAY/PAUSE: см. bt1036_playPause()
+    // Удаление списка сопряжений пишет flash — отвечает дольше стандартных 2с
+    { nullptr, "AT+DELPD",    BtQuirkAction::TIMEOUT,    nullptr,        5000 },
+    { nullptr, "AT+REBOOT",   BtQuirkAction::TIMEOUT,    nullptr,        4000 },
+};
+
+// Выученные неподдерживаемые команды: два таймаута подряд (ответ OK/ERROR на
+// эту же команду сбрасывает счёт), при этом между ними модуль отвечал OK на
+// другие команды (т.е. он жив, а команду просто игнорирует).
+// Учатся только команды настройки/диагностики: ответ на A2DPCONN, PLAY и т.п.
+// зависит от телефона, их таймаут не говорит о прошивке.
+static const uint8_t  LEARN_SLOTS       = 8;
+static const uint8_t  LEARN_FAILS       = 2;
+struct LearnedCmd { String cmd; uint8_t fails; uint32_t okSnapshot; };
+static LearnedCmd     learned[LEARN_SLOTS];
+static uint32_t       okCount           = 0;
+
+static const char *const LEARNABLE[] = {
+    "AT+DEVSTAT", "AT+AVRCPCFG", "AT+A2DPINFO", "AT+AVRCPSTAT", "AT+HFPSTAT", "AT+STAT",
+    "AT+NAME", "AT+LENAME", "AT+COD", "AT+SEP", "AT+SSP", "AT+PROFILE", "AT+AUTOCONN",
+    "AT+MICGAIN", "AT+SPKVOL", "AT+TXPOWER", "AT+HFPSR", "AT+HFPCFG",
+};
+
+static String cmdName(const String &cmd) {
+    int eq = cmd.indexOf('=');
+    return eq > 0 ? cmd.substring(0, eq) : cmd;
+}
+
+static bool quirkMatchesVersion(const BtQuirk &q) {
+    if (!q.version) return true;
+    return g_identity.valid && g_identity.version.indexOf(q.version) >= 0;
+}
+
+static bool isLearnable(const String &name) {
+    for (size_t i = 0; i < sizeof(LEARNABLE) / sizeof(LEARNABLE[0]); ++i) {
+        if (name == LEARNABLE[i]) return true;
+    }
+    return false;
+}
 
-// ---------- helpers очереди ----------
-static bool queueIsEmpty() {
-    return queueHead == queueTail;
+static LearnedCmd *findLearned(const String &name) {
+    for (uint8_t i = 0; i < LEARN_SLOTS; ++i) {
+        if (learned[i].cmd == name) return &learned[i];
+    }
+    return nullptr;
+}
+
+static void noteTimeout(const String &cmd) {
+    String name = cmdName(cmd);
+    if (!g_identity.valid || !isLearnable(name)) return;
+
+    LearnedCmd *e = findLearned(name);
+    if (!e) {
+        for (uint8_t i = 0; i < LEARN_SLOTS && !e; ++i) {
+            if (learned[i].cmd.isEmpty()) e = &learned[i];
+        }
+        if (!e) return;  // таблица заполнена
+        e->cmd = name;
+        e->fails = 1;
+        e->okSnapshot = okCount;
+        return;
+    }
+    if (e->fails >= LEARN_FAILS) return;
+    if (okCount > e->okSnapshot) {
+        e->fails++;
+        e->okSnapshot = okCount;
+        if (e->fails >= LEARN_FAILS) {
+            btWebUI_log("[BT] " + name + " not supported by firmware, will skip", LogLevel::INFO);
+        }
+    }
 }
 
-static bool queueIsFull() {
-    return (uint8_t)((queueTail + 1) % CMD_QUEUE_SIZE) == queueHead;
+// Команда ответила (OK/ERROR) — значит поддерживается, прошлые таймауты не в счёт
+static void noteAnswered(const String &cmd) {
+    LearnedCmd *e = findLearned(cmdName(cmd));
+    if (e && e->fails < LEARN_FAILS) *e = LearnedCmd();
 }
 
-static void queuePush(const String &cmd) {
-    if (queueIsFull()) {
+// false → команду пропустить. Может заменить cmd и таймаут.
+static bool applyQuirks(String &cmd, uint32_t &timeoutMs) {
+    timeoutMs = CMD_TIMEOUT_MS;
+    String name = cmdName(cmd);
+
+    LearnedCmd *e = findLearned(name);
+    if (e && e->fails >= LEARN_FAILS) {
+        g_identity.skipped++;
+        btWebUI_log("[BT] skip (unsupported): " + cmd, LogLevel::DEBUG);
+        return false;
+    }
+
+    for (size_t i = 0; i < sizeof(QUIRKS) / sizeof(QUIRKS[0]); ++i) {
+        const BtQuirk &q = QUIRKS[i];
+        if (name != q.cmd || !quirkMatchesVersion(q)) continue;
+        switch (q.action) {
+            case BtQuirkAction::SKIP:
+                g_identity.skipped++;
+                btWebUI_log("[BT] skip (quirk): " + cmd, LogLevel::DEBUG);
+                return false;
+            case BtQuirkAction::SUBSTITUTE:
+                g_identity.substituted++;
+                btWebUI_log("[BT] quirk: " + cmd + " -> " + q.replacement, LogLevel::DEBUG);
+                cmd = String(q.replacement) + cmd.substring(name.length());
+                break;
+            case BtQuirkAction::TIMEOUT:
+                timeoutMs = q.timeoutMs;
+                break;
+        }
+    }
+    return true;
+}
+
+static void onVersion(const String &ver) {
+    bool changed = (ver != g_identity.version);
+    g_identity.version = ver;
+    g_identity.valid = ver.length() > 0;
+    g_identity.quirkCount = 0;
+    for (size_t i = 0; i < sizeof(QUIRKS) / sizeof(QUIRKS[0]); ++i) {
+        if (QUIRKS[i].version && quirkMatchesVersion(QUIRKS[i])) g_identity.quirkCount++;
+    }
+    // Другая прошивка (модуль заменили на ходу) — выученное больше не верно
+    if (changed) {
+        for (uint8_t i = 0; i < LEARN_SLOTS; ++i) learned[i] = LearnedCmd();
+    }
+    btWebUI_log("[BT] Firmware: " + ver + " (" + String(g_identity.quirkCount) + " quirks)", LogLevel::INFO);
+}
+
+// ---------- helpers очереди ----------
+static bool queueIsEmpty() {
+    return cmdQueue.empty();
+}
+
+static void queuePush(const String &cmd, bool raw = false) {
+    uint32_t ticket = cmdQueue.pushed() + 1;
+    if (!cmdQueue.push(cmd)) {
+        cmdCounters.dropped++;
         btWebUI_log("[BT] queue FULL, drop: " + cmd, LogLevel::INFO);
+        lastTicket = 0;
         return;
     }
-    cmdQueue[queueTail] = cmd;
-    queueTail = (queueTail + 1) % CMD_QUEUE_SIZE;
+    // Только после успешного push: при полной очереди этот слот — у команды в работе
+    cmdRaw[ticket & 15] = raw;
+    lastTicket = ticket;
 }
 
 static String queueFront() {
-    if (queueIsEmpty()) return String();
-    return cmdQueue[queueHead];
-}
-
-static void queuePop() {
-    if (!queueIsEmpty()) {
-        queueHead = (queueHead + 1) % CMD_QUEUE_SIZE;
+    const String *f = cmdQueue.front();
+    return f ? *f : String();
+}
+
+static void queuePop(BtCmdResult result) {
+    String done;
+    uint32_t ticket = cmdQueue.popped() + 1;
+    if (!cmdQueue.pop(done)) return;  // move — память строки освобождается сразу
+    cmdResults[ticket & 15] = result;
+    switch (result) {
+        case BtCmdResult::OK:      cmdCounters.ok++;       break;
+        case BtCmdResult::ERROR:   cmdCounters.errors++;   break;
+        case BtCmdResult::TIMEOUT: cmdCounters.timeouts++; break;
+        case BtCmdResult::SKIPPED: cmdCounters.skipped++;  break;
+        case BtCmdResult::DROPPED: cmdCounters.dropped++;  break;
+        case BtCmdResult::PENDING: break;
     }
 }
 
+static void queueClear() {
+    while (!queueIsEmpty()) queuePop(BtCmdResult::DROPPED);
+}
 // ---------- изменение состояния + callback ----------
 static void setBtState(BTConnState newState) {
     if (newState == btState) return;
@@ -75,16 +249,30 @@ static void setBtState(BTConnState newState) {
 }
 
 // ---------- отправка ----------
-static void sendCommandNow(const String &cmd) {
+static void onCmdTimeout() {
+    cmdTimer = TIMER_NONE;
+    if (!cmdInProgress) return;
+    String cur = queueFront();
+    if (cur.length()) {
+        btWebUI_log("[BT] CMD TIMEOUT for: " + cur, LogLevel::INFO);
+        if (!cmdRaw[(cmdQueue.popped() + 1) & 15]) noteTimeout(cur);
+    }
+    cmdInProgress = false;
+    queuePop(BtCmdResult::TIMEOUT);
+}
+
+static void sendCommandNow(const String &cmd, uint32_t timeoutMs) {
     if (!bt) return;
 
     btWebUI_log("[BT] >> " + cmd, LogLevel::VERBOSE);  // AT команды - verbose
 
     bt->print(cmd);
     bt->print("\r\n");
+    cmdCounters.sent++;
 
     cmdInProgress = true;
-    cmdTimestamp  = millis();
+    cmdDeadlineMs = millis() + timeoutMs;
+    timer_restart(cmdTimer, onCmdTimeout, timeoutMs);
 }
 
 // ---------- обновление DEVSTAT ----------
@@ -117,9 +305,12 @@ static void handleLine(const String &lineIn) {
 
     // --- базовые ответы ---
     if (line == F("OK")) {
+        okCount++;
         if (cmdInProgress) {
             cmdInProgress = false;
-            if (!queueIsEmpty()) queuePop();
+            timer_cancel(cmdTimer);
+            noteAnswered(queueFront());
+            queuePop(BtCmdResult::OK);
         }
         return;
     }
@@ -129,7 +320,9 @@ static void handleLine(const String &lineIn) {
             String cur = queueFront();
             btWebUI_log("[BT] CMD ERROR for: " + cur, LogLevel::INFO);
             cmdInProgress = false;
-            if (!queueIsEmpty()) queuePop();
+            timer_cancel(cmdTimer);
+            noteAnswered(cur);
+            queuePop(BtCmdResult::ERROR);
         }
         return;
     }
@@ -209,18 +402,14 @@ static void handleLine(const String &lineIn) {
             g_trackInfo.elapsedSec = params.substring(comma1 + 1, comma2).toInt();
             g_trackInfo.totalSec = params.substring(comma2 + 1).toInt();
             g_trackInfo.valid = true;
-            
-            // Конвертируем в минуты:секунды
-            uint8_t elMin = g_trackInfo.elapsedSec / 60;
-            uint8_t elSec = g_trackInfo.elapsedSec % 60;
-            
-            // Обновляем время на дисплее магнитолы!
-            cdc_setPlayTime(elMin, elSec);
-            
+            g_trackInfo.statSeq++;
+            // Время на дисплей магнитолы выводит main (appLoop) — с учётом track_sync
+
             // Логируем красиво (не каждую секунду, чтобы не спамить)
-            static uint32_t lastLogTime = 0;
-            if (millis() - lastLogTime > 5000) {  // раз в 5 сек
-                lastLogTime = millis();
+            if (!timer_active(trackLogHold)) {  // раз в 5 сек
+                trackLogHold = timer_start(nullptr, 5000);
+                int elMin = g_trackInfo.elapsedSec / 60;
+                int elSec = g_trackInfo.elapsedSec % 60;
                 int totMin = g_trackInfo.totalSec / 60;
                 int totSec = g_trackInfo.totalSec % 60;
                 char buf[32];
@@ -251,14 +440,34 @@ static void handleLine(const String &lineIn) {
                 g_trackInfo.album = "";
             }
             g_trackInfo.valid = true;
+            g_trackInfo.infoSeq++;
             btWebUI_log("[BT] Now: " + g_trackInfo.title + " - " + g_trackInfo.artist, LogLevel::INFO);
         }
         return;
     }
 
+    // ---------- Идентификация ----------
+    if (line.startsWith(F("+VER="))) {
+        String ver = line.substring(5);
+        ver.trim();
+        onVersion(ver);
+        return;
+    }
+
+    if (line.startsWith(F("+ADDR="))) {
+        g_identity.address = line.substring(6);
+        g_identity.address.trim();
+        btWebUI_log("[BT] Address: " + g_identity.address, LogLevel::INFO);
+        return;
+    }
+
     // Остальные ответы пока просто логируются выше как "<< ..."
 }
 
+static void onStatPollTimer() {
+    statPollDue = true;
+}
+
 // ---------- public API ----------
 
 void bt1036_init(HardwareSerial &serial, uint8_t rxPin, uint8_t txPin) {
@@ -267,9 +476,10 @@ void bt1036_init(HardwareSerial &serial, uint8_t rxPin, uint8_t txPin) {
 
     btWebUI_log("[BT] BT1036 init @115200", LogLevel::INFO);
 
-    queueHead = queueTail = 0;
+    queueClear();
     cmdInProgress = false;
-    rxLine.reserve(128);
+    timer_cancel(cmdTimer);
+    rxLine.clear();
     setBtState(BTConnState::DISCONNECTED);
 
     // Базовый стартовый набор
@@ -278,7 +488,8 @@ void bt1036_init(HardwareSerial &serial, uint8_t rxPin, uint8_t txPin) {
     queuePush(String(F("AT+ADDR")));
 
     // Стартовый запрос статусов (пойдут из фонового опроса)
-    lastStatPollMs = millis();
+    statPollDue = false;
+    if (statPollOn) timer_restart(statPollTimer, onStatPollTimer, STAT_POLL_MS, STAT_POLL_MS);
 }
 
 void bt1036_loop() {
@@ -287,40 +498,44 @@ void bt1036_loop() {
     // приём UART
     while (bt->available()) {
         char c = bt->read();
+        if (rxTap) rxTap(c);
         if (c == '\r') {
             // ignore
         } else if (c == '\n') {
-            if (!rxLine.isEmpty()) {
-                handleLine(rxLine);
-                rxLine = "";
+            if (!rxLine.empty()) {
+                String line;
+                line.reserve(rxLine.size());
+                char ch;
+                while (rxLine.pop(ch)) line += ch;
+                handleLine(line);
             }
-        } else {
-            rxLine += c;
-            if (rxLine.length() > 250) rxLine = "";
+        } else if (!rxLine.push(c)) {
+            rxLine.clear();  // строка длиннее буфера — мусор
         }
     }
 
-    // таймаут команды
-    if (cmdInProgress && (millis() - cmdTimestamp > CMD_TIMEOUT_MS)) {
-        String cur = queueFront();
-        if (cur.length()) {
-            btWebUI_log("[BT] CMD TIMEOUT for: " + cur, LogLevel::INFO);
-        }
-        cmdInProgress = false;
-        if (!queueIsEmpty()) queuePop();
+    // таймаут команды — onCmdTimeout() из timer_poll(); без таймера (пул
+    // исчерпан) очередь иначе встала бы навсегда — проверяем срок сами
+    if (cmdInProgress && cmdTimer == TIMER_NONE && (int32_t)(millis() - cmdDeadlineMs) >= 0) {
+        onCmdTimeout();
     }
 
-    // отправка следующей команды
-    if (!cmdInProgress && !queueIsEmpty()) {
-        sendCommandNow(queueFront());
+    // отправка следующей команды (с учётом quirks прошивки)
+    while (!cmdInProgress && !queueIsEmpty()) {
+        String cmd = queueFront();
+        uint32_t timeoutMs;
+        if (!applyQuirks(cmd, timeoutMs)) {
+            queuePop(BtCmdResult::SKIPPED);
+            continue;
+        }
+        sendCommandNow(cmd, timeoutMs);
     }
 
     // --- фоновый опрос статуса A2DP/DEVSTAT раз в 3 секунды ---
-    uint32_t now = millis();
-    if (!cmdInProgress && (now - lastStatPollMs > 3000)) {
+    if (statPollDue && !cmdInProgress) {
+        statPollDue = false;
         bt1036_requestA2dpStat();
         bt1036_requestDevStat();
-        lastStatPollMs = now;
     }
 }
 
@@ -330,21 +545,20 @@ void bt1036_startScan()      { queuePush(String(F("AT+SCAN=1"))); }
 void bt1036_connectLast()    { queuePush(String(F("AT+A2DPCONN"))); }
 void bt1036_disconnect()     { queuePush(String(F("AT+A2DPDISC"))); }
 
-void bt1036_enterPairingMode() {
-    // Отключаемся от текущего устройства и включаем режим сопряжения
-    queuePush(String(F("AT+A2DPDISC")));
-    queuePush(String(F("AT+HFPDISC")));
-    queuePush(String(F("AT+SCAN=1")));
-    btWebUI_log("[BT] Entering pairing mode...", LogLevel::INFO);
-}
-
 void bt1036_clearPairedDevices() {
     // Очищаем список сопряжённых устройств (AT+DELPD удаляет все)
     queuePush(String(F("AT+DELPD")));
     btWebUI_log("[BT] Paired devices list cleared", LogLevel::INFO);
 }
 
-void bt1036_playPause()      { queuePush(String(F("AT+PLAYPAUSE"))); }
+void bt1036_playPause() {
+    // V1.x: нет PLAYPAUSE — переключаем сами по состоянию, которое сообщил модуль
+    if (g_identity.valid && g_identity.version.indexOf("V1.") >= 0) {
+        queuePush(btState == BTConnState::PLAYING ? String(F("AT+PAUSE")) : String(F("AT+PLAY")));
+        return;
+    }
+    queuePush(String(F("AT+PLAYPAUSE")));
+}
 void bt1036_play()           { queuePush(String(F("AT+PLAY"))); }
 void bt1036_pause()          { queuePush(String(F("AT+PAUSE"))); }
 void bt1036_stop()           { queuePush(String(F("AT+STOP"))); }
@@ -401,6 +615,17 @@ void bt1036_setBtEnabled(bool enabled) {
 // ---------- Геттеры / колбэки ----------
 BTConnState bt1036_getState()      { return btState; }
 BtDevStat   bt1036_getDevStat()    { return devStat; }
+BtModuleIdentity bt1036_getIdentity() { return g_identity; }
+
+String bt1036_getUnsupportedCommands() {
+    String list;
+    for (uint8_t i = 0; i < LEARN_SLOTS; ++i) {
+        if (learned[i].fails < LEARN_FAILS) continue;
+        if (list.length()) list += ",";
+        list += learned[i].cmd;
+    }
+    return list;
+}
 
 void bt1036_setStateCallback(BtStateCallback cb) {
     stateCb = cb;
@@ -542,44 +767,57 @@ void bt1036_requestStat() {
     queuePush(String(F("AT+STAT")));
 }
 
-// ---------- Одноразовая "фабричная" настройка (опционально) ----------
-void bt1036_runFactorySetup() {
-    btWebUI_log("[BT] Running factory setup...", LogLevel::INFO);
+// ---------- Результаты команд ----------
+uint32_t bt1036_lastTicket() {
+    return lastTicket;
+}
 
-    // Имена
-    bt1036_setName("VW_BT1036", false);
-    bt1036_setBLEName("VW_BT1036", false);
+BtCmdResult bt1036_cmdResult(uint32_t ticket) {
+    if (ticket == 0) return BtCmdResult::DROPPED;
+    if ((int32_t)(ticket - cmdQueue.popped()) > 0) return BtCmdResult::PENDING;
+    return cmdResults[ticket & 15];
+}
 
-    // Уровни
-    bt1036_setMicGain(8);
-    bt1036_setSpkVol(12, 12);
-    bt1036_setTxPower(10);
+const char *bt1036_cmdResultName(BtCmdResult r) {
+    switch (r) {
+        case BtCmdResult::PENDING: return "PENDING";
+        case BtCmdResult::OK:      return "OK";
+        case BtCmdResult::ERROR:   return "ERROR";
+        case BtCmdResult::TIMEOUT: return "TIMEOUT";
+        case BtCmdResult::SKIPPED: return "SKIPPED";
+        case BtCmdResult::DROPPED: return "DROPPED";
+    }
+    return "?";
+}
 
-    // Профили: HFP-HF + A2DP Sink + AVRCP Controller = 168
-    const uint16_t profileMask  = 168;
-    const uint16_t autoconnMask = 168;
-    bt1036_setProfile(profileMask);
-    bt1036_setAutoconn(autoconnMask);
+const BtCmdCounters &bt1036_getCmdCounters() {
+    return cmdCounters;
+}
 
-    // SSP режим
-    bt1036_setSsp(2);
+// ---------- AT-мост ----------
+void bt1036_sendRaw(const String &cmd) {
+    queuePush(cmd, true);
+}
 
-    // Class of Device – car audio / hands-free
-    bt1036_setCod("240404");
+bool bt1036_isIdle() {
+    return !cmdInProgress && queueIsEmpty();
+}
 
-    // SEP — спец. режим, оставим 0
-    bt1036_setSep(0);
+void bt1036_setRxTap(BtRxTap tap) {
+    rxTap = tap;
+}
 
-    // HFP настройки
-    bt1036_setHfpSampleRate(16000);
-    uint8_t hfpCfg = 3; // BIT0=auto reconnect, BIT1=echo cancel, BIT2=0 (3-way off)
-    bt1036_setHfpConfig(hfpCfg);
-    
-    // AVRCP настройки: автополучение ID3 + прогресс каждую секунду
-    // BIT[0]=1 (auto ID3), BIT[1-3]=001 (1 sec interval) → 0b0011 = 3
-    bt1036_setAvrcpCfg(3);
+void bt1036_setBackgroundPoll(bool on) {
+    if (on == statPollOn) return;
+    statPollOn  = on;
+    statPollDue = false;
+    if (on) timer_restart(statPollTimer, onStatPollTimer, STAT_POLL_MS, STAT_POLL_MS);
+    else    timer_cancel(statPollTimer);
+    btWebUI_log(String("[BT] Background poll: ") + (on ? "ON" : "OFF"), LogLevel::INFO);
+}
 
-    btWebUI_log("[BT] Factory setup queued (check OKs, then reboot module).", LogLevel::INFO);
+bool bt1036_getBackgroundPoll() {
+    return statPollOn;
 }
 
 // ---------- Track Info getter ----------
@@ -32,6 +32,16 @@ struct BtDevStat {
     bool bleScanning;    // BIT4
 };
 
+// Идентификация модуля (ответы на AT+VER / AT+ADDR при старте)
+struct BtModuleIdentity {
+    String  version;        // +VER=...  (как прислал модуль)
+    String  address;        // +ADDR=... (BD address, 12 hex)
+    bool    valid;          // версия получена
+    uint8_t quirkCount;     // сколько правил из таблицы quirks подходит к этой версии
+    uint32_t skipped;       // команд пропущено (quirk / не поддерживается)
+    uint32_t substituted;   // команд заменено (quirk)
+};
+
 // callback: вызывается при смене BTConnState
 typedef void (*BtStateCallback)(BTConnState oldState, BTConnState newState);
 
@@ -43,7 +53,6 @@ void bt1036_loop();
 void bt1036_startScan();      // AT+SCAN=1
 void bt1036_connectLast();    // AT+A2DPCONN
 void bt1036_disconnect();     // AT+A2DPDISC
-void bt1036_enterPairingMode();   // Войти в режим сопряжения (disconnect + scan)
 void bt1036_clearPairedDevices(); // Очистить список сопряжённых устройств
 void bt1036_playPause();      // AT+PLAYPAUSE
 void bt1036_play();           // AT+PLAY
@@ -60,6 +69,8 @@ struct TrackInfo {
     String   artist;
     String   album;
     bool     valid;         // данные актуальны
+    uint32_t infoSeq;       // +1 на каждый +TRACKINFO
+    uint32_t statSeq;       // +1 на каждый +TRACKSTAT
 };
 TrackInfo bt1036_getTrackInfo();
 
@@ -85,6 +96,10 @@ void bt1036_setBtEnabled(bool enabled);   // AT+BTEN=0/1
 
 // ---- Геттеры состояния ----
 BTConnState bt1036_getState();
+BtModuleIdentity bt1036_getIdentity();
+// Команды, которые модуль с этой прошивкой не поддерживает (выучено по таймаутам),
+// через запятую
+String      bt1036_getUnsupportedCommands();
 BtDevStat   bt1036_getDevStat();
 void        bt1036_setStateCallback(BtStateCallback cb);
 
@@ -124,6 +139,40 @@ void bt1036_setHfpConfig(uint8_t cfg);        // AT+HFPCFG=bitfield
 void bt1036_requestDevStat();                 // AT+DEVSTAT
 void bt1036_requestStat();                    // AT+STAT
 
-// Одноразовая "фабричная" настройка модуля BT1036.
-// Вызывается вручную из CLI/Serial/WebUI один раз, дальше модуль хранит всё в своей NVM.
-void bt1036_runFactorySetup();
+// ---- Результат отдельной команды (для сценариев, см. bt_scenarios.h) ----
+// Команды выполняются строго по очереди; номер = позиция в очереди + 1.
+// Хранятся результаты последних 16 команд.
+enum class BtCmdResult : uint8_t {
+    PENDING,   // в очереди / ждёт ответа
+    OK,
+    ERROR,
+    TIMEOUT,
+    SKIPPED,   // не отправлена (quirk / выученная неподдерживаемая)
+    DROPPED    // очередь была полна / очищена при init
+};
+uint32_t    bt1036_lastTicket();               // номер последней поставленной команды (0 — не встала)
+BtCmdResult bt1036_cmdResult(uint32_t ticket);
+const char *bt1036_cmdResultName(BtCmdResult r);
+
+// Счётчики с загрузки (сводка поездки, см. session_log.h)
+struct BtCmdCounters {
+    uint32_t sent;       // ушло в UART
+    uint32_t ok;
+    uint32_t errors;
+    uint32_t timeouts;
+    uint32_t skipped;
+    uint32_t dropped;    // очередь полна / очищена
+};
+const BtCmdCounters &bt1036_getCmdCounters();
+
+// ---- AT-мост (см. at_bridge.h) ----
+// Произвольная строка через общую очередь (quirks действуют); номер — bt1036_lastTicket()
+void bt1036_sendRaw(const String &cmd);
+// Очередь пуста и ответа не ждём — следующая команда уйдёт в UART сразу
+bool bt1036_isIdle();
+// Каждый принятый байт UART (включая \r\n), до разбора строк; nullptr — снять
+typedef void (*BtRxTap)(char c);
+void bt1036_setRxTap(BtRxTap tap);
+// Фоновый опрос A2DPSTAT/DEVSTAT (по умолчанию включён)
+void bt1036_setBackgroundPoll(bool on);
+bool bt1036_getBackgroundPoll();
@@ -0,0 +1,122 @@
+#include "bt_scenarios.h"
+#include "scenario.h"
+#include "bt1036_at.h"
+#include "bt_webui.h"
+#include "play_state.h"
+
+static bool btConnected() {
+    BTConnState st = bt1036_getState();
+    return st == BTConnState::CONNECTED_IDLE ||
+           st == BTConnState::PLAYING ||
+           st == BTConnState::PAUSED;
+}
+
+// ---------- pairing ----------
+static ScStatus pairingFn(Scenario &sc) {
+    SC_BEGIN(sc);
+    btWebUI_log("[BT] Entering pairing mode...", LogLevel::INFO);
+
+    // Отключаемся от текущего устройства (ERROR, если и так нет — не страшно)
+    SC_AT(sc, bt1036_disconnect());
+    SC_AT(sc, bt1036_hfpDisconnect());
+    // Подтверждение — +A2DPSTAT из фонового опроса (раз в 3 с)
+    SC_WAIT(sc, bt1036_getState() == BTConnState::DISCONNECTED, 7000);
+    if (sc.timedOut) SC_FAIL(sc, "still connected");
+
+    SC_AT(sc, bt1036_startScan());
+    if (SC_AT_RESULT(sc) != BtCmdResult::OK) SC_FAIL(sc, "AT+SCAN=1 not accepted");
+    btWebUI_log("[BT] Discoverable, waiting for a new device", LogLevel::INFO);
+
+    SC_WAIT(sc, btConnected(), SCEN_PAIRING_WAIT_MS);
+    if (sc.timedOut) SC_FAIL(sc, "no device paired");
+    SC_END(sc);
+}
+
+// ---------- reconnect + play ----------
+static ScStatus connectPlayFn(Scenario &sc) {
+    SC_BEGIN(sc);
+    if (!btConnected()) {
+        SC_AT(sc, bt1036_connectLast());
+        SC_WAIT(sc, btConnected(), SCEN_CONNECT_WAIT_MS);
+        if (sc.timedOut) SC_FAIL(sc, "no connection");
+    }
+
+    // Новое устройство: TRACK 10 на экране, телефону даём освоиться
+    SC_SLEEP(sc, sc.arg);
+
+    for (sc.i = 0; sc.i < 2; sc.i++) {
+        pstate_request(PlayState::PLAYING);
+        SC_WAIT(sc, pstate_reported() == PlayState::PLAYING, PSTATE_CONFIRM_MS);
+        if (!sc.timedOut) break;
+        sc.errors++;
+    }
+    if (sc.timedOut) SC_FAIL(sc, "phone did not start playback");
+    btWebUI_log("[MAIN] Auto-play confirmed", LogLevel::INFO);
+    SC_END(sc);
+}
+
+// ---------- factory setup ----------
+// Одноразовая настройка модуля, дальше он хранит всё в своей NVM
+static const uint8_t FACTORY_STEPS = 13;
+
+static void factoryStep(uint8_t step) {
+    switch (step) {
+        // Имена
+        case 0:  bt1036_setName("VW_BT1036", false);    break;
+        case 1:  bt1036_setBLEName("VW_BT1036", false); break;
+        // Уровни
+        case 2:  bt1036_setMicGain(8);                  break;
+        case 3:  bt1036_setSpkVol(12, 12);              break;
+        case 4:  bt1036_setTxPower(10);                 break;
+        // Профили: HFP-HF + A2DP Sink + AVRCP Controller = 168
+        case 5:  bt1036_setProfile(168);                break;
+        case 6:  bt1036_setAutoconn(168);               break;
+        // SSP режим
+        case 7:  bt1036_setSsp(2);                      break;
+        // Class of Device – car audio / hands-free
+        case 8:  bt1036_setCod("240404");               break;
+        // SEP — спец. режим, оставим 0
+        case 9:  bt1036_setSep(0);                      break;
+        // HFP: 16 кГц; BIT0=auto reconnect, BIT1=echo cancel, BIT2=0 (3-way off)
+        case 10: bt1036_setHfpSampleRate(16000);        break;
+        case 11: bt1036_setHfpConfig(3);                break;
+        // AVRCP: BIT[0]=1 (auto ID3), BIT[1-3]=001 (прогресс раз в 1 с) → 3
+        case 12: bt1036_setAvrcpCfg(3);                 break;
+    }
+}
+
+static ScStatus factoryFn(Scenario &sc) {
+    SC_BEGIN(sc);
+    btWebUI_log("[BT] Running factory setup...", LogLevel::INFO);
+
+    for (sc.i = 0; sc.i < FACTORY_STEPS; sc.i++) {
+        SC_AT(sc, factoryStep(sc.i));
+        // SKIPPED — команды нет в этой прошивке (quirks), это не ошибка
+        if (SC_AT_RESULT(sc) != BtCmdResult::OK && SC_AT_RESULT(sc) != BtCmdResult::SKIPPED) {
+            sc.errors++;
+            btWebUI_log("[BT] Factory step " + String(sc.i + 1) + "/" + String(FACTORY_STEPS) +
+                        ": " + bt1036_cmdResultName(SC_AT_RESULT(sc)), LogLevel::INFO);
+        }
+    }
+    if (sc.errors) SC_FAIL(sc, "module rejected some settings");
+    btWebUI_log("[BT] Factory setup OK, reboot module to apply", LogLevel::INFO);
+    SC_END(sc);
+}
+
+static Scenario g_pairing     = SC_SCENARIO("pairing",      pairingFn);
+static Scenario g_connectPlay = SC_SCENARIO("connect_play", connectPlayFn);
+static Scenario g_factory     = SC_SCENARIO("factory",      factoryFn);
+
+void scen_init() {
+    sc_register(g_pairing);
+    sc_register(g_connectPlay);
+    sc_register(g_factory);
+}
+
+bool scen_pairing()                     { return sc_start(g_pairing); }
+bool scen_connectPlay(uint32_t delayMs) { return sc_start(g_connectPlay, delayMs); }
+bool scen_factory()                     { return sc_start(g_factory); }
+
+void scen_cancelConnectPlay() {
+    sc_abort(g_connectPlay, "disconnected");
+}
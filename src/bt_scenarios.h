@@ -0,0 +1,31 @@
+/**
+ * @file bt_scenarios.h
+ * @brief BT1036 multi-step sequences written as scenarios (see scenario.h)
+ *
+ *   pairing        — A2DPDISC → HFPDISC → wait for DISCONNECTED → SCAN=1
+ *                    (must be OK) → wait for a device to connect;
+ *   connect_play   — AT+A2DPCONN unless already connected → wait for the
+ *                    connection → optional delay (TRACK 10 window) →
+ *                    AT+PLAY until the module reports PLAYING (one retry);
+ *   factory        — every setter is sent only after the previous one
+ *                    answered; failed steps are named in the log.
+ *
+ * Each scenario reports how long it took (log + /api/scenarios).
+ */
+
+#pragma once
+#include <Arduino.h>
+
+static const uint32_t SCEN_PAIRING_WAIT_MS = 180000;  // ждём новое устройство
+static const uint32_t SCEN_CONNECT_WAIT_MS = 15000;   // AT+A2DPCONN → соединение
+
+// Регистрация в движке + шаг планировщика вызывает main
+void scen_init();
+
+// false — такой сценарий уже идёт
+bool scen_pairing();
+bool scen_connectPlay(uint32_t delayMs);
+bool scen_factory();
+
+// Соединение потеряно — автовоспроизведение больше не нужно
+void scen_cancelConnectPlay();
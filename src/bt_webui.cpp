@@ -1,9 +1,27 @@
 #include "bt_webui.h"
+#include "cdc_profile.h"
+#include "dataout_decoder.h"
+#include "loop_sched.h"
+#include "timer_wheel.h"
+#include "mem_governor.h"
+#include "cpu_load.h"
+#include "isr_bench.h"
+#include "ws_bench.h"
+#include "ring_buffer.h"
+#include "build_config.h"
+#include "web_api.h"
+#include "gzip_stream.h"
+#include "at_bridge.h"
+#include "session_log.h"
+#include "syslog_ship.h"
 #include <WiFi.h>
 #include <WebSocketsServer.h>
 #include <ElegantOTA.h>
 #include <Preferences.h>
 #include <ESPmDNS.h>
+#include <new>
+#include <errno.h>
+#include <lwip/sockets.h>
 
 // ========== Debug mode ==========
 bool g_debugMode = false;
@@ -13,6 +31,10 @@ void btWebUI_setDebug(bool on) {
     btWebUI_log(String("[SYS] Debug mode: ") + (on ? "ON" : "OFF"));
 }
 
+static uint32_t g_bootMs = 0;
+
+void btWebUI_setBootMs(uint32_t ms) { g_bootMs = ms; }
+
 // ========== Параметры точки доступа (AP) ==========
 static String apSsid = "VW-BT1036";
 static String apPsk  = "12345678";
@@ -24,25 +46,121 @@ Preferences      prefs;
 
 // ---------- Ring Buffer ----------
 static const uint16_t LOG_CAPACITY = 128;
-struct LogEntry { uint32_t id; String line; };
-static LogEntry logBuf[LOG_CAPACITY];
-static uint16_t logHead = 0; static uint16_t logCount = 0; static uint32_t logNextId = 1;
+struct LogEntry { uint32_t id; String line; LogLevel level; };
+static OverwriteRing<LogEntry, LOG_CAPACITY> logBuf;
+static uint32_t logNextId = 1;
+
+static void logAppend(const String &line, LogLevel level) {
+    LogEntry &e = logBuf.pushSlot(); e.id = logNextId++; e.line = line; e.level = level;
+}
+
+// ---------- WS fan-out ----------
+static_assert(WS_MAX_CLIENTS == WEBSOCKETS_SERVER_CLIENT_MAX, "WS_MAX_CLIENTS out of sync with WebSockets library");
+static WsFanoutStats wsStats = {};
+
+// Подписки клиентов: маски каналов и уровней
+static const uint8_t WS_LV_ALL = 0x07;
+static uint8_t wsSubCh[WS_MAX_CLIENTS];
+static uint8_t wsSubLv[WS_MAX_CLIENTS];
+static const char *const WS_CH_NAMES[] = { "bt", "cdc", "raw", "sys", "bench" };
+static const char *const WS_LV_NAMES[] = { "info", "debug", "verbose" };
 
-static void logAppend(const String &line) {
-    LogEntry &e = logBuf[logHead]; e.id = logNextId++; e.line = line;
-    logHead = (logHead + 1) % LOG_CAPACITY;
-    if (logCount < LOG_CAPACITY) logCount++;
+static inline uint8_t lvBit(LogLevel level) { return 1 << (uint8_t)level; }
+
+static uint8_t wsChannelOf(const char *s) {
+    if (strncmp(s, "[BT]", 4) == 0)      return WS_CH_BT;
+    if (strncmp(s, "[CDC_NEC]", 9) == 0) return WS_CH_RAW;
+    if (strncmp(s, "[CDC]", 5) == 0 || strncmp(s, "[BTN]", 5) == 0) return WS_CH_CDC;
+    if (strncmp(s, "[BENCH]", 7) == 0 || strncmp(s, "[WSB]", 5) == 0) return WS_CH_BENCH;
+    return WS_CH_SYS;
+}
+
+// "key=a,b,c" до '&' / ' ' / конца; ключа нет — all
+static uint8_t parseNameList(const String &spec, const char *key, const char *const *names, uint8_t n, uint8_t all) {
+    int p = spec.indexOf(key);
+    if (p < 0) return all;
+    p += strlen(key);
+    int end = p;
+    while (end < (int)spec.length() && spec[end] != '&' && spec[end] != ' ') end++;
+    uint8_t mask = 0;
+    while (p < end) {
+        int comma = spec.indexOf(',', p);
+        if (comma < 0 || comma > end) comma = end;
+        String name = spec.substring(p, comma);
+        if (name == "all") mask = all;
+        for (uint8_t i = 0; i < n; ++i) {
+            if (name == names[i]) mask |= 1 << i;
+        }
+        p = comma + 1;
+    }
+    return mask;
+}
+
+static void wsSubscribe(uint8_t num, const String &spec) {
+    if (num >= WS_MAX_CLIENTS) return;
+    wsSubCh[num] = parseNameList(spec, "ch=", WS_CH_NAMES, 5, WS_CH_ALL);
+    wsSubLv[num] = parseNameList(spec, "lv=", WS_LV_NAMES, 3, WS_LV_ALL);
+}
+
+static inline bool wsClientWants(uint8_t i, uint8_t ch, uint8_t lv) {
+    return (wsSubCh[i] & ch) && (wsSubLv[i] & lv);
+}
+
+bool btWebUI_wsWants(uint8_t channel, LogLevel level) {
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; ++i) {
+        if (wsServer.clientIsConnected(i) && wsClientWants(i, channel, lvBit(level))) return true;
+    }
+    return false;
+}
+
+// То же, что broadcastTXT(), но по клиентам: sendTXT() пишет в TCP синхронно,
+// медленный клиент тормозит loop() — это и меряем. Неподписанным не шлём.
+static void wsBroadcast(const char *payload, uint8_t ch, LogLevel level) {
+    uint8_t lv = lvBit(level);
+    size_t len = 0;
+    uint32_t t0 = micros();
+    uint8_t clients = 0, sent = 0;
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; ++i) {
+        if (!wsServer.clientIsConnected(i)) continue;
+        clients++;
+        if (!wsClientWants(i, ch, lv)) { wsStats.skipped++; continue; }
+        if (!len) len = strlen(payload);
+        sent++;
+        wsStats.bytes += len;
+        uint32_t c0 = micros();
+        bool ok = wsServer.sendTXT(i, payload, len);
+        uint32_t dt = micros() - c0;
+        WsClientStats &c = wsStats.client[i];
+        c.sends++;
+        if (dt > c.maxSendUs) c.maxSendUs = dt;
+        if (!ok) { c.fails++; wsStats.sendFails++; }
+    }
+    uint32_t dt = micros() - t0;
+    wsStats.clients = clients;
+    if (!sent) return;
+    wsStats.broadcasts++;
+    wsStats.totalBroadcastUs += dt;
+    if (dt > wsStats.maxBroadcastUs) wsStats.maxBroadcastUs = dt;
+}
+
+const WsFanoutStats &btWebUI_getWsStats() { return wsStats; }
+
+void btWebUI_resetWsStats() {
+    uint8_t clients = wsStats.clients;
+    wsStats = WsFanoutStats();
+    wsStats.clients = clients;
 }
 
 void btWebUI_log(const String &line, LogLevel level) {
-    if ((level == LogLevel::DEBUG || level == LogLevel::VERBOSE) && !g_debugMode) {
-        return;
+    if (level == LogLevel::DEBUG || level == LogLevel::VERBOSE) {
+        if (!g_debugMode || !mem_debugAllowed()) return;
     }
     Serial.println(line);
+    slog_push(line, level);
     if (level != LogLevel::VERBOSE) {
-        logAppend(line);
+        logAppend(line, level);
     }
-    wsServer.broadcastTXT(line.c_str());
+    wsBroadcast(line.c_str(), wsChannelOf(line.c_str()), level);
 }
 
 void btWebUI_log(const String &line) {
@@ -50,25 +168,72 @@ void btWebUI_log(const String &line) {
 }
 
 void btWebUI_broadcastCdcRaw(const String &line) {
-    wsServer.broadcastTXT(line.c_str());
+    if (!mem_rawAllowed()) return;
+    wsBroadcast(line.c_str(), WS_CH_RAW, LogLevel::DEBUG);
+}
+
+void btWebUI_broadcastBench(const char *payload) {
+    wsBroadcast(payload, WS_CH_BENCH, LogLevel::INFO);
 }
 
-static const char* stateToStr(BTConnState st) {
-    switch (st) {
-        case BTConnState::DISCONNECTED:   return "DISCONNECTED";
-        case BTConnState::CONNECTING:     return "CONNECTING";
-        case BTConnState::CONNECTED_IDLE: return "CONNECTED_IDLE";
-        case BTConnState::PLAYING:        return "PLAYING";
-        case BTConnState::PAUSED:         return "PAUSED";
+// ---------- AT-мост: владелец — один WS клиент ----------
+static const uint8_t ATB_NO_OWNER = 0xFF;
+static uint8_t atbOwner = ATB_NO_OWNER;
+
+static bool atbSink(const char *msg, size_t len) {
+    if (atbOwner >= WS_MAX_CLIENTS || !wsServer.clientIsConnected(atbOwner)) return false;
+    return wsServer.sendTXT(atbOwner, msg, len);
+}
+
+// "ATB open" / "ATB close"
+static void onAtbControl(uint8_t num, const String &msg) {
+    if (msg == "ATB open") {
+        if (atbOwner != ATB_NO_OWNER && !atb_active()) atbOwner = ATB_NO_OWNER;  // закрылся по простою
+        if (atbOwner == num) return;
+        if (atbOwner != ATB_NO_OWNER) {
+            String busy = "[ATB] busy: owned by client #" + String(atbOwner);
+            wsServer.sendTXT(num, busy.c_str());
+            return;
+        }
+        atbOwner = num;
+        atb_open(atbSink);
+    } else if (msg == "ATB close" && num == atbOwner) {
+        atb_close("by client");
+        atbOwner = ATB_NO_OWNER;
     }
-    return "UNKNOWN";
 }
 
 static void onWsEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
     if (type == WStype_CONNECTED) {
-        for (uint16_t i = 0; i < logCount; ++i) {
-            uint16_t idx = (logHead + LOG_CAPACITY - logCount + i) % LOG_CAPACITY;
-            wsServer.sendTXT(num, logBuf[idx].line.c_str());
+        if (!mem_wsAcceptAllowed()) {
+            btWebUI_log("[MEM] Low memory: WS client #" + String(num) + " refused", LogLevel::INFO);
+            wsServer.disconnect(num);
+            return;
+        }
+        // Подписка из URL: /?ch=bt,sys&lv=info
+        wsSubscribe(num, String((const char *)payload));
+        // При нехватке памяти — только хвост истории; только то, на что подписан
+        uint16_t count  = (uint16_t)logBuf.size();
+        uint16_t replay = mem_logReplayLimit(count);
+        for (uint16_t i = count - replay; i < count; ++i) {
+            const LogEntry &e = logBuf[i];
+            if (!wsClientWants(num, wsChannelOf(e.line.c_str()), lvBit(e.level))) continue;
+            wsServer.sendTXT(num, e.line.c_str());
+        }
+    } else if (type == WStype_DISCONNECTED) {
+        wsSubscribe(num, "");
+        if (num == atbOwner) {
+            atb_close("client gone");
+            atbOwner = ATB_NO_OWNER;
+        }
+    } else if (type == WStype_TEXT) {
+        // "SUB ch=cdc,raw lv=info,debug" — сменить подписку на лету
+        if (length > 4 && memcmp(payload, "SUB ", 4) == 0) {
+            wsSubscribe(num, String((const char *)payload));
+        } else if (length >= 3 && memcmp(payload, "ATB", 3) == 0) {
+            onAtbControl(num, String((const char *)payload));
+        } else if (num == atbOwner && atb_active()) {
+            atb_submit(String((const char *)payload));
         }
     }
 }
@@ -99,6 +264,7 @@ small{color:#888}
 <nav>
   <a href="/" class="active">Main</a>
   <a href="/bt">BT Debug</a>
+  <a href="/term">Terminal</a>
   <a href="/cdc">CDC Debug</a>
   <a href="/logs">All Logs</a>
   <a href="/wifi">WiFi</a>
@@ -111,6 +277,11 @@ small{color:#888}
     <div>State: <span id="st_state" class="status-val">-</span></div>
     <div>Power: <span id="st_power" class="status-val">-</span></div>
   </div>
+  <div style="display:flex;gap:20px;margin-bottom:10px;font-size:0.9em;">
+    <div>CPU0: <span id="cpu0" class="status-val">-</span></div>
+    <div>CPU1: <span id="cpu1" class="status-val">-</span></div>
+    <div><small id="cpu_detail"></small></div>
+  </div>
   <div>
     <button onclick="sendCmd('scan')">Scan</button>
     <button onclick="sendCmd('connect')">Connect Last</button>
@@ -174,6 +345,14 @@ function updateStatus(){fetch('/api/status').then(function(r){return r.json();})
   document.getElementById('st_power').textContent=st.devstat.powerOn?'ON':'OFF';
 });}
 setInterval(updateStatus,2000);updateStatus();
+function updateCpu(){fetch('/api/cpu').then(function(r){return r.json();}).then(function(c){
+  document.getElementById('cpu0').textContent=c.cores[0].load.toFixed(1)+'%';
+  document.getElementById('cpu1').textContent=c.cores[1].load.toFixed(1)+'%';
+  var d='ISR '+c.isr.dataOutPct.toFixed(2)+'%';
+  c.steps.forEach(function(s){d+=' · '+s.name+' '+s.pct.toFixed(1)+'%';});
+  document.getElementById('cpu_detail').textContent=d;
+});}
+setInterval(updateCpu,2000);updateCpu();
 function sendCmd(a){fetch('/api/cmd?act='+a);}
 function sendBasic(){
   var n=encodeURIComponent(document.getElementById('name').value);
@@ -225,6 +404,7 @@ input[type=text],input[type=password]{width:200px;background:#222;color:#fff;bor
 <nav>
   <a href="/">Main</a>
   <a href="/bt">BT Debug</a>
+  <a href="/term">Terminal</a>
   <a href="/cdc">CDC Debug</a>
   <a href="/logs">All Logs</a>
   <a href="/wifi" class="active">WiFi</a>
@@ -242,6 +422,18 @@ input[type=text],input[type=password]{width:200px;background:#222;color:#fff;bor
   <button onclick="scan()">Scan</button>
   <div id="list" style="margin-top:10px;"></div>
 </section>
+<section>
+  <h3>Log Shipping (syslog / UDP)</h3>
+  <div><label>Enabled:</label><input id="sl_on" type="checkbox"> <small>sent only while joined to a network (STA)</small></div>
+  <div><label>Collector IP:</label><input id="sl_host" type="text" placeholder="192.168.1.10"></div>
+  <div><label>Port:</label><input id="sl_port" type="text" value="514"></div>
+  <div><label>Level:</label><select id="sl_lv"><option>info</option><option>debug</option><option>verbose</option></select></div>
+  <div><label>Datagrams/s:</label><input id="sl_rate" type="text" value="10"></div>
+  <div><label>Metrics (s):</label><input id="sl_met" type="text" value="30"> <small>0 = off</small></div>
+  <button onclick="saveSyslog()" style="background:#060;margin-top:10px;">Save</button>
+  <div id="sl_msg" style="color:#fa0;margin-top:5px;"></div>
+  <div><small id="sl_stats"></small></div>
+</section>
 <script>
 function scan(){
   document.getElementById('list').innerHTML="Scanning...";
@@ -264,6 +456,37 @@ function save(){
     document.getElementById('msg').innerText="Saved! ESP is connecting...";
   });
 }
+function showSyslog(c,fill){
+  if(fill){
+    document.getElementById('sl_on').checked=c.enabled;
+    document.getElementById('sl_host').value=c.host;
+    document.getElementById('sl_port').value=c.port;
+    document.getElementById('sl_lv').value=c.lv;
+    document.getElementById('sl_rate').value=c.rate;
+    document.getElementById('sl_met').value=c.metrics;
+  }
+  document.getElementById('sl_stats').textContent=(c.staConnected?'STA up':'STA down')+
+    ' · lines '+c.lines+' · sent '+c.sentLines+' in '+c.datagrams+' datagrams ('+c.bytes+' B)'+
+    ' · dropped '+c.dropped+' · send fails '+c.sendFails+' ('+c.failedLines+' lines)'+
+    ' · throttled '+c.throttled+' · queued '+c.buffered+' B';
+}
+function loadSyslog(fill){
+  fetch('/api/syslog').then(function(r){return r.json();}).then(function(c){showSyslog(c,fill);}).catch(function(){});
+}
+function saveSyslog(){
+  var q='set=1&on='+(document.getElementById('sl_on').checked?1:0)+
+    '&host='+encodeURIComponent(document.getElementById('sl_host').value)+
+    '&port='+encodeURIComponent(document.getElementById('sl_port').value)+
+    '&lv='+document.getElementById('sl_lv').value+
+    '&rate='+encodeURIComponent(document.getElementById('sl_rate').value)+
+    '&metrics='+encodeURIComponent(document.getElementById('sl_met').value);
+  fetch('/api/syslog?'+q).then(function(r){
+    if(!r.ok)return r.text().then(function(t){document.getElementById('sl_msg').innerText=t;});
+    document.getElementById('sl_msg').innerText="Saved";
+    return r.json().then(function(c){showSyslog(c,true);});
+  });
+}
+loadSyslog(true);setInterval(function(){loadSyslog(false);},3000);
 </script>
 </body></html>
 )rawliteral";
@@ -290,6 +513,7 @@ button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #
 <nav>
   <a href="/">Main</a>
   <a href="/bt" class="active">BT Debug</a>
+  <a href="/term">Terminal</a>
   <a href="/cdc">CDC Debug</a>
   <a href="/logs">All Logs</a>
   <a href="/wifi">WiFi</a>
@@ -301,6 +525,8 @@ button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #
   <div style="display:flex;gap:30px;">
     <div>State: <span id="st_state" class="status-val">-</span></div>
     <div>Power: <span id="st_power" class="status-val">-</span></div>
+    <div>FW: <span id="st_fw" style="color:#aaa;">-</span></div>
+    <div>Addr: <span id="st_addr" style="color:#aaa;">-</span></div>
   </div>
   <div style="margin-top:10px;">
     <div>Track: <span id="track_title" class="status-val">-</span></div>
@@ -321,7 +547,7 @@ button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #
 </section>
 <script>
 var paused=false,debugMode=false;
-var ws=new WebSocket('ws://'+location.hostname+':81/');
+var ws=new WebSocket('ws://'+location.hostname+':81/?ch=bt,sys');
 ws.onmessage=function(ev){
   var t=ev.data||"";
   if(t.indexOf("[BT]")==0||t.indexOf("[SYS]")==0){
@@ -369,6 +595,10 @@ function updateStatus(){
   }).catch(function(){});
 }
 setInterval(updateStatus,2000);updateStatus();
+fetch('/api/bt/identity').then(function(r){return r.json();}).then(function(id){
+  document.getElementById('st_fw').textContent=id.valid?id.version:'-';
+  document.getElementById('st_addr').textContent=id.address||'-';
+}).catch(function(){});
 fetch('/api/debug_status').then(function(r){return r.text();}).then(function(t){
   debugMode=(t==='ON');
   var btn=document.getElementById('debugBtn');
@@ -396,17 +626,31 @@ button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #
 .btn-dl{background:#036}
 .btn-dl:hover{background:#048}
 .row{display:flex;gap:10px}.half{flex:1}
+.sq{border-collapse:collapse;font-family:monospace;font-size:12px}
+.sq td,.sq th{padding:2px 8px;border-bottom:1px solid #333;text-align:right}
+.health{font-weight:bold;padding:2px 8px;border-radius:3px}
 </style></head>
 <body>
 <nav>
   <a href="/">Main</a>
   <a href="/bt">BT Debug</a>
+  <a href="/term">Terminal</a>
   <a href="/cdc" class="active">CDC Debug</a>
   <a href="/logs">All Logs</a>
   <a href="/wifi">WiFi</a>
   <a href="/update" style="color:#fa0">OTA</a>
 </nav>
 <h2>CDC Debug</h2>
+<section>
+  <h3 style="margin:0 0 5px 0">DataOut Signal Quality
+    <span id="sq_health" class="health" style="background:#333">-</span>
+    <button class="btn" onclick="resetSignal()">Reset</button>
+  </h3>
+  <table class="sq" id="sq_table"><tr><th>class</th><th>count</th><th>mean</th><th>std</th><th>min</th><th>max</th><th>margin lo</th><th>margin hi</th></tr></table>
+  <div style="margin-top:5px">Deglitch &lt;<input id="sq_dg" type="number" min="0" max="400" style="width:60px">µs
+    <button class="btn" onclick="setDeglitch()">Set</button>
+    repaired: <span id="sq_rep">-</span></div>
+</section>
 <div class="row">
   <div class="half">
     <section>
@@ -433,7 +677,8 @@ button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #
 </section>
 <script>
 var pausedEvt=false,pausedNec=false,debugMode=false;
-var ws=new WebSocket('ws://'+location.hostname+':81/');
+var ws=new WebSocket('ws://'+location.hostname+':81/?ch=cdc');
+ws.onopen=updateSub;
 ws.onmessage=function(ev){
   var t=ev.data||"";
   if(t.indexOf("[CDC_NEC]")==0&&debugMode){
@@ -470,6 +715,11 @@ function updateDebugUI(){
   btn.textContent='Debug Mode: '+(debugMode?'ON':'OFF');
   btn.style.background=debugMode?'#060':'#333';
   document.getElementById('raw_panel').style.opacity=debugMode?'1':'0.4';
+  updateSub();
+}
+// RAW канал нужен только в debug режиме — иначе сервер его нам не шлёт
+function updateSub(){
+  if(ws.readyState==1)ws.send('SUB ch=cdc'+(debugMode?',raw':''));
 }
 function downloadLog(id,name){
   var box=document.getElementById(id);
@@ -485,6 +735,28 @@ fetch('/api/debug_status').then(function(r){return r.text();}).then(function(t){
   debugMode=(t==='ON');
   updateDebugUI();
 }).catch(function(){});
+var HC={GOOD:'#060',MARGINAL:'#a60',BAD:'#a00',NO_DATA:'#333'};
+function showSignal(q){
+  var h=document.getElementById('sq_health');
+  h.textContent=q.health;h.style.background=HC[q.health]||'#333';
+  document.getElementById('sq_rep').textContent=q.deglitch.repaired;
+  var dg=document.getElementById('sq_dg');
+  if(document.activeElement!==dg)dg.value=q.deglitch.limitUs;
+  var t=document.getElementById('sq_table');
+  while(t.rows.length>1)t.deleteRow(1);
+  ['start','one','zero','noise','glitch'].forEach(function(k){
+    var c=q.classes[k],r=t.insertRow(-1);
+    var m=(k=='noise'||k=='glitch');
+    [k,c.count,c.mean,c.std,c.min,c.max,m?'-':c.marginLo,m||k=='start'?'-':c.marginHi].forEach(function(v,i){
+      var td=r.insertCell(-1);td.textContent=v;
+      if((i==6||i==7)&&v!=='-'&&c.count)td.style.color=v<0?'#f44':(v<150?'#fa0':'#0f0');
+    });
+  });
+}
+function setDeglitch(){fetch('/api/cdc/signal?deglitch='+document.getElementById('sq_dg').value).then(function(r){return r.json();}).then(showSignal);}
+function updateSignal(){fetch('/api/cdc/signal').then(function(r){return r.json();}).then(showSignal).catch(function(){});}
+function resetSignal(){fetch('/api/cdc/signal?reset=1').then(function(r){return r.json();}).then(showSignal);}
+setInterval(updateSignal,2000);updateSignal();
 </script>
 </body></html>
 )rawliteral";
@@ -510,6 +782,7 @@ button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #
 <nav>
   <a href="/">Main</a>
   <a href="/bt">BT Debug</a>
+  <a href="/term">Terminal</a>
   <a href="/cdc">CDC Debug</a>
   <a href="/logs" class="active">All Logs</a>
   <a href="/wifi">WiFi</a>
@@ -520,6 +793,7 @@ button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #
   <div style="margin-bottom:5px;">
     <button class="btn" onclick="togglePause()" id="pauseBtn">Pause</button>
     <button class="btn btn-dl" onclick="downloadLog()">Download</button>
+    <button class="btn btn-dl" onclick="location.href='/api/logs/download'">Server log (.gz)</button>
     <button class="btn" onclick="clr()">Clear</button>
     <button onclick="toggleDebug()" id="debugBtn" style="background:#333;margin-left:20px;">Debug Mode: OFF</button>
   </div>
@@ -527,7 +801,7 @@ button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #
 </section>
 <script>
 var paused=false,debugMode=false;
-var ws=new WebSocket('ws://'+location.hostname+':81/');
+var ws=new WebSocket('ws://'+location.hostname+':81/?ch=bt,cdc,raw,sys');
 ws.onmessage=function(ev){
   var t=ev.data||"";
   if(t.indexOf("SCOPE:")!=0){
@@ -576,6 +850,91 @@ fetch('/api/debug_status').then(function(r){return r.text();}).then(function(t){
 </body></html>
 )rawliteral";
 
+// 6. AT TERMINAL PAGE
+static const char TERM_PAGE[] PROGMEM = R"rawliteral(
+<!doctype html><html><head><meta charset="utf-8"><title>AT Terminal</title>
+<style>
+body{font-family:sans-serif;background:#111;color:#eee;margin:0;padding:5px}
+nav{margin-bottom:10px;padding:5px;background:#222;border-bottom:1px solid #444}
+nav a{color:#8cf;margin-right:15px;text-decoration:none;font-weight:bold}
+nav a:hover{text-decoration:underline}
+nav a.active{color:#fff;border-bottom:2px solid #8cf}
+section{margin-bottom:10px;padding:8px;border:1px solid #444;border-radius:4px;background:#1a1a1a}
+button{margin:2px;padding:6px 12px;background:#333;color:#fff;border:1px solid #666;border-radius:3px;cursor:pointer}
+.status-val{font-weight:bold;color:#fff}
+.log-box{background:#000;color:#0f0;font-family:monospace;overflow:auto;padding:4px;border:1px solid #333;font-size:12px;white-space:pre-wrap;margin:0}
+.atb{color:#8cf}
+input[type=text]{width:60%;background:#222;color:#fff;border:1px solid #555;padding:4px;font-family:monospace}
+small{color:#888}
+</style></head>
+<body>
+<nav>
+  <a href="/">Main</a>
+  <a href="/bt">BT Debug</a>
+  <a href="/term" class="active">Terminal</a>
+  <a href="/cdc">CDC Debug</a>
+  <a href="/logs">All Logs</a>
+  <a href="/wifi">WiFi</a>
+  <a href="/update" style="color:#fa0">OTA</a>
+</nav>
+<h2>AT Terminal</h2>
+<section>
+  <button onclick="ws.send('ATB open')">Open</button>
+  <button onclick="ws.send('ATB close')">Close</button>
+  <button onclick="document.getElementById('out').innerHTML=''">Clear</button>
+  <span style="margin-left:15px;">Bridge: <span id="b_state" class="status-val">-</span></span>
+  <div><small id="b_stats"></small></div>
+</section>
+<section>
+  <pre class="log-box" id="out" style="height:55vh;"></pre>
+  <div style="margin-top:5px;">
+    <input id="cmd" type="text" placeholder="AT+VER" autocomplete="off">
+    <button onclick="sendLine()">Send</button>
+  </div>
+  <small>Lines go through the driver queue one at a time; background status poll is paused while open.</small>
+</section>
+<script>
+var hist=[],hpos=0;
+var ws=new WebSocket('ws://'+location.hostname+':81/?ch=sys&lv=info');
+function put(t,cls){
+  var o=document.getElementById('out');
+  var s=document.createElement('span');
+  if(cls)s.className=cls;
+  s.textContent=t;o.appendChild(s);
+  while(o.childNodes.length>2000)o.removeChild(o.firstChild);
+  o.scrollTop=o.scrollHeight;
+}
+ws.onmessage=function(ev){
+  var t=ev.data||"";
+  if(t.indexOf("[ATR] ")==0)put(t.substring(6).replace(/\r/g,''));
+  else if(t.indexOf("[ATB]")==0)put(t+'\n','atb');
+};
+ws.onclose=function(){put('[ATB] websocket closed\n','atb');};
+function sendLine(){
+  var i=document.getElementById('cmd'),v=i.value.trim();
+  if(!v)return;
+  ws.send(v);put('> '+v+'\n','atb');
+  hist.push(v);hpos=hist.length;i.value='';
+}
+document.getElementById('cmd').addEventListener('keydown',function(e){
+  if(e.key==='Enter'){sendLine();}
+  else if(e.key==='ArrowUp'&&hpos>0){this.value=hist[--hpos];e.preventDefault();}
+  else if(e.key==='ArrowDown'&&hpos<hist.length){hpos++;this.value=hist[hpos]||'';e.preventDefault();}
+});
+function updateBridge(){
+  fetch('/api/bt/bridge').then(function(r){return r.json();}).then(function(b){
+    document.getElementById('b_state').textContent=b.active?'OPEN':'CLOSED';
+    document.getElementById('b_stats').textContent='pending '+b.pending+' · cmds '+b.commands+
+      ' · ok '+b.ok+' · err '+b.errors+' · timeout '+b.timeouts+' · busy '+b.busy+
+      ' · rx '+b.rxBytes+' B (dropped '+b.rxDropped+') · last '+b.lastMs+' ms · max '+b.maxMs+' ms'+
+      ' · poll '+(b.backgroundPoll?'ON':'OFF');
+  }).catch(function(){});
+}
+setInterval(updateBridge,2000);updateBridge();
+</script>
+</body></html>
+)rawliteral";
+
 // ======================= API HANDLERS =======================
 
 static void handleRoot() { 
@@ -593,68 +952,301 @@ static void handleWifiPage() { webServer.send_P(200, "text/html", WIFI_PAGE); }
 static void handleBtPage() { webServer.send_P(200, "text/html", BT_PAGE); }
 static void handleCdc() { webServer.send_P(200, "text/html", CDC_PAGE); }
 static void handleLogs() { webServer.send_P(200, "text/html", LOGS_PAGE); }
+static void handleTerm() { webServer.send_P(200, "text/html", TERM_PAGE); }
 
-static void handleStatus() {
-    BTConnState st = bt1036_getState();
-    BtDevStat   ds = bt1036_getDevStat();
-    String json = "{";
-    json += "\"state\":\"" + String(stateToStr(st)) + "\",";
-    json += "\"devstat\":{\"powerOn\":" + String(ds.powerOn ? "true":"false") + "}";
-    json += "}";
-    webServer.send(200, "application/json", json);
+// ApiRequest поверх текущего запроса WebServer (обработчики из web_api.cpp)
+class WebServerRequest : public ApiRequest {
+public:
+    String arg(const char *name) const override { return webServer.arg(name); }
+    bool hasArg(const char *name) const override { return webServer.hasArg(name); }
+};
+
+static void serveApi(ApiHandler handler) {
+    WebServerRequest req;
+    ApiResponse res;
+    handler(req, res);
+    webServer.send(res.code, res.contentType, res.body);
 }
 
-static void handleSetBasic() {
-    String name = webServer.arg("name");
-    bool nsuf = webServer.arg("ns") == "1";
-    String lname = webServer.arg("lname");
-    bool lsuf = webServer.arg("ls") == "1";
-    String cod = webServer.arg("cod");
-    if (name.length()) bt1036_setName(name, nsuf);
-    if (lname.length()) bt1036_setBLEName(lname, lsuf);
-    if (cod.length()) bt1036_setCod(cod);
+static void handleReboot() {
+    if(webServer.arg("target")=="bt") bt1036_softReboot();
+    else { sess_flush(); webServer.send(200, "text/plain", "Rebooting..."); delay(500); ESP.restart(); }
     webServer.send(200, "text/plain", "OK");
 }
 
-static void handleSetHfp() {
-    uint32_t rate = webServer.arg("rate").toInt();
-    uint8_t cfg = 0;
-    if (webServer.arg("cfg") != "") cfg = (uint8_t)webServer.arg("cfg").toInt(); 
-    bt1036_setHfpSampleRate(rate);
-    bt1036_setHfpConfig(cfg);
-    webServer.send(200, "text/plain", "OK");
+// GET /api/bench/isr[?start=<sec>&traffic=1 | ?stop=1] → бенчмарк задержки ISR
+static void handleBenchIsr() {
+    if (!isr_bench_available()) {
+        webServer.send(200, "application/json", "{\"available\":false}");
+        return;
+    }
+    if (webServer.hasArg("start")) {
+        uint16_t secs = (uint16_t)constrain(webServer.arg("start").toInt(), 1, 300);
+        isr_bench_start(secs, webServer.arg("traffic") == "1");
+    } else if (webServer.arg("stop") == "1") {
+        isr_bench_stop();
+    }
+
+    const IsrBenchResult &r = isr_bench_getResult();
+    uint8_t p99 = isr_bench_p99Bin();
+    const char *verdict = "no data";
+    if (r.pulses) {
+        if (r.decisionFlips || r.burstsLost) verdict = "hardware capture needed";
+        else if (p99 >= BENCH_BINS - 1 || BENCH_BIN_LIMITS_US[p99] > 50) verdict = "marginal";
+        else verdict = "software capture OK";
+    }
+
+    String json = "{\"available\":true";
+    json += ",\"running\":" + String(r.running ? "true" : "false");
+    json += ",\"traffic\":" + String(r.traffic ? "true" : "false");
+    json += ",\"bursts\":" + String(r.bursts);
+    json += ",\"burstsLost\":" + String(r.burstsLost);
+    json += ",\"pulses\":" + String(r.pulses);
+    json += ",\"decisionFlips\":" + String(r.decisionFlips);
+    json += ",\"udpPackets\":" + String(r.udpPackets);
+    json += ",\"wsMessages\":" + String(r.wsMessages);
+    json += ",\"hist\":[";
+    for (uint8_t i = 0; i < BENCH_BINS; ++i) {
+        if (i) json += ",";
+        json += "{\"belowUs\":" + (i < BENCH_BINS - 1 ? String(BENCH_BIN_LIMITS_US[i]) : String("null"));
+        json += ",\"count\":" + String(r.hist[i]) + "}";
+    }
+    json += "],\"p99BelowUs\":" + (p99 < BENCH_BINS - 1 ? String(BENCH_BIN_LIMITS_US[p99]) : String("null"));
+    json += ",\"widths\":[";
+    for (uint8_t i = 0; i < BENCH_WIDTH_COUNT; ++i) {
+        const BenchWidthStats &w = r.width[i];
+        if (i) json += ",";
+        json += "{\"us\":" + String(BENCH_WIDTHS_US[i]) + ",\"count\":" + String(w.count);
+        json += ",\"minErrUs\":" + String(w.minErrUs) + ",\"maxErrUs\":" + String(w.maxErrUs);
+        json += ",\"meanErrUs\":" + String(w.count ? (float)w.sumErrUs / w.count : 0.0f, 1) + "}";
+    }
+    json += "],\"verdict\":\"" + String(verdict) + "\"}";
+    webServer.send(200, "application/json", json);
 }
 
-static void handleProfile() {
-    bt1036_setProfile(webServer.arg("p").toInt());
-    bt1036_setAutoconn(webServer.arg("a").toInt());
-    webServer.send(200, "text/plain", "OK");
+// GET /api/bench/ws?start=<s>&rate=<msg/s>&size=<B> | ?stop=1 → прогон + стоимость рассылки
+static void handleBenchWs() {
+    if (webServer.hasArg("start")) {
+        uint16_t secs = (uint16_t)constrain(webServer.arg("start").toInt(), 1, 300);
+        uint16_t rate = webServer.hasArg("rate") ? (uint16_t)constrain(webServer.arg("rate").toInt(), 1, WSB_MAX_RATE) : 20;
+        uint16_t size = webServer.hasArg("size") ? (uint16_t)constrain(webServer.arg("size").toInt(), WSB_MIN_SIZE, WSB_MAX_SIZE) : 128;
+        ws_bench_start(secs, rate, size);
+    } else if (webServer.arg("stop") == "1") {
+        ws_bench_stop();
+    }
+
+    const WsBenchResult &r = ws_bench_getResult();
+    const WsFanoutStats &f = btWebUI_getWsStats();
+    String json = "{\"running\":" + String(r.running ? "true" : "false");
+    json += ",\"rate\":" + String(r.rate);
+    json += ",\"size\":" + String(r.size);
+    json += ",\"seconds\":" + String(r.seconds);
+    json += ",\"sent\":" + String(r.sent);
+    json += ",\"minClients\":" + String(r.minClients == 0xFF ? 0 : r.minClients);
+    json += ",\"maxClients\":" + String(r.maxClients);
+    json += ",\"loopHzBefore\":" + String(r.loopHzBefore);
+    json += ",\"loopHzMin\":" + String(r.loopHzMin);
+    json += ",\"loopHzAvg\":" + String(r.loopSamples ? r.loopHzSum / r.loopSamples : 0);
+    json += ",\"fanout\":{\"clients\":" + String(f.clients);
+    json += ",\"broadcasts\":" + String(f.broadcasts);
+    json += ",\"sendFails\":" + String(f.sendFails);
+    json += ",\"skipped\":" + String(f.skipped);
+    json += ",\"bytes\":" + String(f.bytes);
+    json += ",\"avgUs\":" + String(f.broadcasts ? (uint32_t)(f.totalBroadcastUs / f.broadcasts) : 0);
+    json += ",\"maxUs\":" + String(f.maxBroadcastUs);
+    json += ",\"perClient\":[";
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; ++i) {
+        const WsClientStats &c = f.client[i];
+        if (i) json += ",";
+        json += "{\"sends\":" + String(c.sends) + ",\"fails\":" + String(c.fails) +
+                ",\"maxSendUs\":" + String(c.maxSendUs) +
+                ",\"ch\":" + String(wsSubCh[i]) + ",\"lv\":" + String(wsSubLv[i]) + "}";
+    }
+    json += "]}}";
+    webServer.send(200, "application/json", json);
 }
 
-static void handleAudio() {
-    bt1036_setMicGain(webServer.arg("mg").toInt());
-    bt1036_setSpkVol(webServer.arg("a2").toInt(), webServer.arg("hf").toInt());
-    bt1036_setTxPower(webServer.arg("tx").toInt());
-    webServer.send(200, "text/plain", "OK");
+// GET /api/logs/download → история лога в gzip: только кольцо в RAM
+// (LOG_CAPACITY строк), что старше — уже не хранится.
+// Обработчик лишь ставит загрузку; сжимает и отдаёт logDownloadPoll() из
+// шага web — по LOG_DL_LINES строк за проход и только когда сокет
+// принимает данные без ожидания (MSG_DONTWAIT): медленный клиент растягивает
+// загрузку, а не держит loop. Одна загрузка за раз, память — LogDownload
+// (~12 KiB) на время загрузки. WebServer после обработчика лишь отпускает
+// свою копию WiFiClient — соединение живёт, пока жива наша.
+//
+// Размер out — худший выход одного прохода. За проход в gz уходит не больше
+// WINDOW байт (длинная строка режется по проходам), значит не больше одного
+// сдвига окна: compress() ≤ BUF_SIZE − MAX_MATCH байт. finish() — отдельным
+// проходом: весь буфер + строка «overwritten» ≤ BUF_SIZE + 64 байт. Фиксированный
+// Хаффман — не больше 9 бит на байт (совпадение ≤ 23 бит на 3 байта),
+// плюс остаток m_out (< OUT_SIZE) и хвост gzip (EOB + CRC + ISIZE). Сжатие
+// начинается только с пустым out (HTTP-заголовок к тому времени отдан).
+// Проверка на хосте: test/host/test_gzip_stream.cpp.
+static const uint8_t  LOG_DL_LINES    = 8;      // строк сжатия за проход (не больше)
+static const uint16_t LOG_DL_NOTE_MAX = 64;
+static const uint16_t LOG_DL_OUT      = (GzipStream::BUF_SIZE + LOG_DL_NOTE_MAX) * 9 / 8 +
+                                        GzipStream::OUT_SIZE + 1 + 8;  // 5201
+static const uint32_t LOG_DL_STALL_MS = 10000;  // клиент не берёт данные — обрыв
+
+struct LogDownload {
+    GzipStream gz;
+    WiFiClient client;
+    uint32_t   next;        // номер (logBuf.pushed()) следующей строки
+    uint32_t   end;         // снимок на момент запроса: строки до этого номера
+    uint32_t   lost;        // вытеснены из кольца, пока шла загрузка
+    uint32_t   lineOff;     // уже отдано байт строки next (длинная — за несколько проходов)
+    uint32_t   progressMs;  // последний успешный send
+    uint16_t   outLen;
+    uint16_t   outOff;
+    bool       overflow;
+    bool       finished;
+    uint8_t    out[LOG_DL_OUT];
+};
+static LogDownload *logDl = nullptr;
+
+static void logDlSink(const uint8_t *data, size_t len, void *ctx) {
+    LogDownload *d = (LogDownload *)ctx;
+    if (d->outLen + len > LOG_DL_OUT) { d->overflow = true; return; }
+    memcpy(d->out + d->outLen, data, len);
+    d->outLen += len;
 }
 
-static void handleCmd() {
-    String act = webServer.arg("act");
-    if(act=="playpause") bt1036_playPause();
-    else if(act=="next") bt1036_nextTrack();
-    else if(act=="prev") bt1036_prevTrack();
-    else if(act=="connect") bt1036_connectLast();
-    else if(act=="disconnect") bt1036_disconnect();
-    else if(act=="scan") bt1036_startScan();
-    webServer.send(200, "text/plain", "OK");
+static void logDownloadEnd(const char *error) {
+    LogDownload *d = logDl;
+    logDl = nullptr;
+    d->client.stop();
+    if (error) {
+        btWebUI_log(String("[WEB] Log download aborted: ") + error, LogLevel::INFO);
+    } else {
+        btWebUI_log("[WEB] Log download: " + String(d->gz.bytesIn()) + " -> " + String(d->gz.bytesOut()) +
+                    " B" + (d->lost ? ", " + String(d->lost) + " lines overwritten" : String("")),
+                    LogLevel::DEBUG);
+    }
+    delete d;
 }
 
-static void handleReboot() {
-    if(webServer.arg("target")=="bt") bt1036_softReboot();
-    else { webServer.send(200, "text/plain", "Rebooting..."); delay(500); ESP.restart(); }
-    webServer.send(200, "text/plain", "OK");
+static void handleLogsDownload() {
+    if (logDl) {
+        webServer.send(503, "text/plain", "Another download in progress");
+        return;
+    }
+    LogDownload *d = new (std::nothrow) LogDownload();
+    if (!d) {
+        webServer.send(503, "text/plain", "Low memory");
+        return;
+    }
+    d->client     = webServer.client();
+    d->end        = logBuf.pushed();
+    d->next       = logBuf.oldestSeq();
+    d->progressMs = millis();
+
+    // Заголовки — в тот же буфер: ответ без длины, конец — закрытие соединения
+    static const char HDR[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: application/gzip\r\n"
+        "Content-Disposition: attachment; filename=\"vw-bt-log.txt.gz\"\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: close\r\n\r\n";
+    memcpy(d->out, HDR, sizeof(HDR) - 1);
+    d->outLen = sizeof(HDR) - 1;
+
+    d->gz.begin(logDlSink, d);
+    char hdr[64];
+    snprintf(hdr, sizeof(hdr), "# vw-bt log, uptime %lu ms, %lu lines\n",
+             (unsigned long)millis(), (unsigned long)(d->end - d->next));
+    d->gz.write(hdr);
+    logDl = d;
+}
+
+static void logDownloadPoll() {
+    LogDownload *d = logDl;
+    if (!d) return;
+    uint32_t now = millis();
+    if (d->overflow)            { logDownloadEnd("output buffer overflow"); return; }
+    if (!d->client.connected()) { logDownloadEnd("client closed"); return; }
+
+    // 1. Отдать накопленное — сколько сокет возьмёт сразу
+    if (d->outOff < d->outLen) {
+        int n = send(d->client.fd(), d->out + d->outOff, d->outLen - d->outOff, MSG_DONTWAIT);
+        if (n > 0) {
+            d->outOff += n;
+            d->progressMs = now;
+        } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            logDownloadEnd("send failed");
+            return;
+        }
+        if (d->outOff < d->outLen) {
+            if (now - d->progressMs > LOG_DL_STALL_MS) logDownloadEnd("client stalled");
+            return;  // не сжимаем дальше, пока клиент не заберёт
+        }
+        d->outOff = d->outLen = 0;
+    }
+    if (d->finished) { logDownloadEnd(nullptr); return; }
+
+    // 2. Все строки уже сжаты — хвост и finish() отдельным проходом
+    if (d->next == d->end) {
+        if (d->lost) {
+            char note[LOG_DL_NOTE_MAX];
+            snprintf(note, sizeof(note), "# %lu lines overwritten during download\n", (unsigned long)d->lost);
+            d->gz.write(note);
+        }
+        d->gz.finish();
+        d->finished = true;
+        return;
+    }
+
+    // 3. Следующие строки, не больше WINDOW байт; вытесненные за время загрузки — пропускаем
+    uint32_t budget = GzipStream::WINDOW;
+    uint32_t oldest = logBuf.oldestSeq();
+    if ((int32_t)(d->next - oldest) < 0) {
+        uint32_t to = (int32_t)(d->end - oldest) < 0 ? d->end : oldest;
+        if (d->lineOff) {  // начало строки уже ушло, остаток вытеснен
+            d->gz.write("\n");
+            budget--;
+        }
+        d->lineOff = 0;
+        d->lost += to - d->next;
+        d->next = to;
+    }
+    for (uint8_t k = 0; k < LOG_DL_LINES && d->next != d->end && budget; ++k) {
+        const String &line = logBuf[d->next - oldest].line;
+        uint32_t len = line.length();
+        if (d->lineOff < len) {
+            uint32_t n = len - d->lineOff;
+            if (n > budget) n = budget;
+            d->gz.write((const uint8_t *)line.c_str() + d->lineOff, n);
+            d->lineOff += n;
+            budget -= n;
+            if (d->lineOff < len) break;  // продолжение — в следующем проходе
+        }
+        if (!budget) break;
+        d->gz.write("\n");
+        budget--;
+        d->lineOff = 0;
+        d->next++;
+    }
+}
+
+// GET /api/build → профиль сборки и метрики для сравнения release/debug
+static void handleBuild() {
+    const CpuSample &c = cpu_getSample();
+    String json = "{";
+    json += "\"profile\":\"" FW_PROFILE_NAME "\",";
+    json += "\"coreDebugLevel\":" + String(CORE_DEBUG_LEVEL) + ",";
+#ifdef __OPTIMIZE_SIZE__
+    json += "\"opt\":\"size\",";
+#else
+    json += "\"opt\":\"speed\",";
+#endif
+    json += "\"sketchSize\":" + String(ESP.getSketchSize()) + ",";
+    json += "\"bootMs\":" + String(g_bootMs) + ",";
+    json += "\"loopHz\":" + String(c.loopHz) + ",";
+    json += "\"dataOutIsrAvgNs\":" + String(c.dataOutIsrAvgNs) + ",";
+    json += "\"load\":[" + String(c.load[0], 1) + "," + String(c.load[1], 1) + "]";
+    json += "}";
+    webServer.send(200, "application/json", json);
 }
-static void handleFactory() { bt1036_runFactorySetup(); webServer.send(200, "text/plain", "OK"); }
 
 static void handleApiScan() {
     int n = WiFi.scanNetworks();
@@ -680,6 +1272,51 @@ static void handleApiConnect() {
     } else webServer.send(400, "text/plain", "Bad SSID");
 }
 
+// GET /api/syslog  → настройки и счётчики отправки логов (UDP syslog)
+// GET /api/syslog?set=1&on=1&host=<ip>&port=514&lv=info&rate=10&metrics=30
+static void handleApiSyslog() {
+    if (webServer.hasArg("set")) {
+        SyslogConfig cfg = slog_getConfig();
+        if (webServer.hasArg("on"))      cfg.enabled  = webServer.arg("on") == "1";
+        if (webServer.hasArg("host"))    cfg.host     = webServer.arg("host");
+        if (webServer.hasArg("port"))    cfg.port     = (uint16_t)webServer.arg("port").toInt();
+        if (webServer.hasArg("rate"))    cfg.rate     = (uint8_t)constrain(webServer.arg("rate").toInt(), 0, 255);
+        if (webServer.hasArg("metrics")) cfg.metricsS = (uint16_t)constrain(webServer.arg("metrics").toInt(), 0, 3600);
+        if (webServer.hasArg("lv")) {
+            String lv = webServer.arg("lv");
+            if (lv == "info")         cfg.level = LogLevel::INFO;
+            else if (lv == "debug")   cfg.level = LogLevel::DEBUG;
+            else if (lv == "verbose") cfg.level = LogLevel::VERBOSE;
+        }
+        cfg.host.trim();
+        if (!slog_setConfig(cfg)) {
+            webServer.send(400, "text/plain", "Bad host/port/rate (host: IPv4, rate: 1..50)");
+            return;
+        }
+    }
+    const SyslogConfig &c = slog_getConfig();
+    const SyslogStats &s = slog_getStats();
+    String json = "{";
+    json += "\"enabled\":" + String(c.enabled ? "true" : "false");
+    json += ",\"host\":\"" + webApi_jsonEscape(c.host) + "\"";
+    json += ",\"port\":" + String(c.port);
+    json += ",\"lv\":\"" + String(WS_LV_NAMES[(uint8_t)c.level]) + "\"";
+    json += ",\"rate\":" + String(c.rate);
+    json += ",\"metrics\":" + String(c.metricsS);
+    json += ",\"staConnected\":" + String(WiFi.status() == WL_CONNECTED ? "true" : "false");
+    json += ",\"buffered\":" + String(slog_buffered());
+    json += ",\"lines\":" + String(s.lines);
+    json += ",\"dropped\":" + String(s.dropped);
+    json += ",\"datagrams\":" + String(s.datagrams);
+    json += ",\"sentLines\":" + String(s.sentLines);
+    json += ",\"bytes\":" + String(s.bytes);
+    json += ",\"sendFails\":" + String(s.sendFails);
+    json += ",\"failedLines\":" + String(s.failedLines);
+    json += ",\"throttled\":" + String(s.throttled);
+    json += "}";
+    webServer.send(200, "application/json", json);
+}
+
 // ======================= INIT & LOOP =======================
 
 void btWebUI_init() {
@@ -692,6 +1329,8 @@ void btWebUI_init() {
     WiFi.softAP(apSsid.c_str(), apPsk.c_str());
     if(s.length()) WiFi.begin(s.c_str(), p.c_str());
 
+    slog_init(hostname);
+
     if (MDNS.begin(hostname)) {
         MDNS.addService("http", "tcp", 80);
     }
@@ -702,45 +1341,26 @@ void btWebUI_init() {
     webServer.on("/bt", handleBtPage);
     webServer.on("/cdc", handleCdc);
     webServer.on("/logs", handleLogs);
+    webServer.on("/term", handleTerm);
     
     // API Routes
-    webServer.on("/api/status", handleStatus);
-    webServer.on("/api/cmd", handleCmd);
-    webServer.on("/api/audio", handleAudio);
-    webServer.on("/api/set_basic", handleSetBasic);
-    webServer.on("/api/set_profile", handleProfile);
-    webServer.on("/api/set_hfp", handleSetHfp);
     webServer.on("/api/reboot", handleReboot);
-    webServer.on("/api/factory", handleFactory);
     webServer.on("/api/wifi/scan", handleApiScan);
     webServer.on("/api/wifi/connect", handleApiConnect);
-    
-    webServer.on("/api/track", []() {
-        TrackInfo ti = bt1036_getTrackInfo();
-        // Escape quotes in strings for JSON
-        String title = ti.title; title.replace("\"", "\\\"");
-        String artist = ti.artist; artist.replace("\"", "\\\"");
-        String album = ti.album; album.replace("\"", "\\\"");
-        String json = "{";
-        json += "\"title\":\"" + title + "\",";
-        json += "\"artist\":\"" + artist + "\",";
-        json += "\"album\":\"" + album + "\",";
-        json += "\"elapsed\":" + String(ti.elapsedSec) + ",";
-        json += "\"total\":" + String(ti.totalSec) + ",";
-        json += "\"valid\":" + String(ti.valid ? "true" : "false");
-        json += "}";
-        webServer.send(200, "application/json", json);
-    });
-    
-    webServer.on("/api/debug", []() {
-        g_debugMode = !g_debugMode;
-        btWebUI_log(String("[SYS] Debug mode: ") + (g_debugMode ? "ON" : "OFF"));
-        webServer.send(200, "text/plain", g_debugMode ? "ON" : "OFF");
-    });
-    
-    webServer.on("/api/debug_status", []() {
-        webServer.send(200, "text/plain", g_debugMode ? "ON" : "OFF");
-    });
+    webServer.on("/api/syslog", handleApiSyslog);
+    webServer.on("/api/build", handleBuild);
+    webServer.on("/api/bench/isr", handleBenchIsr);
+    webServer.on("/api/bench/ws", handleBenchWs);
+    webServer.on("/api/logs/download", handleLogsDownload);
+
+    size_t apiCount = 0;
+    const ApiRoute *api = webApi_routes(apiCount);
+    for (size_t i = 0; i < apiCount; ++i) {
+        ApiHandler h = api[i].handler;
+        webServer.on(api[i].path, [h]() { serveApi(h); });
+    }
+
+    for (uint8_t i = 0; i < WS_MAX_CLIENTS; ++i) wsSubscribe(i, "");
 
     ElegantOTA.begin(&webServer);
     webServer.begin();
@@ -752,4 +1372,7 @@ void btWebUI_loop() {
     webServer.handleClient();
     ElegantOTA.loop();
     wsServer.loop();
+    logDownloadPoll();
+    atb_poll();
+    slog_poll();
 }
@@ -33,9 +33,47 @@ enum class LogLevel : uint8_t {
     VERBOSE  // Детальные логи (только при g_debugMode, не в ring buffer)
 };
 
+// Каналы WebSocket (по префиксу строки). Клиент подписывается при подключении
+// ws://host:81/?ch=bt,sys&lv=info,debug или текстом "SUB ch=... lv=...";
+// без подписки — всё. Уровни: info, debug, verbose (биты 1 << LogLevel).
+enum WsChannel : uint8_t {
+    WS_CH_BT    = 1 << 0,  // [BT]
+    WS_CH_CDC   = 1 << 1,  // [CDC], [BTN]
+    WS_CH_RAW   = 1 << 2,  // [CDC_NEC]: сниффер, коды кнопок
+    WS_CH_SYS   = 1 << 3,  // [MAIN], [SYS], [MEM] и всё остальное
+    WS_CH_BENCH = 1 << 4,  // [BENCH], [WSB]
+    WS_CH_ALL   = 0x1F
+};
+
+// Рассылка WS: стоимость отправки по клиентам (слоты WebSocketsServer)
+static const uint8_t WS_MAX_CLIENTS = 5;  // = WEBSOCKETS_SERVER_CLIENT_MAX
+
+struct WsClientStats {
+    uint32_t sends;
+    uint32_t fails;        // sendTXT() == false: сообщение клиенту потеряно
+    uint32_t maxSendUs;    // дольше всего блокировала запись в TCP
+};
+
+struct WsFanoutStats {
+    uint32_t broadcasts;
+    uint32_t sendFails;
+    uint32_t skipped;      // отправок не сделано: клиент не подписан
+    uint32_t bytes;        // отправлено (payload)
+    uint64_t totalBroadcastUs;
+    uint32_t maxBroadcastUs;
+    uint8_t  clients;      // подключено при последней рассылке
+    WsClientStats client[WS_MAX_CLIENTS];
+};
+
 void btWebUI_init();
 void btWebUI_loop();
 void btWebUI_log(const String &line);  // backward compat, = INFO
 void btWebUI_log(const String &line, LogLevel level);
 void btWebUI_broadcastCdcRaw(const String &line);
-void btWebUI_setDebug(bool on);
\ No newline at end of file
+void btWebUI_broadcastBench(const char *payload);  // нагрузка для isr_bench/ws_bench, мимо лога
+const WsFanoutStats &btWebUI_getWsStats();
+void btWebUI_resetWsStats();
+// Есть ли подписчик на канал/уровень (чтобы не собирать строку зря)
+bool btWebUI_wsWants(uint8_t channel, LogLevel level);
+void btWebUI_setDebug(bool on);
+void btWebUI_setBootMs(uint32_t ms);  // время setup() для /api/build
\ No newline at end of file
@@ -0,0 +1,24 @@
+/**
+ * @file build_config.h
+ * @brief Build profile switches (set by the platformio.ini environments)
+ *
+ *   FW_DEBUG=1 (debug env, default) — firmware debug instrumentation compiled
+ *     in: edge counters, RAW pulse sniffer, [PLAY] frame hex log, decoder
+ *     cycle accounting. Still gated at runtime by debug mode.
+ *   FW_DEBUG=0 (release env) — all of the above compiled out.
+ *
+ * Measurement hooks used to compare the profiles (loop rate, DataOut ISR
+ * cost, sketch size, boot time on /api/build) stay in both.
+ */
+
+#pragma once
+
+#ifndef FW_DEBUG
+#define FW_DEBUG 1
+#endif
+
+#if FW_DEBUG
+#define FW_PROFILE_NAME "debug"
+#else
+#define FW_PROFILE_NAME "release"
+#endif
@@ -0,0 +1,147 @@
+/**
+ * @file cdc_profile.h
+ * @brief Compile-time head-unit protocol profiles for the CDC emulator
+ *
+ * Each profile is a traits struct with the frame templates, startup
+ * sequence, mode-byte table, DataOut button codes and timing for one
+ * family of head units. vw_cdc.cpp instantiates its frame and decode
+ * paths once per profile, so nothing inside them branches on the profile.
+ *
+ * Selection:
+ *   -DCDC_PROFILE_FIXED=<id>   only this profile is compiled in
+ *   -DCDC_DEFAULT_PROFILE=<id> default when NVS ("cdc"/"profile") is empty
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "vw_cdc.h"
+
+// ID профиля (значение хранится в NVS, не менять нумерацию!)
+enum class CdcProfileId : uint8_t {
+    RNS_MFD = 0,   // VW RNS-MFD (проверено в машине)
+    GAMMA   = 1,   // VW Gamma / Beta, Audi Concert / Chorus
+    SKODA   = 2    // Skoda Symphony / Stream
+};
+
+static const uint8_t CDC_PROFILE_COUNT = 3;
+
+#ifndef CDC_DEFAULT_PROFILE
+#define CDC_DEFAULT_PROFILE 0
+#endif
+
+// ============================================================================
+// RNS-MFD — базовый профиль, все значения подтверждены логами
+// ============================================================================
+struct CdcProfileRnsMfd {
+    static constexpr CdcProfileId ID = CdcProfileId::RNS_MFD;
+    static const char* name() { return "RNS-MFD"; }
+
+    // --- Timing ---
+    static constexpr uint32_t SPI_HZ          = 62500;  // SPI_MODE1, MSB first
+    static constexpr uint32_t BYTE_GAP_US     = 874;    // пауза между байтами кадра
+    static constexpr uint32_t FRAME_PERIOD_MS = 50;     // 20 кадров/сек (vwcdpic)
+    static constexpr uint32_t MIN_FRAME_GAP_MS = 20;    // внеочередной кадр: не чаще (от начала до начала)
+    static constexpr uint32_t DEBOUNCE_MS     = 300;    // повтор той же кнопки
+
+    // --- Frame templates ---
+    static constexpr uint8_t CMD_PLAY      = 0x34;
+    static constexpr uint8_t CMD_IDLE      = 0x74;
+    static constexpr uint8_t TRAILER       = 0x3C;
+    static constexpr uint8_t IDLE_BYTE6    = 0x8F;  // IDLE: 74 BE FE FF FF FF 8F 7C
+    static constexpr uint8_t IDLE_TRAILER  = 0x7C;
+    static constexpr uint8_t ANNOUNCE_MODE = 0xB7;  // vwcdpic constant (B7, AC, CE, DA, C8 seen)
+    static constexpr uint8_t MUTE_INIT     = 0xEF;  // InitPlay normal frame
+    static constexpr uint8_t MUTE_LEAD_IN  = 0xAE;  // PlayLeadIn normal frame
+    static constexpr uint8_t MODE_NEUTRAL  = 0xFF;  // cdc_resetModeFF()
+
+    // --- Startup sequence (vwcdpic BIDIcount) ---
+    static constexpr int     IDLE_THEN_PLAY_PACKETS = 20;
+    static constexpr int     INIT_PLAY_PACKETS      = 24;
+    static constexpr int     LEAD_IN_PACKETS        = 10;
+    static constexpr uint8_t DISCLOAD_FIRST         = 0x2E;  // CD1 announce
+    static constexpr uint8_t DISCLOAD_LAST          = 0x29;  // CD6 announce
+
+    // Байт 5: 0x00=norm, 0x04=MIX, 0xD0=SCAN, 0xD4=both
+    static constexpr uint8_t modeByte(bool scan, bool mix) {
+        return scan ? (mix ? 0xD4 : 0xD0) : (mix ? 0x04 : 0x00);
+    }
+    // Байт 6: всегда 0xCF
+    static constexpr uint8_t scanByte(bool /*scan*/) { return 0xCF; }
+
+    // --- DataOut: [0x53] [0x2C] [cmdcode] [~cmdcode] ---
+    static constexpr uint8_t DATAOUT_ADDR1 = 0x53;
+    static constexpr uint8_t DATAOUT_ADDR2 = 0x2C;
+
+    static CdcButton decode(uint8_t cmdcode) {
+        switch (cmdcode) {
+            // Треки
+            case 0xF8: return CdcButton::NEXT_TRACK;
+            case 0x78: return CdcButton::PREV_TRACK;
+            // CD кнопки (коды подтверждены RAW логами)
+            case 0x0C: return CdcButton::DISC_1;
+            case 0x8C: return CdcButton::DISC_2;
+            case 0x4C: return CdcButton::DISC_3;
+            case 0xCC: return CdcButton::DISC_4;
+            case 0x2C: return CdcButton::DISC_5;
+            case 0xAC: return CdcButton::DISC_6;
+            // Функции
+            case 0xA0: return CdcButton::SCAN_TOGGLE;
+            case 0xE0: return CdcButton::RANDOM_TOGGLE;
+            // 0x14 = repeat, 0x38 = CD confirm — игнорируем
+            default:   return CdcButton::UNKNOWN;
+        }
+    }
+};
+
+// ============================================================================
+// Gamma / Beta / Concert — старые магнитолы (по заметкам vwcdpic)
+// MIX/SCAN показываются раздельно: байт 5 = 0xFF/0x55, байт 6 = 0xCF/0x4F.
+// Шлют PLAY (0x08) и STOP (0x10) при входе/выходе из режима CD.
+// ============================================================================
+struct CdcProfileGamma : CdcProfileRnsMfd {
+    static constexpr CdcProfileId ID = CdcProfileId::GAMMA;
+    static const char* name() { return "Gamma/Beta/Concert"; }
+
+    static constexpr uint8_t modeByte(bool /*scan*/, bool mix) { return mix ? 0x55 : 0xFF; }
+    static constexpr uint8_t scanByte(bool scan) { return scan ? 0x4F : 0xCF; }
+
+    static CdcButton decode(uint8_t cmdcode) {
+        switch (cmdcode) {
+            case 0x08: return CdcButton::PLAY_PAUSE;
+            case 0x10: return CdcButton::STOP;
+            default:   return CdcProfileRnsMfd::decode(cmdcode);
+        }
+    }
+};
+
+// ============================================================================
+// Skoda Symphony / Stream — RNS-таблица режимов, но дольше "прогревается"
+// и медленнее разбирает кадры (больше пауза между байтами).
+// ============================================================================
+struct CdcProfileSkoda : CdcProfileRnsMfd {
+    static constexpr CdcProfileId ID = CdcProfileId::SKODA;
+    static const char* name() { return "Skoda Symphony/Stream"; }
+
+    static constexpr uint32_t BYTE_GAP_US            = 1000;
+    static constexpr uint32_t MIN_FRAME_GAP_MS       = 30;
+    static constexpr int      IDLE_THEN_PLAY_PACKETS = 40;
+
+    static CdcButton decode(uint8_t cmdcode) {
+        switch (cmdcode) {
+            case 0x10: return CdcButton::STOP;
+            case 0x58: return CdcButton::NEXT_DISC;
+            case 0xD8: return CdcButton::PREV_DISC;
+            default:   return CdcProfileRnsMfd::decode(cmdcode);
+        }
+    }
+};
+
+// ---- API выбора профиля (реализация в vw_cdc.cpp) ----
+
+// Активный профиль (загружается в cdc_init())
+CdcProfileId cdc_getProfile();
+const char*  cdc_getProfileName();
+
+// Сохранить профиль в NVS, применяется после перезагрузки.
+// false — профиль не скомпилирован в эту сборку (CDC_PROFILE_FIXED).
+bool cdc_setProfile(CdcProfileId id);
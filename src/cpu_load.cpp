@@ -0,0 +1,98 @@
+#include "cpu_load.h"
+#include "timer_wheel.h"
+#include "vw_cdc.h"
+#include "bt_webui.h"
+#include <esp_freertos_hooks.h>
+#include <esp_timer.h>
+
+// Интервал между вызовами idle hook, который ещё считается непрерывным
+// простоем. Больше — idle task вытесняли (задача или длинное прерывание).
+static const int64_t IDLE_GAP_US = 50;
+
+static const uint32_t SAMPLE_MS = 1000;
+
+static volatile uint32_t g_idleUs[CPU_CORES] = {};  // 32 бит — атомарно читается с другого ядра
+static int64_t           g_lastHook[CPU_CORES] = {};
+
+static CpuSample g_sample = {};
+static uint8_t   g_loopCore = 1;
+
+// Снимок накопительных счётчиков в начале окна
+static int64_t  g_winStart = 0;
+static uint32_t g_idleStart[CPU_CORES] = {};
+static uint32_t g_isrCyclesStart = 0;
+static uint32_t g_isrCallsStart  = 0;
+static uint64_t g_stepStart[SCHED_MAX_STEPS] = {};
+static uint32_t g_passesStart = 0;
+
+template <uint8_t CORE>
+static bool idleHook() {
+    int64_t now = esp_timer_get_time();
+    int64_t gap = now - g_lastHook[CORE];
+    g_lastHook[CORE] = now;
+    if (gap < IDLE_GAP_US) g_idleUs[CORE] += (uint32_t)gap;
+    return false;  // крутиться дальше — без WAITI, иначе простой не измерить
+}
+
+static void sample() {
+    int64_t  now    = esp_timer_get_time();
+    uint32_t window = (uint32_t)(now - g_winStart);
+    if (window == 0) return;
+    g_sample.windowUs = window;
+
+    for (uint8_t c = 0; c < CPU_CORES; ++c) {
+        uint32_t idle = g_idleUs[c];
+        uint32_t d    = idle - g_idleStart[c];
+        g_idleStart[c] = idle;
+        float busy = 100.0f - 100.0f * (float)d / (float)window;
+        g_sample.load[c] = busy < 0 ? 0 : busy;
+    }
+
+    uint32_t cycles, calls;
+    cdc_getIsrLoad(cycles, calls);
+    uint32_t dCycles = cycles - g_isrCyclesStart;
+    uint32_t dCalls  = calls - g_isrCallsStart;
+    g_isrCyclesStart = cycles;
+    g_isrCallsStart  = calls;
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    g_sample.dataOutIsrCalls = dCalls;
+    g_sample.dataOutIsrPct   = mhz ? 100.0f * ((float)dCycles / mhz) / (float)window : 0;
+    g_sample.dataOutIsrAvgNs = (mhz && dCalls) ? (uint32_t)((uint64_t)dCycles * 1000 / mhz / dCalls) : 0;
+
+    g_sample.stepCount = sched_getStepCount();
+    for (uint8_t i = 0; i < g_sample.stepCount; ++i) {
+        uint64_t total = sched_getStep(i)->totalRunUs;
+        // sched_resetStats() обнуляет счётчики — окно начинается заново
+        uint64_t d = total >= g_stepStart[i] ? total - g_stepStart[i] : total;
+        g_stepStart[i] = total;
+        g_sample.stepPct[i] = 100.0f * (float)d / (float)window;
+    }
+
+    uint32_t passes = sched_getPasses();
+    uint32_t dPasses = passes >= g_passesStart ? passes - g_passesStart : passes;
+    g_passesStart = passes;
+    g_sample.loopHz = (uint32_t)((uint64_t)dPasses * 1000000 / window);
+
+    g_winStart = now;
+}
+
+void cpu_init() {
+    g_loopCore = (uint8_t)xPortGetCoreID();
+    int64_t now = esp_timer_get_time();
+    for (uint8_t c = 0; c < CPU_CORES; ++c) g_lastHook[c] = now;
+
+    if (esp_register_freertos_idle_hook_for_cpu(idleHook<0>, 0) != ESP_OK ||
+        esp_register_freertos_idle_hook_for_cpu(idleHook<1>, 1) != ESP_OK) {
+        btWebUI_log("[CPU] idle hook registration failed", LogLevel::INFO);
+    }
+
+    g_winStart = now;
+    cdc_getIsrLoad(g_isrCyclesStart, g_isrCallsStart);
+    timer_start(sample, SAMPLE_MS, SAMPLE_MS);
+}
+
+const CpuSample &cpu_getSample() { return g_sample; }
+
+uint8_t cpu_getLoopCore() { return g_loopCore; }
+
+uint32_t cpu_getFreqMHz() { return ESP.getCpuFreqMHz(); }
@@ -0,0 +1,44 @@
+/**
+ * @file cpu_load.h
+ * @brief Per-core CPU utilization from FreeRTOS idle hooks
+ *
+ * An idle hook on each core accumulates the time the idle task actually
+ * spins; everything else on that core is busy time. Sampled once per
+ * second (timer wheel) and broken down into:
+ *   - DataOut edge ISR (measured in the ISR itself, CPU cycles);
+ *   - loop() scheduler steps (cdc_frame busy-wait, bt, web, ...);
+ *   - other — IDF interrupts and tasks that can't be instrumented from
+ *     Arduino code (UART, WiFi/lwIP, which live on core 0).
+ *
+ * loop() never blocks, so core 1 idle is ~0 by design; its headroom is the
+ * share not taken by steps and ISRs.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "loop_sched.h"
+
+static const uint8_t CPU_CORES = 2;
+
+struct CpuSample {
+    uint32_t windowUs;                 // длительность окна
+    float    load[CPU_CORES];          // % busy
+    float    dataOutIsrPct;            // % ядра, на котором висит DataOut ISR
+    uint32_t dataOutIsrCalls;          // вызовов за окно
+    uint32_t dataOutIsrAvgNs;          // средняя стоимость вызова
+    float    stepPct[SCHED_MAX_STEPS]; // % окна по шагам loop()
+    uint8_t  stepCount;
+    uint32_t loopHz;                   // проходов sched_loop() в секунду
+};
+
+// Вызывать после timer_init() и регистрации шагов планировщика
+void cpu_init();
+
+// Последнее окно (1 с)
+const CpuSample &cpu_getSample();
+
+// Частота CPU (такты → ns в /api/cdc/decoders)
+uint32_t cpu_getFreqMHz();
+
+// Ядро loop() / DataOut ISR (attachInterrupt из setup → ядро loopTask)
+uint8_t cpu_getLoopCore();
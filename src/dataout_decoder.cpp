@@ -0,0 +1,341 @@
+#include "dataout_decoder.h"
+#include <math.h>
+
+// ---------------- Pulse statistics ----------------
+
+void PulseClassStats::add(uint32_t us) {
+    if (count == 0 || us < min) min = us;
+    if (us > max) max = us;
+    count++;
+    sum += us;
+    sumSq += (uint64_t)us * us;
+}
+
+float PulseClassStats::mean() const {
+    return count ? (float)sum / count : 0.0f;
+}
+
+float PulseClassStats::stddev() const {
+    if (count < 2) return 0.0f;
+    float m = mean();
+    float var = (float)sumSq / count - m * m;
+    return var > 0 ? sqrtf(var) : 0.0f;
+}
+
+// ---------------- VW DataOut ----------------
+
+void VwDataOutDecoder::reset() {
+    m_bits = 0;
+    m_busy = false;
+    m_word = 0;
+}
+
+void VwDataOutDecoder::resetSignalStats() {
+    for (uint8_t i = 0; i < PC_COUNT; ++i) pulseClass[i] = PulseClassStats();
+    longLow = 0;
+}
+
+// Пороги решения вокруг каждого класса: [lo, hi)
+static void classBounds(PulseClass c, uint32_t &lo, uint32_t &hi) {
+    switch (c) {
+        case PC_ZERO:  lo = VwDataOutDecoder::LOW_THRESHOLD;   hi = VwDataOutDecoder::HIGH_THRESHOLD;  break;
+        case PC_ONE:   lo = VwDataOutDecoder::HIGH_THRESHOLD;  hi = VwDataOutDecoder::START_THRESHOLD; break;
+        case PC_START: lo = VwDataOutDecoder::START_THRESHOLD; hi = VwDataOutDecoder::START_MAX;       break;
+        default:       lo = 0; hi = 0; break;
+    }
+}
+
+int32_t VwDataOutDecoder::marginLowUs(PulseClass c) const {
+    uint32_t lo, hi;
+    classBounds(c, lo, hi);
+    const PulseClassStats &st = pulseClass[c];
+    if (hi == 0 || st.count == 0) return 0;
+    return (int32_t)(st.mean() - 3.0f * st.stddev()) - (int32_t)lo;
+}
+
+int32_t VwDataOutDecoder::marginHighUs(PulseClass c) const {
+    uint32_t lo, hi;
+    classBounds(c, lo, hi);
+    const PulseClassStats &st = pulseClass[c];
+    if (hi == 0 || st.count == 0) return 0;
+    return (int32_t)hi - (int32_t)(st.mean() + 3.0f * st.stddev());
+}
+
+SignalHealth VwDataOutDecoder::health() const {
+    uint32_t bits = pulseClass[PC_ZERO].count + pulseClass[PC_ONE].count;
+    if (bits == 0) return SignalHealth::NO_DATA;
+
+    int32_t worst = INT32_MAX;
+    const PulseClass data[] = { PC_ZERO, PC_ONE, PC_START };
+    for (uint8_t i = 0; i < 3; ++i) {
+        if (pulseClass[data[i]].count == 0) continue;
+        int32_t lo = marginLowUs(data[i]);
+        int32_t hi = marginHighUs(data[i]);
+        if (lo < worst) worst = lo;
+        if (data[i] != PC_START && hi < worst) worst = hi;  // у старта верх — не порог решения
+    }
+
+    // Иголки/шум больше 1% от бит — уровень/подтяжка под вопросом
+    uint32_t junk = pulseClass[PC_GLITCH].count + pulseClass[PC_NOISE].count;
+    if (worst < 0) return SignalHealth::BAD;
+    if (worst < GOOD_MARGIN_US || junk * 100 > bits) return SignalHealth::MARGINAL;
+    return SignalHealth::GOOD;
+}
+
+bool VwDataOutDecoder::feed(bool level, uint32_t us, uint8_t pkt[4]) {
+    stats.pulses++;
+
+    // HIGH-паузы несут только разделение бит
+    if (level) return false;
+
+    // Классификация для отчёта о качестве сигнала
+    if (us < GLITCH_THRESHOLD)      pulseClass[PC_GLITCH].add(us);
+    else if (us < LOW_THRESHOLD)    pulseClass[PC_NOISE].add(us);
+    else if (us < HIGH_THRESHOLD)   pulseClass[PC_ZERO].add(us);
+    else if (us < START_THRESHOLD)  pulseClass[PC_ONE].add(us);
+    else if (us <= START_MAX)       pulseClass[PC_START].add(us);
+    else                            longLow++;
+
+    // Filter noise (too short)
+    if (us < LOW_THRESHOLD) return false;
+
+    // Check for START bit (begins new packet)
+    if (us >= START_THRESHOLD) {
+        if (m_busy && m_bits > 0) stats.aborted++;
+        m_busy = true;
+        m_bits = 0;
+        m_word = 0;
+        return false;  // Don't store start bit itself
+    }
+
+    // Only capture data if we're in a packet
+    if (!m_busy) return false;
+
+    // Shift bit in - vwcdpic uses rlf (rotate left), new bit goes to LSB
+    m_word = (m_word << 1) | (us >= HIGH_THRESHOLD ? 1u : 0u);
+    m_bits++;
+
+    if (m_bits < 32) return false;
+
+    // Packet complete
+    m_busy = false;
+    m_bits = 0;
+    pkt[0] = (uint8_t)(m_word >> 24);
+    pkt[1] = (uint8_t)(m_word >> 16);
+    pkt[2] = (uint8_t)(m_word >> 8);
+    pkt[3] = (uint8_t)(m_word);
+    stats.frames++;
+    return true;
+}
+
+// ---------------- NEC ----------------
+
+// Допуски (µs), по STM8 reference + запас на дрожание ISR
+static const uint32_t NEC_LEADER_HIGH_MIN = 8000;
+static const uint32_t NEC_LEADER_HIGH_MAX = 10000;
+static const uint32_t NEC_LEADER_LOW_MIN  = 4000;
+static const uint32_t NEC_LEADER_LOW_MAX  = 5000;
+static const uint32_t NEC_REPEAT_LOW_MIN  = 2000;
+static const uint32_t NEC_REPEAT_LOW_MAX  = 2500;
+static const uint32_t NEC_BIT_LOW_MIN     = 300;
+static const uint32_t NEC_BIT_LOW_MAX     = 800;
+static const uint32_t NEC_BIT0_HIGH_MAX   = 800;
+static const uint32_t NEC_BIT1_HIGH_MIN   = 1000;
+static const uint32_t NEC_BIT1_HIGH_MAX   = 2500;
+
+static inline uint8_t reverseBits(uint8_t b) {
+    b = (uint8_t)((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+    b = (uint8_t)((b & 0xCC) >> 2 | (b & 0x33) << 2);
+    b = (uint8_t)((b & 0xAA) >> 1 | (b & 0x55) << 1);
+    return b;
+}
+
+void NecDecoder::reset() {
+    m_state = WAIT_LEADER_HIGH;
+    m_bits = 0;
+    m_word = 0;
+}
+
+void NecDecoder::abort() {
+    if (m_bits > 0) stats.aborted++;
+    reset();
+}
+
+bool NecDecoder::feed(bool level, uint32_t us, uint8_t pkt[4]) {
+    stats.pulses++;
+
+    switch (m_state) {
+        case WAIT_LEADER_HIGH:
+            if (level && us >= NEC_LEADER_HIGH_MIN && us <= NEC_LEADER_HIGH_MAX) {
+                m_state = WAIT_LEADER_LOW;
+            }
+            return false;
+
+        case WAIT_LEADER_LOW:
+            if (!level && us >= NEC_LEADER_LOW_MIN && us <= NEC_LEADER_LOW_MAX) {
+                // Уровни чередуются: за leader LOW сразу идёт HIGH первого бита
+                m_state = BIT_HIGH;
+                m_bits = 0;
+                m_word = 0;
+            } else if (!level && us >= NEC_REPEAT_LOW_MIN && us <= NEC_REPEAT_LOW_MAX) {
+                repeats++;
+                reset();
+            } else {
+                reset();
+            }
+            return false;
+
+        case BIT_HIGH:
+            if (!level) {
+                abort();
+                return false;
+            }
+            if (us <= NEC_BIT0_HIGH_MAX) {
+                // bit 0 — ничего не ставим
+            } else if (us >= NEC_BIT1_HIGH_MIN && us <= NEC_BIT1_HIGH_MAX) {
+                m_word |= (1UL << m_bits);  // LSB first
+            } else {
+                abort();
+                // Длинный HIGH может быть началом следующего leader
+                if (us >= NEC_LEADER_HIGH_MIN && us <= NEC_LEADER_HIGH_MAX) m_state = WAIT_LEADER_LOW;
+                return false;
+            }
+            m_bits++;
+            if (m_bits < 32) {
+                m_state = BIT_LOW;
+                return false;
+            }
+            break;
+
+        case BIT_LOW:
+            // Разделитель между битами
+            if (!level && us >= NEC_BIT_LOW_MIN && us <= NEC_BIT_LOW_MAX) {
+                m_state = BIT_HIGH;
+            } else {
+                abort();
+            }
+            return false;
+    }
+
+    // 32 бита: addr_lo, addr_hi, cmd, ~cmd → порядок бит VW
+    pkt[0] = reverseBits((uint8_t)(m_word));
+    pkt[1] = reverseBits((uint8_t)(m_word >> 8));
+    pkt[2] = reverseBits((uint8_t)(m_word >> 16));
+    pkt[3] = reverseBits((uint8_t)(m_word >> 24));
+    reset();
+    stats.frames++;
+    return true;
+}
+
+// ---------------- Deglitch ----------------
+
+void PulseDeglitcher::reset() {
+    m_haveLow = false;
+    m_haveGap = false;
+    m_low = 0;
+    m_gap = 0;
+}
+
+static inline PulseDeglitcher::Pulse makePulse(bool level, uint32_t us) {
+    PulseDeglitcher::Pulse p = { level, us };
+    return p;
+}
+
+uint8_t PulseDeglitcher::feed(bool level, uint32_t us, Pulse out[3]) {
+    if (m_limit == 0) {
+        out[0] = makePulse(level, us);
+        return 1;
+    }
+    uint8_t n = 0;
+    if (!level) {
+        if (m_haveLow && m_haveGap) {
+            // LOW — иголка HIGH — LOW: один импульс
+            m_low += m_gap + us;
+            m_haveGap = false;
+            repaired++;
+            return 0;
+        }
+        if (m_haveLow) out[n++] = makePulse(false, m_low);  // два LOW подряд (потеря фронта)
+        m_low = us;
+        m_haveLow = true;
+        return n;
+    }
+
+    if (m_haveLow && !m_haveGap && us < m_limit) {
+        m_gap = us;
+        m_haveGap = true;
+        return 0;
+    }
+    if (m_haveLow) {
+        out[n++] = makePulse(false, m_low);
+        if (m_haveGap) out[n++] = makePulse(true, m_gap);  // два HIGH подряд
+        m_haveLow = false;
+        m_haveGap = false;
+    }
+    out[n++] = makePulse(true, us);
+    return n;
+}
+
+uint8_t PulseDeglitcher::flushIdle(uint32_t highUs, Pulse out[1]) {
+    if (!pending() || highUs < m_limit) return 0;
+    out[0] = makePulse(false, m_low);
+    m_haveLow = false;
+    return 1;
+}
+
+// ---------------- Mux ----------------
+
+void DataOutDecoderMux::add(PulseDecoder *dec) {
+    if (m_count < MAX_DECODERS) m_decoders[m_count++] = dec;
+}
+
+void DataOutDecoderMux::reset() {
+    for (uint8_t i = 0; i < m_count; ++i) {
+        m_decoders[i]->reset();
+        m_streak[i] = 0;
+    }
+    m_locked = -1;
+}
+
+bool DataOutDecoderMux::feed(bool level, uint32_t us, uint8_t pkt[4], uint8_t &source) {
+    bool delivered = false;
+
+    for (uint8_t i = 0; i < m_count; ++i) {
+        PulseDecoder *d = m_decoders[i];
+        uint8_t frame[4];
+
+        uint32_t t0 = m_clock ? m_clock() : 0;
+        bool got = d->feed(level, us, frame);
+        if (m_clock) {
+            uint32_t dt = m_clock() - t0;
+            d->stats.cycles += dt;
+            if (dt > d->stats.maxCycles) d->stats.maxCycles = dt;
+        }
+        if (!got) continue;
+
+        if (m_validate && !m_validate(frame)) {
+            d->stats.invalid++;
+            m_streak[i] = 0;
+            continue;
+        }
+        d->stats.valid++;
+        if (m_streak[i] < 255) m_streak[i]++;
+
+        if (m_locked == (int8_t)i) {
+            // Залоченный жив — у остальных серия сбрасывается
+            for (uint8_t j = 0; j < m_count; ++j) {
+                if (j != i) m_streak[j] = 0;
+            }
+        } else if (m_streak[i] >= LOCK_FRAMES) {
+            m_locked = (int8_t)i;
+            m_lockChanges++;
+        }
+
+        if ((m_locked < 0 || m_locked == (int8_t)i) && !delivered) {
+            pkt[0] = frame[0]; pkt[1] = frame[1]; pkt[2] = frame[2]; pkt[3] = frame[3];
+            source = i;
+            delivered = true;
+        }
+    }
+    return delivered;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file dataout_decoder.h
+ * @brief Pluggable decoders for the radio → CDC button line (DataOut)
+ *
+ * The DataOut ISR only timestamps edges; decoders run in cdc_loop() on the
+ * resulting pulse stream (level + duration). Every decoder sees every pulse,
+ * the mux locks onto whichever protocol produces valid frames.
+ *
+ * Both protocols yield the same 4-byte packet in VW order
+ * [addr1] [addr2] [cmdcode] [~cmdcode], so validation and the button table
+ * are shared (see cdc_profile.h).
+ *
+ * No Arduino dependencies — usable from host tools.
+ */
+
+#pragma once
+#include <stdint.h>
+
+// Статистика одного декодера
+struct DecoderStats {
+    uint32_t pulses;     // импульсов обработано
+    uint32_t frames;     // собрано 32-битных пакетов
+    uint32_t valid;      // прошли проверку (адрес + checksum)
+    uint32_t invalid;    // не прошли проверку
+    uint32_t aborted;    // пакет оборван (неверный тайминг посреди пакета)
+    uint32_t cycles;     // суммарная стоимость feed() в тактах CPU
+    uint32_t maxCycles;  // худший feed()
+};
+
+// Статистика длительностей одного класса импульсов (µs)
+struct PulseClassStats {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint64_t sumSq;
+
+    void  add(uint32_t us);
+    float mean() const;
+    float stddev() const;
+};
+
+// Классы LOW-импульсов VW DataOut (по порогам декодера)
+enum PulseClass : uint8_t {
+    PC_GLITCH,  // < 100µs — иголки, раньше молча отбрасывались
+    PC_NOISE,   // < LOW_THRESHOLD (256µs)
+    PC_ZERO,    // бит '0'
+    PC_ONE,     // бит '1'
+    PC_START,   // start bit (до 10ms, длиннее — не старт)
+    PC_COUNT
+};
+
+enum class SignalHealth : uint8_t { NO_DATA, GOOD, MARGINAL, BAD };
+
+class PulseDecoder {
+public:
+    virtual ~PulseDecoder() {}
+    virtual const char* name() const = 0;
+    virtual void reset() = 0;
+
+    // level — уровень линии во время импульса (false = LOW), us — длительность.
+    // true → собран пакет pkt[4] (порядок байт VW).
+    virtual bool feed(bool level, uint32_t us, uint8_t pkt[4]) = 0;
+
+    DecoderStats stats = {};
+};
+
+// ---------------- VW DataOut (vwcdpic) ----------------
+// Значение бита = длительность LOW:
+//   Start bit:  LOW > 3200µs (~4.57ms)
+//   Bit '1':    LOW > 1248µs (~1.77ms)
+//   Bit '0':    LOW < 1248µs (~650µs)
+//   Noise filter: LOW > 256µs minimum
+// Биты MSB first (vwcdpic: rlf).
+class VwDataOutDecoder : public PulseDecoder {
+public:
+    // Thresholds (in microseconds, matching vwcdpic with 32x prescaler)
+    static const uint32_t START_THRESHOLD = 3200;  // vwcdpic: 100 * 32µs
+    static const uint32_t HIGH_THRESHOLD  = 1248;  // vwcdpic: 39 * 32µs (bit 1)
+    static const uint32_t LOW_THRESHOLD   = 256;   // vwcdpic: 8 * 32µs (noise)
+
+    static const uint32_t GLITCH_THRESHOLD = 100;    // короче — иголка
+    static const uint32_t START_MAX        = 10000;  // длиннее — линия просто в LOW
+
+    // Здоровый запас (mean ± 3σ до порога), µs
+    static const int32_t  GOOD_MARGIN_US   = 150;
+
+    const char* name() const override { return "VW DataOut"; }
+    void reset() override;
+    bool feed(bool level, uint32_t us, uint8_t pkt[4]) override;
+
+    // --- Качество сигнала (накапливается всегда, сброс вручную) ---
+    PulseClassStats pulseClass[PC_COUNT] = {};
+    uint32_t        longLow = 0;  // LOW > START_MAX
+
+    void resetSignalStats();
+    // Запас до ближайшего порога решения по mean ± 3σ (отрицательный = перекрытие).
+    // Для PC_GLITCH/PC_NOISE и пустых классов — 0.
+    int32_t marginLowUs(PulseClass c) const;
+    int32_t marginHighUs(PulseClass c) const;
+    SignalHealth health() const;
+
+private:
+    uint8_t  m_bits = 0;      // принято бит в пакете (0..32)
+    bool     m_busy = false;  // внутри пакета (после start bit)
+    uint32_t m_word = 0;
+};
+
+// ---------------- NEC ----------------
+// Значение бита = длительность HIGH (см. .github/copilot-instructions.md):
+//   Leader:     9ms HIGH → 4.5ms LOW (repeat: 9ms HIGH → 2.25ms LOW)
+//   Bit '0':    ~560µs HIGH, Bit '1': ~1690µs HIGH
+//   Между битами ~560µs LOW (уровни чередуются: leader LOW → HIGH бита 0 →
+//   LOW → HIGH бита 1 … → HIGH бита 31, пакет готов)
+// Биты LSB first: addr_lo=0xCA, addr_hi=0x34, cmd, ~cmd — это те же 0x53 0x2C
+// VW-пакета с обратным порядком бит, поэтому байты переворачиваются.
+class NecDecoder : public PulseDecoder {
+public:
+    const char* name() const override { return "NEC"; }
+    void reset() override;
+    bool feed(bool level, uint32_t us, uint8_t pkt[4]) override;
+
+    uint32_t repeats = 0;  // принято repeat-кодов
+
+private:
+    enum State : uint8_t { WAIT_LEADER_HIGH, WAIT_LEADER_LOW, BIT_HIGH, BIT_LOW };
+    State    m_state = WAIT_LEADER_HIGH;
+    uint8_t  m_bits  = 0;
+    uint32_t m_word  = 0;
+
+    void abort();
+};
+
+// ---------------- Deglitch ----------------
+// Стоит перед декодерами. Иголка HIGH посреди LOW (помеха на жгуте) рвёт
+// '1' на два коротких импульса — пакет пропадает целиком. Фильтр склеивает
+// LOW a, HIGH g < limit, LOW b → LOW a+g+b (сколько угодно иголок подряд).
+// LOW отдаётся, только когда следующий HIGH точно длинный: по приходу этого
+// HIGH или по flushIdle(), если линия уже дольше limit в HIGH.
+// limit = 0 — фильтр выключен (импульсы проходят как есть).
+class PulseDeglitcher {
+public:
+    struct Pulse {
+        bool     level;
+        uint32_t us;
+    };
+
+    void     setLimit(uint32_t us) { m_limit = us; reset(); }
+    uint32_t limit() const { return m_limit; }
+    void     reset();
+
+    // Возвращает число готовых импульсов в out (0..3)
+    uint8_t feed(bool level, uint32_t us, Pulse out[3]);
+
+    // Отложен LOW (ждёт конца следующего HIGH)
+    bool pending() const { return m_haveLow && !m_haveGap; }
+    // Линия в HIGH уже highUs: если >= limit, отложенный LOW окончателен
+    uint8_t flushIdle(uint32_t highUs, Pulse out[1]);
+
+    uint32_t repaired = 0;   // склеек (убранных иголок HIGH)
+
+private:
+    uint32_t m_limit   = 0;
+    bool     m_haveLow = false;
+    bool     m_haveGap = false;
+    uint32_t m_low     = 0;
+    uint32_t m_gap     = 0;
+};
+
+// ---------------- Mux / auto-detect ----------------
+// Кормит все декодеры одним потоком импульсов. Пока протокол не определён,
+// отдаёт валидные пакеты от любого декодера; после LOCK_FRAMES валидных
+// пакетов подряд — только от него. Переключается, если другой декодер
+// набрал LOCK_FRAMES валидных пакетов, а залоченный за это время — ни одного.
+class DataOutDecoderMux {
+public:
+    typedef bool (*Validator)(const uint8_t pkt[4]);
+    typedef uint32_t (*CycleClock)();
+
+    static const uint8_t MAX_DECODERS = 2;
+    static const uint8_t LOCK_FRAMES  = 2;
+
+    void add(PulseDecoder *dec);
+    void setValidator(Validator v) { m_validate = v; }
+    void setClock(CycleClock c) { m_clock = c; }  // nullptr = без замера стоимости
+    void reset();
+
+    // true → пакет для обработки кнопки; source — индекс декодера
+    bool feed(bool level, uint32_t us, uint8_t pkt[4], uint8_t &source);
+
+    uint8_t       count() const { return m_count; }
+    PulseDecoder *decoder(uint8_t i) const { return m_decoders[i]; }
+    int8_t        locked() const { return m_locked; }  // -1 = автопоиск
+    uint32_t      lockChanges() const { return m_lockChanges; }
+
+private:
+    PulseDecoder *m_decoders[MAX_DECODERS] = {};
+    uint8_t       m_streak[MAX_DECODERS] = {};  // валидных подряд
+    uint8_t       m_count = 0;
+    int8_t        m_locked = -1;
+    uint32_t      m_lockChanges = 0;
+    Validator     m_validate = nullptr;
+    CycleClock    m_clock = nullptr;
+};
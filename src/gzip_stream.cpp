@@ -0,0 +1,192 @@
+#include "gzip_stream.h"
+#include <string.h>
+
+// ---------------- CRC32 (полубайтовая таблица — 64 байта вместо 1 KiB) ----------------
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t *p, size_t n) {
+    crc = ~crc;
+    while (n--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// ---------------- Таблицы deflate (RFC 1951 §3.2.5) ----------------
+static const uint16_t LEN_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t LEN_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t DIST_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t DIST_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// ---------------- Вывод ----------------
+void GzipStream::flushOut() {
+    if (m_outLen && m_sink) m_sink(m_out, m_outLen, m_ctx);
+    m_outTotal += m_outLen;
+    m_outLen = 0;
+}
+
+void GzipStream::putByte(uint8_t b) {
+    m_out[m_outLen++] = b;
+    if (m_outLen == OUT_SIZE) flushOut();
+}
+
+// deflate пишет биты от младшего к старшему
+void GzipStream::putBits(uint32_t bits, uint8_t n) {
+    m_bitBuf |= bits << m_bitCount;
+    m_bitCount += n;
+    while (m_bitCount >= 8) {
+        putByte((uint8_t)m_bitBuf);
+        m_bitBuf >>= 8;
+        m_bitCount -= 8;
+    }
+}
+
+// Коды Хаффмана — старшим битом вперёд
+void GzipStream::putHuff(uint16_t code, uint8_t len) {
+    uint16_t rev = 0;
+    for (uint8_t i = 0; i < len; ++i) {
+        rev = (rev << 1) | (code & 1);
+        code >>= 1;
+    }
+    putBits(rev, len);
+}
+
+// Фиксированный код literal/length
+static void litLenCode(uint16_t sym, uint16_t &code, uint8_t &len) {
+    if (sym < 144)      { code = 0x30 + sym;          len = 8; }
+    else if (sym < 256) { code = 0x190 + (sym - 144); len = 9; }
+    else if (sym < 280) { code = sym - 256;           len = 7; }
+    else                { code = 0xC0 + (sym - 280);  len = 8; }
+}
+
+void GzipStream::putLiteral(uint8_t c) {
+    uint16_t code; uint8_t len;
+    litLenCode(c, code, len);
+    putHuff(code, len);
+}
+
+void GzipStream::putMatch(uint16_t len, uint16_t dist) {
+    uint8_t li = 28;
+    while (LEN_BASE[li] > len) li--;
+    uint16_t code; uint8_t clen;
+    litLenCode(257 + li, code, clen);
+    putHuff(code, clen);
+    if (LEN_EXTRA[li]) putBits(len - LEN_BASE[li], LEN_EXTRA[li]);
+
+    uint8_t di = 29;
+    while (DIST_BASE[di] > dist) di--;
+    putHuff(di, 5);
+    if (DIST_EXTRA[di]) putBits(dist - DIST_BASE[di], DIST_EXTRA[di]);
+}
+
+// ---------------- LZ77 ----------------
+uint16_t GzipStream::hashAt(uint16_t pos) const {
+    uint32_t v = ((uint32_t)m_buf[pos] << 16) | ((uint32_t)m_buf[pos + 1] << 8) | m_buf[pos + 2];
+    return (uint16_t)((v * 2654435761u) >> 22) & (HASH_SIZE - 1);
+}
+
+// flush = false: сжимаем, пока впереди есть MAX_MATCH байт (совпадение не обрежется)
+void GzipStream::compress(bool flush) {
+    uint16_t limit = flush ? m_len : (m_len > MAX_MATCH ? m_len - MAX_MATCH : 0);
+    while (m_pos < limit) {
+        uint16_t bestLen = 0, bestDist = 0;
+        uint16_t avail = m_len - m_pos;
+        if (avail >= MIN_MATCH) {
+            uint16_t h = hashAt(m_pos);
+            uint16_t cand = m_head[h];
+            m_head[h] = m_pos + 1;
+            if (cand) {
+                cand--;
+                uint16_t maxLen = avail < MAX_MATCH ? avail : MAX_MATCH;
+                uint16_t n = 0;
+                while (n < maxLen && m_buf[cand + n] == m_buf[m_pos + n]) n++;
+                if (n >= MIN_MATCH) { bestLen = n; bestDist = m_pos - cand; }
+            }
+        }
+        if (bestLen) {
+            putMatch(bestLen, bestDist);
+            // Хэши внутри совпадения — дешёвый вариант: только начало следующих 2 позиций
+            for (uint16_t i = 1; i < bestLen && i < 3 && m_pos + i + 2 < m_len; ++i) {
+                m_head[hashAt(m_pos + i)] = m_pos + i + 1;
+            }
+            m_pos += bestLen;
+        } else {
+            putLiteral(m_buf[m_pos]);
+            m_pos++;
+        }
+    }
+}
+
+// ---------------- Публичное API ----------------
+void GzipStream::begin(Sink sink, void *ctx) {
+    m_sink = sink;
+    m_ctx  = ctx;
+    m_len = m_pos = 0;
+    memset(m_head, 0, sizeof(m_head));
+    m_outLen = 0;
+    m_bitBuf = 0;
+    m_bitCount = 0;
+    m_crc = 0;
+    m_isize = 0;
+    m_outTotal = 0;
+
+    // Заголовок gzip: magic, deflate, без флагов, mtime 0, XFL 0, OS 3 (Unix)
+    static const uint8_t HDR[10] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 3 };
+    for (uint8_t i = 0; i < sizeof(HDR); ++i) putByte(HDR[i]);
+    // Единственный блок: BFINAL=1, BTYPE=01 (фиксированный Хаффман)
+    putBits(1, 1);
+    putBits(1, 2);
+}
+
+void GzipStream::write(const uint8_t *data, size_t len) {
+    m_crc = crc32Update(m_crc, data, len);
+    m_isize += len;
+    while (len) {
+        if (m_len == BUF_SIZE) {
+            compress(false);
+            // Сдвиг окна: хэш-позиции старше WINDOW пропадают
+            memmove(m_buf, m_buf + WINDOW, BUF_SIZE - WINDOW);
+            m_len -= WINDOW;
+            m_pos -= WINDOW;
+            for (uint16_t i = 0; i < HASH_SIZE; ++i) {
+                m_head[i] = m_head[i] > WINDOW ? m_head[i] - WINDOW : 0;
+            }
+        }
+        size_t n = BUF_SIZE - m_len;
+        if (n > len) n = len;
+        memcpy(m_buf + m_len, data, n);
+        m_len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void GzipStream::write(const char *s) {
+    write((const uint8_t *)s, strlen(s));
+}
+
+void GzipStream::finish() {
+    compress(true);
+    putHuff(0, 7);                 // end of block (256)
+    if (m_bitCount) putBits(0, 8 - m_bitCount);
+    for (uint8_t i = 0; i < 4; ++i) putByte((uint8_t)(m_crc >> (8 * i)));
+    for (uint8_t i = 0; i < 4; ++i) putByte((uint8_t)(m_isize >> (8 * i)));
+    flushOut();
+}
@@ -0,0 +1,59 @@
+/**
+ * @file gzip_stream.h
+ * @brief Streaming gzip writer with fixed, small memory
+ *
+ * Single deflate block with the fixed Huffman code (RFC 1951 §3.2.6) and a
+ * greedy LZ77 match over a 4 KiB buffer with a one-probe hash — log text
+ * compresses 3–5×, and the encoder state is ~6.5 KiB regardless of input
+ * size. Compressed bytes leave through the sink in chunks of OUT_SIZE.
+ *
+ * No Arduino dependencies — usable from host tools.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+class GzipStream {
+public:
+    typedef void (*Sink)(const uint8_t *data, size_t len, void *ctx);
+
+    static const uint16_t WINDOW    = 2048;          // сдвиг буфера
+    static const uint16_t BUF_SIZE  = 2 * WINDOW;    // окно + lookahead
+    static const uint16_t HASH_SIZE = 1024;
+    static const uint16_t OUT_SIZE  = 512;
+    static const uint16_t MIN_MATCH = 3;
+    static const uint16_t MAX_MATCH = 258;
+
+    void begin(Sink sink, void *ctx);
+    void write(const uint8_t *data, size_t len);
+    void write(const char *s);
+    void finish();   // EOB + CRC32/ISIZE, сброс остатка в sink
+
+    uint32_t bytesIn() const  { return m_isize; }
+    uint32_t bytesOut() const { return m_outTotal; }
+
+private:
+    void compress(bool flush);
+    void putBits(uint32_t bits, uint8_t n);
+    void putHuff(uint16_t code, uint8_t len);
+    void putLiteral(uint8_t c);
+    void putMatch(uint16_t len, uint16_t dist);
+    void putByte(uint8_t b);
+    void flushOut();
+    uint16_t hashAt(uint16_t pos) const;
+
+    Sink     m_sink = nullptr;
+    void    *m_ctx  = nullptr;
+    uint8_t  m_buf[BUF_SIZE];
+    uint16_t m_len  = 0;     // байт в m_buf
+    uint16_t m_pos  = 0;     // следующий к сжатию
+    uint16_t m_head[HASH_SIZE];  // позиция + 1, 0 = пусто
+    uint8_t  m_out[OUT_SIZE];
+    uint16_t m_outLen = 0;
+    uint32_t m_bitBuf = 0;
+    uint8_t  m_bitCount = 0;
+    uint32_t m_crc = 0;
+    uint32_t m_isize = 0;
+    uint32_t m_outTotal = 0;
+};
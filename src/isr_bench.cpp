@@ -0,0 +1,198 @@
+#include "isr_bench.h"
+#include "dataout_decoder.h"
+#include "timer_wheel.h"
+#include "bt_webui.h"
+#include <WiFi.h>
+
+static const uint8_t  BURST_PULSES    = 48;
+static const uint16_t GAP_US          = 600;   // LOW между тестовыми импульсами
+static const uint32_t BURST_PERIOD_MS = 250;   // пачка ≈120ms + запас на разбор
+static const uint32_t TRAFFIC_MS      = 5;     // период генератора нагрузки
+static const uint16_t UDP_PAYLOAD     = 1024;
+static const uint16_t UDP_PORT        = 9;     // discard
+static const uint8_t  WS_EVERY        = 4;     // WS сообщение каждый 4-й тик (20ms)
+static const uint16_t WS_PAYLOAD      = 512;
+
+static int8_t     g_outPin = -1;
+static int8_t     g_inPin  = -1;
+static rmt_obj_t *g_rmt    = nullptr;
+static rmt_data_t g_items[BURST_PULSES];
+
+static IsrBenchResult g_res = {};
+static uint32_t g_burstsLeft  = 0;
+static bool     g_burstActive = false;
+static TimerId  g_burstTimer   = TIMER_NONE;
+static TimerId  g_trafficTimer = TIMER_NONE;
+static WiFiUDP  g_udp;
+static uint8_t  g_trafficTick = 0;
+
+// --- захват (ISR) ---
+static const uint8_t CAP_SIZE = BURST_PULSES + 4;  // лишние фронты тоже видны
+static volatile uint32_t g_cap[CAP_SIZE];
+static volatile uint8_t  g_capCount = 0;
+static volatile uint32_t g_riseUs   = 0;
+static volatile bool     g_haveRise = false;
+
+// Та же схема, что vw_dataout_isr(): micros() + digitalRead() на CHANGE
+static void IRAM_ATTR benchIsr() {
+    uint32_t now = micros();
+    bool level = digitalRead(g_inPin);
+    if (level) {
+        g_riseUs = now;
+        g_haveRise = true;
+        return;
+    }
+    if (!g_haveRise) return;
+    g_haveRise = false;
+    uint8_t n = g_capCount;
+    if (n < CAP_SIZE) {
+        g_cap[n] = now - g_riseUs;
+        g_capCount = n + 1;
+    }
+}
+
+// Класс импульса по порогам VW декодера
+static uint8_t vwClass(uint32_t us) {
+    if (us < VwDataOutDecoder::LOW_THRESHOLD)   return PC_NOISE;
+    if (us < VwDataOutDecoder::HIGH_THRESHOLD)  return PC_ZERO;
+    if (us < VwDataOutDecoder::START_THRESHOLD) return PC_ONE;
+    return PC_START;
+}
+
+static void evaluateBurst() {
+    uint8_t n = g_capCount;
+    if (n != BURST_PULSES) {
+        g_res.burstsLost++;
+        return;
+    }
+    for (uint8_t i = 0; i < BURST_PULSES; ++i) {
+        uint8_t  w        = i % BENCH_WIDTH_COUNT;
+        uint32_t expected = BENCH_WIDTHS_US[w];
+        uint32_t got      = g_cap[i];
+        int32_t  err      = (int32_t)got - (int32_t)expected;
+        uint32_t absErr   = err < 0 ? (uint32_t)-err : (uint32_t)err;
+
+        uint8_t bin = 0;
+        while (bin < BENCH_BINS - 1 && absErr >= BENCH_BIN_LIMITS_US[bin]) bin++;
+        g_res.hist[bin]++;
+
+        BenchWidthStats &ws = g_res.width[w];
+        if (ws.count == 0 || err < ws.minErrUs) ws.minErrUs = err;
+        if (ws.count == 0 || err > ws.maxErrUs) ws.maxErrUs = err;
+        ws.sumErrUs += err;
+        ws.count++;
+
+        if (vwClass(got) != vwClass(expected)) g_res.decisionFlips++;
+        g_res.pulses++;
+    }
+}
+
+static void onBurstTimer() {
+    if (g_burstActive) {
+        evaluateBurst();
+        g_burstActive = false;
+    }
+    if (g_burstsLeft == 0) {
+        isr_bench_stop();
+        return;
+    }
+    g_burstsLeft--;
+    g_capCount = 0;
+    g_haveRise = false;
+    if (!rmtWrite(g_rmt, g_items, BURST_PULSES)) {
+        btWebUI_log("[BENCH] RMT write failed", LogLevel::INFO);
+        isr_bench_stop();
+        return;
+    }
+    g_burstActive = true;
+    g_res.bursts++;
+}
+
+// Нагрузка: UDP broadcast (радио занято даже без клиентов) + WS всем клиентам
+static void onTrafficTimer() {
+    static uint8_t udpBuf[UDP_PAYLOAD];
+    if (g_udp.beginPacket(IPAddress(255, 255, 255, 255), UDP_PORT)) {
+        g_udp.write(udpBuf, sizeof(udpBuf));
+        if (g_udp.endPacket()) g_res.udpPackets++;
+    }
+    if (++g_trafficTick >= WS_EVERY) {
+        g_trafficTick = 0;
+        static char wsBuf[WS_PAYLOAD + 1];
+        if (!wsBuf[0]) {
+            memcpy(wsBuf, "[BENCH] ", 8);
+            memset(wsBuf + 8, '.', WS_PAYLOAD - 8);
+            wsBuf[WS_PAYLOAD] = 0;
+        }
+        btWebUI_broadcastBench(wsBuf);
+        g_res.wsMessages++;
+    }
+}
+
+void isr_bench_init(int8_t outPin, int8_t inPin) {
+    if (outPin < 0 || inPin < 0) return;
+
+    g_rmt = rmtInit(outPin, true, RMT_MEM_64);
+    if (!g_rmt) {
+        btWebUI_log("[BENCH] RMT init failed on GPIO" + String(outPin), LogLevel::INFO);
+        return;
+    }
+    rmtSetTick(g_rmt, 1000);  // 1 tick = 1µs
+    for (uint8_t i = 0; i < BURST_PULSES; ++i) {
+        g_items[i].level0    = 1;
+        g_items[i].duration0 = BENCH_WIDTHS_US[i % BENCH_WIDTH_COUNT];
+        g_items[i].level1    = 0;
+        g_items[i].duration1 = GAP_US;
+    }
+    pinMode(inPin, INPUT_PULLDOWN);
+    g_outPin = outPin;
+    g_inPin  = inPin;
+    btWebUI_log("[BENCH] ISR latency bench ready: GPIO" + String(outPin) + " -> GPIO" + String(inPin), LogLevel::INFO);
+}
+
+bool isr_bench_available() { return g_rmt != nullptr; }
+
+bool isr_bench_start(uint16_t seconds, bool traffic) {
+    if (!g_rmt || g_res.running || seconds == 0) return false;
+
+    g_res = IsrBenchResult();
+    g_res.running = true;
+    g_res.traffic = traffic;
+    g_burstsLeft  = (uint32_t)seconds * 1000 / BURST_PERIOD_MS;
+    g_burstActive = false;
+
+    attachInterrupt(digitalPinToInterrupt(g_inPin), benchIsr, CHANGE);
+    timer_restart(g_burstTimer, onBurstTimer, BURST_PERIOD_MS, BURST_PERIOD_MS);
+    if (traffic) {
+        g_udp.begin(UDP_PORT);
+        g_trafficTick = 0;
+        timer_restart(g_trafficTimer, onTrafficTimer, TRAFFIC_MS, TRAFFIC_MS);
+    }
+    btWebUI_log("[BENCH] start " + String(seconds) + "s, traffic " + (traffic ? "ON" : "OFF"), LogLevel::INFO);
+    return true;
+}
+
+void isr_bench_stop() {
+    if (!g_res.running) return;
+    timer_cancel(g_burstTimer);
+    timer_cancel(g_trafficTimer);
+    detachInterrupt(digitalPinToInterrupt(g_inPin));
+    g_res.running = false;
+    g_burstActive = false;
+    btWebUI_log("[BENCH] done: pulses=" + String(g_res.pulses) +
+                " lostBursts=" + String(g_res.burstsLost) +
+                " flips=" + String(g_res.decisionFlips), LogLevel::INFO);
+}
+
+const IsrBenchResult &isr_bench_getResult() { return g_res; }
+
+uint8_t isr_bench_p99Bin() {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < BENCH_BINS; ++i) total += g_res.hist[i];
+    if (total == 0) return 0;
+    uint32_t acc = 0;
+    for (uint8_t i = 0; i < BENCH_BINS; ++i) {
+        acc += g_res.hist[i];
+        if ((uint64_t)acc * 100 >= (uint64_t)total * 99) return i;
+    }
+    return BENCH_BINS - 1;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file isr_bench.h
+ * @brief On-target interrupt-latency benchmark for DataOut-style capture
+ *
+ * RMT drives a spare GPIO with pulses of known width; a jumper loops it to
+ * a spare input whose ISR timestamps edges exactly like vw_dataout_isr()
+ * (micros() on CHANGE). The difference between captured and programmed
+ * width is the edge-to-edge ISR entry jitter at that moment.
+ *
+ * While the benchmark runs, an optional traffic generator keeps WiFi and
+ * WebSocket busy (UDP broadcast + WS broadcast). Results: error histogram,
+ * min/max/mean per programmed width, and the number of pulses that would
+ * have landed on the wrong side of a VW decoder threshold — if that is not
+ * zero, this board needs hardware capture (RMT RX / PCNT) for DataOut.
+ *
+ * RMT idles LOW, so test pulses are HIGH; the timing path is the same.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+// Ширины тестовых импульсов (µs): бит 0, бит 1, старт, и у порога 1248
+static const uint8_t  BENCH_WIDTH_COUNT = 5;
+static const uint16_t BENCH_WIDTHS_US[BENCH_WIDTH_COUNT] = { 650, 1770, 4570, 1150, 1350 };
+
+// Гистограмма |ошибки|: верхние границы бинов, последний — всё остальное
+static const uint8_t  BENCH_BINS = 9;
+static const uint16_t BENCH_BIN_LIMITS_US[BENCH_BINS - 1] = { 1, 2, 5, 10, 20, 50, 100, 200 };
+
+struct BenchWidthStats {
+    uint32_t count;
+    int32_t  minErrUs;
+    int32_t  maxErrUs;
+    int64_t  sumErrUs;
+};
+
+struct IsrBenchResult {
+    bool     running;
+    bool     traffic;           // генератор нагрузки был включён
+    uint32_t bursts;            // пачек отправлено
+    uint32_t burstsLost;        // пачек с неверным числом импульсов (слипшиеся/потерянные фронты)
+    uint32_t pulses;            // импульсов сопоставлено
+    uint32_t decisionFlips;     // импульс попал бы в другой класс VW декодера
+    uint32_t hist[BENCH_BINS];
+    BenchWidthStats width[BENCH_WIDTH_COUNT];
+    uint32_t udpPackets;        // отправлено генератором
+    uint32_t wsMessages;
+};
+
+// outPin/inPin < 0 — бенчмарк недоступен (нет перемычки)
+void isr_bench_init(int8_t outPin, int8_t inPin);
+bool isr_bench_available();
+
+// Запустить на seconds секунд; traffic — включить генератор WiFi/WS нагрузки
+bool isr_bench_start(uint16_t seconds, bool traffic);
+void isr_bench_stop();
+
+const IsrBenchResult &isr_bench_getResult();
+
+// Бин (0..BENCH_BINS-1), в котором набирается 99% импульсов
+uint8_t isr_bench_p99Bin();
@@ -0,0 +1,140 @@
+#include "loop_sched.h"
+#include "bt_webui.h"
+
+static SchedStep g_steps[SCHED_MAX_STEPS];
+static uint8_t   g_stepCount = 0;
+static uint32_t  g_passes    = 0;
+
+// Запас сверх бюджета BEST_EFFORT шага перед HARD-дедлайном
+static const uint32_t GUARD_US = 500;
+
+// wraparound-safe: a наступило (или прошло) относительно b
+static inline bool timeReached(uint32_t now, uint32_t due) {
+    return (int32_t)(now - due) >= 0;
+}
+
+bool sched_addStep(const char* name, StepFn fn, StepClass cls,
+                   uint32_t periodMs, uint32_t deadlineUs, uint32_t budgetUs) {
+    if (g_stepCount >= SCHED_MAX_STEPS || !fn) {
+        btWebUI_log(String("[SCHED] cannot add step: ") + name, LogLevel::INFO);
+        return false;
+    }
+    SchedStep &s = g_steps[g_stepCount++];
+    s = SchedStep();
+    s.name       = name;
+    s.fn         = fn;
+    s.cls        = cls;
+    s.periodUs   = periodMs * 1000;
+    s.deadlineUs = deadlineUs;
+    s.budgetUs   = budgetUs;
+    s.nextDueUs  = micros() + s.periodUs;
+    return true;
+}
+
+static void runStep(SchedStep &s, uint32_t now) {
+    s.fn();
+    uint32_t dt = micros() - now;
+    s.runs++;
+    s.totalRunUs += dt;
+    if (dt > s.maxRunUs) s.maxRunUs = dt;
+    if (s.budgetUs && dt > s.budgetUs) s.overruns++;
+}
+
+uint32_t sched_usUntilHard() {
+    uint32_t now = micros();
+    uint32_t best = UINT32_MAX;
+    for (uint8_t i = 0; i < g_stepCount; ++i) {
+        const SchedStep &s = g_steps[i];
+        if (s.cls != StepClass::HARD) continue;
+        if (timeReached(now, s.nextDueUs)) return 0;
+        uint32_t left = s.nextDueUs - now;
+        if (left < best) best = left;
+    }
+    return best;
+}
+
+bool sched_expedite(StepFn fn, uint32_t minSpacingUs) {
+    for (uint8_t i = 0; i < g_stepCount; ++i) {
+        SchedStep &s = g_steps[i];
+        if (s.cls != StepClass::HARD || s.fn != fn) continue;
+        uint32_t now = micros();
+        uint32_t due = now;
+        if (!timeReached(now, s.lastStartUs + minSpacingUs)) {
+            due = s.lastStartUs + minSpacingUs;
+        }
+        // Плановый кадр и так раньше — ничего не меняем
+        if (!timeReached(due, s.nextDueUs)) {
+            s.nextDueUs = due;
+            s.expedited++;
+        }
+        return true;
+    }
+    return false;
+}
+
+void sched_loop() {
+    g_passes++;
+
+    // 1. HARD — по расписанию
+    for (uint8_t i = 0; i < g_stepCount; ++i) {
+        SchedStep &s = g_steps[i];
+        if (s.cls != StepClass::HARD) continue;
+        uint32_t now = micros();
+        if (!timeReached(now, s.nextDueUs)) continue;
+
+        uint32_t late = now - s.nextDueUs;
+        if (late > s.maxLateUs) s.maxLateUs = late;
+        if (late > s.deadlineUs) s.misses++;
+
+        s.lastStartUs = now;
+        runStep(s, now);
+
+        // Держим сетку периода; если отстали больше чем на период — перестраиваемся
+        s.nextDueUs += s.periodUs;
+        if (timeReached(micros(), s.nextDueUs + s.periodUs)) {
+            s.nextDueUs = micros() + s.periodUs;
+        }
+    }
+
+    // 2. ASAP — каждый проход
+    for (uint8_t i = 0; i < g_stepCount; ++i) {
+        SchedStep &s = g_steps[i];
+        if (s.cls != StepClass::ASAP) continue;
+        uint32_t now = micros();
+        if (s.periodUs && !timeReached(now, s.nextDueUs)) continue;
+        runStep(s, now);
+        if (s.periodUs) s.nextDueUs = now + s.periodUs;
+    }
+
+    // 3. BEST_EFFORT — только если успеваем до следующего HARD кадра
+    for (uint8_t i = 0; i < g_stepCount; ++i) {
+        SchedStep &s = g_steps[i];
+        if (s.cls != StepClass::BEST_EFFORT) continue;
+        uint32_t now = micros();
+        if (s.periodUs && !timeReached(now, s.nextDueUs)) continue;
+        if (sched_usUntilHard() < s.budgetUs + GUARD_US) {
+            s.deferred++;
+            continue;
+        }
+        runStep(s, now);
+        if (s.periodUs) s.nextDueUs = now + s.periodUs;
+    }
+}
+
+uint8_t sched_getStepCount() { return g_stepCount; }
+
+const SchedStep *sched_getStep(uint8_t idx) {
+    return idx < g_stepCount ? &g_steps[idx] : nullptr;
+}
+
+uint32_t sched_getPasses() { return g_passes; }
+
+void sched_resetStats() {
+    for (uint8_t i = 0; i < g_stepCount; ++i) {
+        SchedStep &s = g_steps[i];
+        s.runs = s.overruns = s.misses = s.deferred = s.expedited = 0;
+        s.maxRunUs = s.maxLateUs = 0;
+        s.totalRunUs = 0;
+    }
+    g_passes = 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file loop_sched.h
+ * @brief Cooperative deadline-aware scheduler for loop()
+ *
+ * Subsystems register step functions instead of being called back-to-back
+ * from loop(). Each pass of sched_loop():
+ *   1. runs HARD steps that are due (CDC frame every 50 ms);
+ *   2. runs ASAP steps (BT UART RX, main state logic);
+ *   3. runs BEST_EFFORT steps (web server) only if the next HARD deadline
+ *      is further away than the step's time budget.
+ *
+ * Per-step run time, budget overruns, deadline misses and deferrals are
+ * recorded and exposed on /api/sched.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+enum class StepClass : uint8_t {
+    HARD,         // строгий период, опоздание > deadline = промах
+    ASAP,         // каждый проход loop()
+    BEST_EFFORT   // только если до следующего HARD-дедлайна хватает бюджета
+};
+
+typedef void (*StepFn)();
+
+struct SchedStep {
+    const char* name;
+    StepFn      fn;
+    StepClass   cls;
+    uint32_t    periodUs;    // 0 = каждый проход
+    uint32_t    deadlineUs;  // допустимое опоздание (HARD)
+    uint32_t    budgetUs;    // ожидаемое максимальное время выполнения
+
+    // --- статистика ---
+    uint32_t    nextDueUs;
+    uint32_t    runs;
+    uint32_t    overruns;    // выполнение дольше budgetUs
+    uint32_t    misses;      // HARD: опоздание дольше deadlineUs
+    uint32_t    deferred;    // BEST_EFFORT: отложено ради HARD-дедлайна
+    uint32_t    expedited;   // HARD: внеочередных запусков (sched_expedite)
+    uint32_t    lastStartUs;
+    uint32_t    maxRunUs;
+    uint32_t    maxLateUs;
+    uint64_t    totalRunUs;
+};
+
+static const uint8_t SCHED_MAX_STEPS = 8;
+
+// Регистрация шага (вызывать в setup()). periodMs = 0 → каждый проход.
+bool sched_addStep(const char* name, StepFn fn, StepClass cls,
+                   uint32_t periodMs, uint32_t deadlineUs, uint32_t budgetUs);
+
+// Один проход планировщика (вызывать из loop())
+void sched_loop();
+
+// Сколько µs до ближайшего HARD-дедлайна (0 = уже пора)
+uint32_t sched_usUntilHard();
+
+// Запустить HARD шаг fn вне сетки — в ближайшем проходе, но не раньше
+// minSpacingUs после его прошлого запуска. Сетка периода дальше
+// отсчитывается от этого запуска. false — fn не HARD шаг.
+bool sched_expedite(StepFn fn, uint32_t minSpacingUs);
+
+// Статистика
+uint8_t          sched_getStepCount();
+const SchedStep *sched_getStep(uint8_t idx);
+uint32_t         sched_getPasses();
+void             sched_resetStats();
@@ -7,7 +7,7 @@
  * into Bluetooth A2DP/AVRCP/HFP controls.
  * 
  * Button Mapping:
- *   CD1 = Play/Pause toggle
+ *   CD1 = Play/Pause toggle (flips the module-reported state)
  *   CD2 = Stop
  *   CD3 = HFP Mic Mute toggle
  *   CD4 = Enter Pairing Mode (TRACK 80)
@@ -28,6 +28,16 @@
 #include "vw_cdc.h"
 #include "bt1036_at.h"
 #include "bt_webui.h"
+#include "loop_sched.h"
+#include "timer_wheel.h"
+#include "mem_governor.h"
+#include "cpu_load.h"
+#include "isr_bench.h"
+#include "track_sync.h"
+#include "play_state.h"
+#include "scenario.h"
+#include "bt_scenarios.h"
+#include "session_log.h"
 
 // ============================================================================
 // PIN CONFIGURATION (ESP-WROVER-KIT / ESP32)
@@ -36,22 +46,28 @@ static const uint8_t BT_RX_PIN = 16;  // ESP RX ← BT1036 TX (Serial2)
 static const uint8_t BT_TX_PIN = 17;  // ESP TX → BT1036 RX (Serial2)
 
 static const uint8_t CDC_SCK_PIN  = 18;  // VSPI CLK → VW Radio
-static const uint8_t CDC_MISO_PIN = -1;  // Not used (radio doesn't send SPI data back)
+// Radio doesn't send SPI data back. Optional TX self-check: wire MOSI to a
+// spare input (e.g. GPIO19) and set it here — every frame is read back.
+static const int8_t  CDC_MISO_PIN = -1;
 static const uint8_t CDC_MOSI_PIN = 23;  // VSPI MOSI → VW Radio
 static const int8_t  CDC_SS_PIN   = -1;  // Not used (single device)
 static const uint8_t CDC_NEC_PIN  =  4;  // VW DataOut ← Radio (button commands)
 
+// ISR latency bench (/api/bench/isr): jumper BENCH_OUT → BENCH_IN, e.g. 25 → 26.
+// -1 = not wired.
+static const int8_t  BENCH_OUT_PIN = -1;
+static const int8_t  BENCH_IN_PIN  = -1;
+
 // ============================================================================
 // GLOBAL STATE
 // ============================================================================
 static uint8_t g_currentDisc  = 1;   // Current CD number (always 1)
 static uint8_t g_currentTrack = 1;   // Current track number (1-99, or 80/10 for status)
 static bool g_hfpMuted = false;      // HFP microphone mute state
-static bool g_isPlaying = false;     // Playback state for toggle logic
 
 // Timers for SCAN/MIX indicator pulse (500ms on, then off)
-static uint32_t g_scanResetTime = 0;
-static uint32_t g_mixResetTime = 0;
+static TimerId g_scanPulse = TIMER_NONE;
+static TimerId g_mixPulse = TIMER_NONE;
 
 // ============================================================================
 // DISPLAY MODE STATE MACHINE
@@ -67,15 +83,49 @@ enum class DisplayMode {
 };
 
 static DisplayMode g_displayMode = DisplayMode::WAITING_FOR_BT;
-static uint32_t g_connectedShowTime = 0;             // Timestamp when TRACK 10 was shown
+static TimerId g_connectedTimer = TIMER_NONE;        // TRACK 10 → TRACK 1 after 5 sec
 static BTConnState g_lastBtState = BTConnState::DISCONNECTED;
-static bool g_autoPlaySent = false;                  // Auto-play command already sent
 static bool g_isPairingMode = false;                 // true = waiting for NEW device (CD4/CD6)
+static uint32_t g_shownStatSeq = 0;                  // last TRACKSTAT put on the display
 
 // ============================================================================
 // HELPER FUNCTIONS
 // ============================================================================
 
+// End of SCAN indicator pulse
+static void onScanPulseEnd() {
+    g_scanPulse = TIMER_NONE;
+    cdc_setScan(false);
+}
+
+// End of MIX indicator pulse
+static void onMixPulseEnd() {
+    g_mixPulse = TIMER_NONE;
+    cdc_setRandom(false);
+    cdc_resetModeFF();
+}
+
+// Transition: JUST_CONNECTED -> NORMAL_PLAYBACK after 5 seconds
+static void onConnectedShown() {
+    g_connectedTimer = TIMER_NONE;
+    if (g_displayMode != DisplayMode::JUST_CONNECTED) return;
+
+    g_displayMode = DisplayMode::NORMAL_PLAYBACK;
+    g_currentTrack = 1;
+    g_isPairingMode = false;  // Reset pairing mode flag
+    cdc_setDiscTrack(g_currentDisc, g_currentTrack);
+    // AT+PLAY уходит из сценария connect_play в тот же момент
+    cdc_setPlayState(CdcPlayState::PLAYING);
+    btWebUI_log("[MAIN] Switching to normal playback mode (TRACK 1)", LogLevel::INFO);
+}
+
+// NEXT/PREV not confirmed by the phone (see track_sync.h)
+static void onTrackRollback(uint8_t track) {
+    if (g_displayMode != DisplayMode::NORMAL_PLAYBACK) return;
+    g_currentTrack = track;
+    cdc_setDiscTrack(g_currentDisc, g_currentTrack);
+}
+
 /** Increment track number (1-99 wrap) */
 static void bumpTrackForward() {
     g_currentTrack = (g_currentTrack < 99) ? g_currentTrack + 1 : 1;
@@ -123,50 +173,52 @@ static const char* getButtonName(CdcButton btn) {
 static void onCdcButton(CdcButton btn) {
     const char* btnName = getButtonName(btn);
     String logMsg;  // Для WebUI
+    sess_noteButton();
 
     switch (btn) {
 
         // ---- Треки ----
-        case CdcButton::NEXT_TRACK:
+        case CdcButton::NEXT_TRACK: {
             // Переключаем на нормальный режим если ещё не там
             if (g_displayMode != DisplayMode::NORMAL_PLAYBACK) {
                 g_displayMode = DisplayMode::NORMAL_PLAYBACK;
                 g_currentTrack = 1;
             }
+            uint8_t confirmedTrack = g_currentTrack;
             bumpTrackForward();
-            cdc_setDiscTrack(g_currentDisc, g_currentTrack);
+            cdc_setDiscTrack(g_currentDisc, g_currentTrack);  // оптимистично, ждём TRACKINFO
             bt1036_nextTrack();
+            tsync_begin(confirmedTrack, bt1036_getTrackInfo());
             logMsg = String("[BTN] ") + btnName + " → BT: Next, Track " + String(g_currentTrack);
             break;
+        }
 
-        case CdcButton::PREV_TRACK:
+        case CdcButton::PREV_TRACK: {
             // Переключаем на нормальный режим если ещё не там
+            uint8_t confirmedTrack = g_currentTrack;
             if (g_displayMode != DisplayMode::NORMAL_PLAYBACK) {
                 g_displayMode = DisplayMode::NORMAL_PLAYBACK;
                 g_currentTrack = 2;  // Чтобы после bumpBackward было 1
+                confirmedTrack = 1;
             }
             bumpTrackBackward();
-            cdc_setDiscTrack(g_currentDisc, g_currentTrack);
+            cdc_setDiscTrack(g_currentDisc, g_currentTrack);  // оптимистично, ждём TRACKINFO
             bt1036_prevTrack();
+            tsync_begin(confirmedTrack, bt1036_getTrackInfo());
             logMsg = String("[BTN] ") + btnName + " → BT: Prev, Track " + String(g_currentTrack);
             break;
+        }
 
         // ---- Стандартные кнопки (если магнитола их отправит) ----
-        case CdcButton::PLAY_PAUSE:
-            g_isPlaying = !g_isPlaying;
-            if (g_isPlaying) {
-                bt1036_play();
-                cdc_setPlayState(CdcPlayState::PLAYING);
-            } else {
-                bt1036_pause();
-                cdc_setPlayState(CdcPlayState::PAUSED);
-            }
-            logMsg = String("[BTN] ") + btnName + " → BT: " + (g_isPlaying ? "Play" : "Pause");
+        case CdcButton::PLAY_PAUSE: {
+            bool play = pstate_toggle() == PlayState::PLAYING;
+            cdc_setPlayState(play ? CdcPlayState::PLAYING : CdcPlayState::PAUSED);
+            logMsg = String("[BTN] ") + btnName + " → BT: " + (play ? "Play" : "Pause");
             break;
+        }
 
         case CdcButton::STOP:
-            g_isPlaying = false;
-            bt1036_stop();
+            pstate_request(PlayState::STOPPED);
             cdc_setPlayState(CdcPlayState::STOPPED);
             logMsg = String("[BTN] ") + btnName + " → BT: Stop";
             break;
@@ -180,23 +232,17 @@ static void onCdcButton(CdcButton btn) {
         // ---- КНОПКИ CD1..CD3 ПЕРЕНАЗНАЧЕНИЕ ----
 
         case CdcButton::DISC_1: {
-            // CD1 = Play/Pause toggle (локальный флаг, как CD3)
-            g_isPlaying = !g_isPlaying;
-            if (g_isPlaying) {
-                bt1036_play();
-                cdc_setPlayState(CdcPlayState::PLAYING);
-                logMsg = String("[BTN] ") + btnName + " → BT: Play";
-            } else {
-                bt1036_pause();
-                cdc_setPlayState(CdcPlayState::PAUSED);
-                logMsg = String("[BTN] ") + btnName + " → BT: Pause";
-            }
+            // CD1 = Play/Pause toggle от истинного состояния (play_state: отчёты модуля + наши команды)
+            bool play = pstate_toggle() == PlayState::PLAYING;
+            cdc_setPlayState(play ? CdcPlayState::PLAYING : CdcPlayState::PAUSED);
+            logMsg = String("[BTN] ") + btnName + " → BT: " + (play ? "Play" : "Pause") +
+                     " #" + String(pstate_seq());
             break;
         }
 
         case CdcButton::DISC_2:
             // CD2 = Stop
-            bt1036_stop();
+            pstate_request(PlayState::STOPPED);
             cdc_setPlayState(CdcPlayState::STOPPED);
             logMsg = String("[BTN] ") + btnName + " → BT: Stop";
             break;
@@ -209,10 +255,11 @@ static void onCdcButton(CdcButton btn) {
 
         // ---- CD4 = Режим сопряжения ----
         case CdcButton::DISC_4:
-            bt1036_enterPairingMode();
+            scen_pairing();
             g_displayMode = DisplayMode::WAITING_FOR_BT;
             g_isPairingMode = true;  // Ждём новое устройство
             g_currentTrack = 80;  // Показываем TRACK 80
+            tsync_cancel();
             cdc_setDiscTrack(g_currentDisc, g_currentTrack);
             logMsg = String("[BTN] ") + btnName + " → BT: Pairing Mode (TRACK 80)";
             break;
@@ -223,6 +270,7 @@ static void onCdcButton(CdcButton btn) {
             bt1036_hfpDisconnect();
             g_displayMode = DisplayMode::WAITING_FOR_BT;
             g_currentTrack = 80;  // Показываем TRACK 80
+            tsync_cancel();
             cdc_setDiscTrack(g_currentDisc, g_currentTrack);
             logMsg = String("[BTN] ") + btnName + " → BT: Disconnect";
             break;
@@ -233,6 +281,7 @@ static void onCdcButton(CdcButton btn) {
             g_displayMode = DisplayMode::WAITING_FOR_BT;
             g_isPairingMode = true;  // Ждём новое устройство
             g_currentTrack = 80;  // Показываем TRACK 80
+            tsync_cancel();
             cdc_setDiscTrack(g_currentDisc, g_currentTrack);
             logMsg = String("[BTN] ") + btnName + " → BT: Clear Paired Devices";
             break;
@@ -242,7 +291,7 @@ static void onCdcButton(CdcButton btn) {
             bt1036_hangupCall();
             // Пульс: 0xD0 → через 500мс сброс в 0x00
             cdc_setScan(true);
-            g_scanResetTime = millis() + 500;
+            timer_restart(g_scanPulse, onScanPulseEnd, 500);
             logMsg = String("[BTN] ") + btnName + " → HFP: Hangup";
             break;
 
@@ -251,7 +300,7 @@ static void onCdcButton(CdcButton btn) {
             bt1036_answerCall();
             // Пульс: 0x04 → через 500мс сброс в 0xFF
             cdc_setRandom(true);
-            g_mixResetTime = millis() + 500;
+            timer_restart(g_mixPulse, onMixPulseEnd, 500);
             logMsg = String("[BTN] ") + btnName + " → HFP: Answer Call";
             break;
 
@@ -265,12 +314,15 @@ static void onCdcButton(CdcButton btn) {
     btWebUI_log(logMsg, LogLevel::INFO);
 }
 
+static void appLoop();
+
 // ============================================================================
 // SETUP
 // ============================================================================
 void setup() {
     Serial.begin(115200);
     delay(200);
+    timer_init();  // до init подсистем — они заводят свои таймеры
     
     // Логируем причину последней перезагрузки
     esp_reset_reason_t reason = esp_reset_reason();
@@ -309,30 +361,51 @@ void setup() {
     // Web UI
     btWebUI_init();
 
+    // Сброс отладочных функций при нехватке heap
+    mem_init();
+
+    // Кооперативный планировщик: кадр CDC — жёсткий дедлайн, остальное вокруг него.
+    // Бюджет кадра: 8 байт × (128µs SPI + 874µs пауза) ≈ 8ms.
+    sched_addStep("cdc_frame", cdc_sendFrame, StepClass::HARD, cdc_getFramePeriodMs(), 5000, 9000);
+    sched_addStep("bt",        bt1036_loop,   StepClass::ASAP, 0, 0, 2000);
+    sched_addStep("cdc_rx",    cdc_poll,      StepClass::ASAP, 0, 0, 2000);
+    sched_addStep("timers",    timer_poll,    StepClass::ASAP, 0, 0, 1000);
+    sched_addStep("main",      appLoop,       StepClass::ASAP, 0, 0, 1000);
+    sched_addStep("scenario",  sc_poll,       StepClass::ASAP, 0, 0, 1000);
+    sched_addStep("web",       btWebUI_loop,  StepClass::BEST_EFFORT, 0, 0, 20000);
+
+    // Загрузка ядер (idle hooks) + разбивка по шагам loop() и DataOut ISR
+    cpu_init();
+
+    isr_bench_init(BENCH_OUT_PIN, BENCH_IN_PIN);
+
+    // Play/pause toggles follow the module's reported state (phone-side pause)
+    pstate_init();
+    scen_init();
+
+    // Сводка поездки в NVS (после sched/mem — снимает их счётчики)
+    sess_init((uint8_t)reason);
+
+    // NEXT/PREV: optimistic track number, rolled back if the phone doesn't confirm
+    tsync_setRollbackCallback(onTrackRollback);
+
+    btWebUI_setBootMs(millis());
+
     btWebUI_log("[MAIN] Init complete.", LogLevel::INFO);
 }
 
 // ============================================================================
 // MAIN LOOP
+// Subsystems run as scheduler steps (see setup()); appLoop() is the
+// application state logic step.
 // ============================================================================
 void loop() {
-    // Process all subsystems
-    bt1036_loop();
-    cdc_loop();
-    btWebUI_loop();
-    
-    // Reset SCAN indicator after 500ms pulse
-    if (g_scanResetTime > 0 && millis() > g_scanResetTime) {
-        g_scanResetTime = 0;
-        cdc_setScan(false);
-    }
-    
-    // Reset MIX indicator after 500ms pulse
-    if (g_mixResetTime > 0 && millis() > g_mixResetTime) {
-        g_mixResetTime = 0;
-        cdc_setRandom(false);
-        cdc_resetModeFF();
-    }
+    sched_loop();
+}
+
+static void appLoop() {
+    // SCAN/MIX indicator pulses and the TRACK 10 window are timers
+    // (onScanPulseEnd / onMixPulseEnd / onConnectedShown)
     
     // ========== BT CONNECTION STATUS HANDLING ==========
     BTConnState currentBtState = bt1036_getState();
@@ -346,22 +419,19 @@ void loop() {
         if (g_isPairingMode) {
             // NEW device connected (after CD4/CD6) - show TRACK 10 for 5 sec
             g_displayMode = DisplayMode::JUST_CONNECTED;
-            g_connectedShowTime = millis();
+            timer_restart(g_connectedTimer, onConnectedShown, 5000);
             g_currentTrack = 10;
+            tsync_cancel();
             cdc_setDiscTrack(g_currentDisc, g_currentTrack);
-            g_autoPlaySent = false;
+            scen_connectPlay(5000);
             btWebUI_log("[MAIN] New device connected! Showing TRACK 10 for 5 sec", LogLevel::INFO);
         } else {
             // AUTO-RECONNECT to known device - instant play
             g_displayMode = DisplayMode::NORMAL_PLAYBACK;
             g_currentTrack = 1;
-            g_isPlaying = true;
             cdc_setDiscTrack(g_currentDisc, g_currentTrack);
             cdc_setPlayState(CdcPlayState::PLAYING);
-            
-            if (!g_autoPlaySent) {
-                g_autoPlaySent = true;
-                bt1036_play();
+            if (scen_connectPlay(0)) {
                 btWebUI_log("[MAIN] Auto-reconnect! Instant play sent", LogLevel::INFO);
             }
         }
@@ -372,37 +442,27 @@ void loop() {
         g_lastBtState != BTConnState::DISCONNECTED) {
         g_displayMode = DisplayMode::WAITING_FOR_BT;
         g_currentTrack = 80;
+        tsync_cancel();
         cdc_setDiscTrack(g_currentDisc, g_currentTrack);
-        g_autoPlaySent = false;
+        scen_cancelConnectPlay();
+        timer_cancel(g_connectedTimer);
         btWebUI_log("[MAIN] BT Disconnected. Showing TRACK 80", LogLevel::INFO);
     }
     
+    if (currentBtState != g_lastBtState) sess_onBtState(currentBtState);
     g_lastBtState = currentBtState;
     
-    // Transition: JUST_CONNECTED -> NORMAL_PLAYBACK after 5 seconds
-    if (g_displayMode == DisplayMode::JUST_CONNECTED) {
-        if (millis() - g_connectedShowTime > 5000) {
-            g_displayMode = DisplayMode::NORMAL_PLAYBACK;
-            g_currentTrack = 1;
-            g_isPlaying = true;
-            g_isPairingMode = false;  // Reset pairing mode flag
-            cdc_setDiscTrack(g_currentDisc, g_currentTrack);
-            btWebUI_log("[MAIN] Switching to normal playback mode (TRACK 1)", LogLevel::INFO);
-            
-            // Send auto-play command
-            if (!g_autoPlaySent) {
-                g_autoPlaySent = true;
-                bt1036_play();
-                cdc_setPlayState(CdcPlayState::PLAYING);
-                btWebUI_log("[MAIN] Auto-play sent", LogLevel::INFO);
-            }
-        }
-    }
-    
-    // In normal playback mode, update time from BT module
+    // In normal playback mode, update time from BT module (each new TRACKSTAT).
+    // While a NEXT/PREV is unconfirmed the display holds 00:00; the TRACKSTAT
+    // that was current at confirmation still belongs to the old track.
     if (g_displayMode == DisplayMode::NORMAL_PLAYBACK) {
         TrackInfo ti = bt1036_getTrackInfo();
-        if (ti.valid && ti.elapsedSec > 0) {
+        bool held = tsync_holdTime();
+        tsync_poll(ti);
+        if (held) {
+            if (!tsync_holdTime()) g_shownStatSeq = ti.statSeq;
+        } else if (ti.statSeq != g_shownStatSeq) {
+            g_shownStatSeq = ti.statSeq;
             uint8_t mins = ti.elapsedSec / 60;
             uint8_t secs = ti.elapsedSec % 60;
             cdc_setPlayTime(mins, secs);
@@ -0,0 +1,99 @@
+#include "mem_governor.h"
+#include "timer_wheel.h"
+#include "bt_webui.h"
+
+// Порог входа в уровень: free < freeBelow ИЛИ largest < blockBelow.
+// Индекс = уровень; для NORMAL порогов нет.
+struct MemThreshold {
+    uint32_t freeBelow;
+    uint32_t blockBelow;
+};
+
+static const MemThreshold THRESHOLDS[MEM_LEVEL_COUNT] = {
+    {     0,     0 },  // NORMAL
+    { 48000, 16000 },  // REPLAY
+    { 36000, 12000 },  // NO_RAW
+    { 28000,  9000 },  // NO_DEBUG
+    { 20000,  6000 },  // NO_CLIENTS
+};
+
+// Запас для возврата на уровень ниже
+static const uint32_t HYST_FREE  = 8000;
+static const uint32_t HYST_BLOCK = 4000;
+
+static const uint32_t SAMPLE_MS = 1000;
+
+static MemStats g_mem = {};
+
+static bool underPressure(uint8_t level, uint32_t freeHeap, uint32_t block, bool leaving) {
+    const MemThreshold &t = THRESHOLDS[level];
+    uint32_t f = t.freeBelow  + (leaving ? HYST_FREE  : 0);
+    uint32_t b = t.blockBelow + (leaving ? HYST_BLOCK : 0);
+    return freeHeap < f || block < b;
+}
+
+static void sample() {
+    g_mem.freeHeap     = ESP.getFreeHeap();
+    g_mem.largestBlock = ESP.getMaxAllocHeap();
+    g_mem.minFreeHeap  = ESP.getMinFreeHeap();
+
+    uint8_t cur  = (uint8_t)g_mem.level;
+    uint8_t next = cur;
+    if (cur + 1 < MEM_LEVEL_COUNT && underPressure(cur + 1, g_mem.freeHeap, g_mem.largestBlock, false)) {
+        next = cur + 1;
+    } else if (cur > 0 && !underPressure(cur, g_mem.freeHeap, g_mem.largestBlock, true)) {
+        next = cur - 1;
+    }
+    if (next == cur) return;
+
+    g_mem.level = (MemLevel)next;
+    g_mem.transitions++;
+    btWebUI_log(String("[MEM] ") + mem_levelName((MemLevel)cur) + " -> " +
+                mem_levelName((MemLevel)next) + " (free=" + String(g_mem.freeHeap) +
+                " block=" + String(g_mem.largestBlock) + ")", LogLevel::INFO);
+}
+
+void mem_init() {
+    g_mem = MemStats();
+    g_mem.level = MemLevel::NORMAL;
+    sample();
+    timer_start(sample, SAMPLE_MS, SAMPLE_MS);
+}
+
+MemLevel mem_getLevel() { return g_mem.level; }
+
+const char* mem_levelName(MemLevel level) {
+    switch (level) {
+        case MemLevel::NORMAL:     return "NORMAL";
+        case MemLevel::REPLAY:     return "REPLAY";
+        case MemLevel::NO_RAW:     return "NO_RAW";
+        case MemLevel::NO_DEBUG:   return "NO_DEBUG";
+        case MemLevel::NO_CLIENTS: return "NO_CLIENTS";
+    }
+    return "UNKNOWN";
+}
+
+const MemStats &mem_getStats() { return g_mem; }
+
+uint16_t mem_logReplayLimit(uint16_t full) {
+    if (g_mem.level >= MemLevel::REPLAY && full > MEM_REPLAY_SHORT) return MEM_REPLAY_SHORT;
+    return full;
+}
+
+bool mem_rawAllowed() {
+    if (g_mem.level < MemLevel::NO_RAW) return true;
+    g_mem.rawDropped++;
+    return false;
+}
+
+bool mem_debugAllowed() {
+    if (g_mem.level < MemLevel::NO_DEBUG) return true;
+    g_mem.linesDropped++;
+    return false;
+}
+
+bool mem_wsAcceptAllowed() {
+    if (g_mem.level < MemLevel::NO_CLIENTS) return true;
+    g_mem.wsRefused++;
+    return false;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file mem_governor.h
+ * @brief Memory-pressure governor: sheds debug features before heap runs out
+ *
+ * Free heap and the largest free block are sampled once per second. Each
+ * pressure level keeps everything the previous one shed:
+ *   NORMAL    — all features
+ *   REPLAY    — log replay to new WebSocket clients limited to MEM_REPLAY_SHORT
+ *   NO_RAW    — RAW pulse streaming ([CDC_NEC] channel) off
+ *   NO_DEBUG  — DEBUG/VERBOSE lines dropped even in debug mode
+ *   NO_CLIENTS— new WebSocket clients refused
+ *
+ * The level moves one step per sample; going down requires the thresholds
+ * of the current level plus a hysteresis margin. CDC framing and BT control
+ * allocate nothing here and are never shed. Every transition is logged.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+enum class MemLevel : uint8_t {
+    NORMAL     = 0,
+    REPLAY     = 1,
+    NO_RAW     = 2,
+    NO_DEBUG   = 3,
+    NO_CLIENTS = 4
+};
+
+static const uint8_t  MEM_LEVEL_COUNT  = 5;
+static const uint16_t MEM_REPLAY_SHORT = 16;  // строк истории при REPLAY и выше
+
+struct MemStats {
+    uint32_t freeHeap;       // последний замер
+    uint32_t largestBlock;
+    uint32_t minFreeHeap;    // с момента загрузки (ESP.getMinFreeHeap)
+    MemLevel level;
+    uint32_t transitions;
+    uint32_t rawDropped;     // RAW строк не отправлено
+    uint32_t linesDropped;   // DEBUG/VERBOSE строк отброшено
+    uint32_t wsRefused;      // отклонено WS клиентов
+};
+
+// Вызывать после timer_init() (замер — периодический таймер)
+void mem_init();
+
+MemLevel        mem_getLevel();
+const char*     mem_levelName(MemLevel level);
+const MemStats &mem_getStats();
+
+// Разрешения для потребителей
+uint16_t mem_logReplayLimit(uint16_t full);  // сколько строк истории слать новому клиенту
+bool     mem_rawAllowed();                   // false → учитывается в rawDropped
+bool     mem_debugAllowed();                 // false → учитывается в linesDropped
+bool     mem_wsAcceptAllowed();              // false → учитывается в wsRefused
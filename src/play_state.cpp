@@ -0,0 +1,115 @@
+#include "play_state.h"
+#include "bt1036_at.h"
+#include "timer_wheel.h"
+#include "bt_webui.h"
+
+static PlayState g_reported = PlayState::UNKNOWN;
+static PlayState g_target   = PlayState::UNKNOWN;
+static bool      g_pending  = false;
+static uint16_t  g_seq      = 0;
+static uint32_t  g_sentMs   = 0;
+static TimerId   g_timer    = TIMER_NONE;
+static bool      g_remoteSinceCmd = false;  // телефон сменил состояние после нашей последней команды
+static PlayStateStats g_stats = {};
+
+static PlayState fromBt(BTConnState st) {
+    switch (st) {
+        case BTConnState::PLAYING:        return PlayState::PLAYING;
+        case BTConnState::PAUSED:         return PlayState::PAUSED;
+        case BTConnState::CONNECTED_IDLE: return PlayState::STOPPED;
+        default:                          return PlayState::UNKNOWN;
+    }
+}
+
+static void onConfirmTimeout() {
+    g_timer = TIMER_NONE;
+    if (!g_pending) return;
+    g_pending = false;
+    g_stats.timedOut++;
+    btWebUI_log("[PLAY] #" + String(g_seq) + " " + pstate_name(g_target) +
+                " not confirmed, module says " + pstate_name(g_reported), LogLevel::DEBUG);
+}
+
+static void onBtState(BTConnState oldState, BTConnState newState) {
+    PlayState st = fromBt(newState);
+    if (st == g_reported) return;
+    g_reported = st;
+
+    if (st == PlayState::UNKNOWN) {
+        // Соединение потеряно — ждать подтверждения не от кого
+        g_pending = false;
+        timer_cancel(g_timer);
+        g_remoteSinceCmd = false;
+        return;
+    }
+
+    if (g_pending) {
+        if (st == g_target) {
+            g_pending = false;
+            timer_cancel(g_timer);
+            g_stats.confirmed++;
+            btWebUI_log("[PLAY] #" + String(g_seq) + " confirmed in " +
+                        String(millis() - g_sentMs) + "ms", LogLevel::DEBUG);
+        } else {
+            g_stats.conflicts++;
+        }
+        return;
+    }
+
+    if (st != g_target) {
+        g_stats.remoteChanges++;
+        g_remoteSinceCmd = true;
+    }
+}
+
+static void sendFor(PlayState target) {
+    switch (target) {
+        case PlayState::PLAYING: bt1036_play();  break;
+        case PlayState::PAUSED:  bt1036_pause(); break;
+        case PlayState::STOPPED: bt1036_stop();  break;
+        default: return;
+    }
+    g_target  = target;
+    g_pending = true;
+    g_seq++;
+    g_sentMs  = millis();
+    g_stats.commands++;
+    g_remoteSinceCmd = false;
+    if (timer_restart(g_timer, onConfirmTimeout, PSTATE_CONFIRM_MS) == TIMER_NONE) {
+        onConfirmTimeout();  // без таймера pending не снимется, если телефон промолчит
+    }
+}
+
+void pstate_init() {
+    g_reported = fromBt(bt1036_getState());
+    bt1036_setStateCallback(onBtState);
+}
+
+PlayState pstate_get()      { return g_pending ? g_target : g_reported; }
+PlayState pstate_reported() { return g_reported; }
+bool      pstate_pending()  { return g_pending; }
+uint16_t  pstate_seq()      { return g_seq; }
+
+PlayState pstate_toggle() {
+    PlayState target = (pstate_get() == PlayState::PLAYING) ? PlayState::PAUSED : PlayState::PLAYING;
+    // Старая логика (локальный флаг) знала только свою последнюю команду
+    if (g_remoteSinceCmd && g_stats.commands && target == g_target) g_stats.savedPresses++;
+    sendFor(target);
+    return target;
+}
+
+void pstate_request(PlayState target) {
+    sendFor(target);
+}
+
+const char *pstate_name(PlayState st) {
+    switch (st) {
+        case PlayState::UNKNOWN: return "UNKNOWN";
+        case PlayState::STOPPED: return "STOPPED";
+        case PlayState::PAUSED:  return "PAUSED";
+        case PlayState::PLAYING: return "PLAYING";
+    }
+    return "?";
+}
+
+const PlayStateStats &pstate_getStats() { return g_stats; }
@@ -0,0 +1,59 @@
+/**
+ * @file play_state.h
+ * @brief Authoritative playback state: module reports + pending local commands
+ *
+ * The module reports playback through +PLAYSTAT / +A2DPSTAT (BTConnState);
+ * local buttons send AT+PLAY / AT+PAUSE / AT+STOP. This model merges both:
+ *
+ *   - every local command gets a sequence number and becomes "pending";
+ *     while pending, the effective state is the command's target;
+ *   - a module report equal to the target confirms it;
+ *   - a contradicting report during the window is counted as a conflict
+ *     (it may predate the command) and the command stays pending;
+ *   - after PSTATE_CONFIRM_MS without confirmation the module's report wins;
+ *   - with nothing pending, the module's report is the state — a pause on
+ *     the phone is seen here, so the next toggle sends PLAY, not PAUSE.
+ *
+ * A newer command supersedes an older pending one.
+ * Uses bt1036_setStateCallback() (single slot).
+ */
+
+#pragma once
+#include <Arduino.h>
+
+enum class PlayState : uint8_t {
+    UNKNOWN,   // нет A2DP соединения
+    STOPPED,
+    PAUSED,
+    PLAYING
+};
+
+static const uint32_t PSTATE_CONFIRM_MS = 2500;
+
+struct PlayStateStats {
+    uint32_t commands;        // локальных команд (play/pause/stop)
+    uint32_t confirmed;       // модуль подтвердил
+    uint32_t timedOut;        // не подтвердил — победил отчёт модуля
+    uint32_t conflicts;       // противоречащий отчёт в окне ожидания
+    uint32_t remoteChanges;   // смена состояния с телефона (без нашей команды)
+    uint32_t savedPresses;    // toggle после смены с телефона: локальный флаг
+                              // отправил бы не ту команду (лишнее нажатие + AT)
+};
+
+void pstate_init();
+
+// Текущее эффективное состояние (pending команда или отчёт модуля)
+PlayState pstate_get();
+PlayState pstate_reported();
+bool      pstate_pending();
+uint16_t  pstate_seq();   // номер последней локальной команды
+
+// Отправить команду на переключение истинного текущего состояния;
+// возвращает новое целевое состояние (PLAYING / PAUSED)
+PlayState pstate_toggle();
+
+// Явная команда: PLAYING → AT+PLAY, PAUSED → AT+PAUSE, STOPPED → AT+STOP
+void pstate_request(PlayState target);
+
+const char *pstate_name(PlayState st);
+const PlayStateStats &pstate_getStats();
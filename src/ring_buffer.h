@@ -0,0 +1,208 @@
+/**
+ * @file ring_buffer.h
+ * @brief Fixed-capacity rings and queues shared by the firmware
+ *
+ *   SpscRing<T, N>      — one producer, one consumer; ISR → loop safe.
+ *                         Full ring drops the new element (overflows()).
+ *   MpscRing<T, N>      — any number of producers (ISRs, tasks, both cores),
+ *                         one consumer. Bounded, lock-free (per-slot sequence).
+ *   OverwriteRing<T, N> — single context history buffer: a full ring drops
+ *                         the oldest element; indexed oldest-first.
+ *
+ * N must be a power of two: indices are free-running uint32_t counters
+ * masked with N-1, so all N slots are usable and wraparound is harmless.
+ * Push/pop are forced inline so IRAM_ATTR ISRs never call into flash.
+ *
+ * No Arduino dependencies — usable from host tools.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <utility>
+
+#define RING_INLINE inline __attribute__((always_inline))
+
+template <uint32_t N>
+struct RingCapacity {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "ring capacity must be a power of two");
+    static const uint32_t MASK = N - 1;
+};
+
+// ============================================================================
+// SPSC
+// ============================================================================
+template <typename T, uint32_t N>
+class SpscRing {
+public:
+    static const uint32_t CAPACITY = N;
+
+    // --- producer ---
+    RING_INLINE bool push(const T &v) {
+        uint32_t h = m_head.load(std::memory_order_relaxed);
+        if (h - m_tail.load(std::memory_order_acquire) >= N) {
+            m_overflows++;
+            return false;
+        }
+        m_buf[h & RingCapacity<N>::MASK] = v;
+        m_head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // --- consumer ---
+    RING_INLINE bool pop(T &out) {
+        uint32_t t = m_tail.load(std::memory_order_relaxed);
+        if (t == m_head.load(std::memory_order_acquire)) return false;
+        out = std::move(m_buf[t & RingCapacity<N>::MASK]);
+        m_tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Первый элемент без извлечения (nullptr — пусто)
+    RING_INLINE T *front() {
+        uint32_t t = m_tail.load(std::memory_order_relaxed);
+        if (t == m_head.load(std::memory_order_acquire)) return nullptr;
+        return &m_buf[t & RingCapacity<N>::MASK];
+    }
+
+    // Выбросить первый элемент
+    RING_INLINE bool drop() {
+        uint32_t t = m_tail.load(std::memory_order_relaxed);
+        if (t == m_head.load(std::memory_order_acquire)) return false;
+        m_tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Выбросить всё накопленное (со стороны consumer)
+    RING_INLINE void clear() {
+        m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // Полный сброс — только когда producer гарантированно молчит
+    void reset() {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_overflows = 0;
+    }
+
+    RING_INLINE uint32_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+    RING_INLINE bool empty() const { return size() == 0; }
+    RING_INLINE bool full() const  { return size() >= N; }
+
+    uint32_t overflows() const { return m_overflows; }
+    uint32_t pushed() const    { return m_head.load(std::memory_order_relaxed); }
+    uint32_t popped() const    { return m_tail.load(std::memory_order_relaxed); }
+
+private:
+    T                     m_buf[N];
+    std::atomic<uint32_t> m_head{0};   // пишет только producer
+    std::atomic<uint32_t> m_tail{0};   // пишет только consumer
+    volatile uint32_t     m_overflows = 0;
+};
+
+// ============================================================================
+// MPSC (bounded, Vyukov): слот принадлежит producer'у, выигравшему CAS
+// ============================================================================
+template <typename T, uint32_t N>
+class MpscRing {
+public:
+    static const uint32_t CAPACITY = N;
+
+    MpscRing() {
+        for (uint32_t i = 0; i < N; ++i) m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    // --- producers ---
+    RING_INLINE bool push(const T &v) {
+        uint32_t pos = m_enqueue.load(std::memory_order_relaxed);
+        Cell *c;
+        for (;;) {
+            c = &m_cells[pos & RingCapacity<N>::MASK];
+            int32_t diff = (int32_t)(c->seq.load(std::memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                m_overflows.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = m_enqueue.load(std::memory_order_relaxed);
+            }
+        }
+        c->data = v;
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // --- consumer ---
+    RING_INLINE bool pop(T &out) {
+        Cell &c = m_cells[m_dequeue & RingCapacity<N>::MASK];
+        if ((int32_t)(c.seq.load(std::memory_order_acquire) - (m_dequeue + 1)) < 0) return false;
+        out = std::move(c.data);
+        c.seq.store(m_dequeue + N, std::memory_order_release);
+        m_dequeue++;
+        return true;
+    }
+
+    // Приблизительно (producer'ы могут быть посреди push)
+    uint32_t size() const {
+        return m_enqueue.load(std::memory_order_relaxed) - m_dequeue;
+    }
+    bool empty() const { return size() == 0; }
+
+    uint32_t overflows() const { return m_overflows.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> seq;
+        T                     data;
+    };
+    Cell                  m_cells[N];
+    std::atomic<uint32_t> m_enqueue{0};
+    uint32_t              m_dequeue = 0;  // только consumer
+    std::atomic<uint32_t> m_overflows{0};
+};
+
+// ============================================================================
+// Overwrite-oldest (история: лог, последние N событий)
+// ============================================================================
+template <typename T, uint32_t N>
+class OverwriteRing {
+public:
+    static const uint32_t CAPACITY = N;
+
+    // Возвращает ссылку на записанный элемент
+    RING_INLINE T &push(const T &v) {
+        T &slot = pushSlot();
+        slot = v;
+        return slot;
+    }
+
+    // Занять следующий слот и заполнить на месте (без копии T);
+    // в слоте — старое содержимое вытесненного элемента
+    RING_INLINE T &pushSlot() {
+        T &slot = m_buf[m_head & RingCapacity<N>::MASK];
+        m_head++;
+        if (m_head - m_tail > N) m_tail = m_head - N;
+        return slot;
+    }
+
+    // i = 0 — самый старый
+    RING_INLINE T &operator[](uint32_t i)             { return m_buf[(m_tail + i) & RingCapacity<N>::MASK]; }
+    RING_INLINE const T &operator[](uint32_t i) const { return m_buf[(m_tail + i) & RingCapacity<N>::MASK]; }
+    RING_INLINE T &newest() { return m_buf[(m_head - 1) & RingCapacity<N>::MASK]; }
+
+    RING_INLINE uint32_t size() const { return m_head - m_tail; }
+    RING_INLINE bool empty() const    { return m_head == m_tail; }
+    void clear()                      { m_tail = m_head; }
+
+    // Всего записано; порядковый номер самого старого элемента
+    uint32_t pushed() const    { return m_head; }
+    uint32_t oldestSeq() const { return m_tail; }
+
+private:
+    T        m_buf[N];
+    uint32_t m_head = 0;
+    uint32_t m_tail = 0;
+};
@@ -0,0 +1,95 @@
+#include "scenario.h"
+#include "bt_webui.h"
+
+static Scenario *g_table[SC_MAX];
+static uint8_t   g_count = 0;
+
+bool sc_register(Scenario &sc) {
+    for (uint8_t i = 0; i < g_count; ++i) {
+        if (g_table[i] == &sc) return true;
+    }
+    if (g_count >= SC_MAX) return false;
+    g_table[g_count++] = &sc;
+    return true;
+}
+
+static void finish(Scenario &sc, ScStatus result) {
+    uint32_t ms = millis() - sc.startMs;
+    sc.status = result;
+    sc.line   = 0;
+    sc.lastMs = ms;
+    if (ms > sc.maxMs) sc.maxMs = ms;
+
+    String msg = "[SCEN] " + String(sc.name);
+    if (result == ScStatus::DONE) {
+        sc.done++;
+        if (sc.done == 1 || ms < sc.minMs) sc.minMs = ms;
+        msg += " done in " + String(ms) + " ms";
+        if (sc.errors) msg += " (" + String(sc.errors) + " step errors)";
+    } else {
+        sc.failed++;
+        msg += (result == ScStatus::ABORTED ? " aborted: " : " failed: ");
+        msg += sc.failReason;
+        msg += " after " + String(ms) + " ms";
+    }
+    btWebUI_log(msg, LogLevel::INFO);
+}
+
+bool sc_start(Scenario &sc, uint32_t arg) {
+    if (sc.status == ScStatus::RUNNING) return false;
+    if (!sc_register(sc)) return false;
+
+    sc.line       = 0;
+    sc.timedOut   = false;
+    sc.i          = 0;
+    sc.errors     = 0;
+    sc.waitMs     = 0;
+    sc.ticket     = 0;
+    sc.arg        = arg;
+    sc.failReason = "";
+    sc.startMs    = millis();
+    sc.status     = ScStatus::RUNNING;
+    sc.runs++;
+    btWebUI_log("[SCEN] " + String(sc.name) + " start", LogLevel::DEBUG);
+
+    // Первый участок (до первого ожидания) — сразу
+    ScStatus r = sc.fn(sc);
+    if (r != ScStatus::RUNNING) finish(sc, r);
+    return true;
+}
+
+void sc_abort(Scenario &sc, const char *reason) {
+    if (sc.status != ScStatus::RUNNING) return;
+    sc.failReason = reason;
+    finish(sc, ScStatus::ABORTED);
+}
+
+bool sc_running(const Scenario &sc) {
+    return sc.status == ScStatus::RUNNING;
+}
+
+void sc_poll() {
+    for (uint8_t i = 0; i < g_count; ++i) {
+        Scenario &sc = *g_table[i];
+        if (sc.status != ScStatus::RUNNING) continue;
+        ScStatus r = sc.fn(sc);
+        if (r != ScStatus::RUNNING) finish(sc, r);
+    }
+}
+
+uint8_t sc_count() { return g_count; }
+
+const Scenario *sc_get(uint8_t idx) {
+    return idx < g_count ? g_table[idx] : nullptr;
+}
+
+const char *sc_statusName(ScStatus s) {
+    switch (s) {
+        case ScStatus::IDLE:    return "IDLE";
+        case ScStatus::RUNNING: return "RUNNING";
+        case ScStatus::DONE:    return "DONE";
+        case ScStatus::FAILED:  return "FAILED";
+        case ScStatus::ABORTED: return "ABORTED";
+    }
+    return "?";
+}
@@ -0,0 +1,116 @@
+/**
+ * @file scenario.h
+ * @brief Stackless scenario engine for multi-step sequences
+ *
+ * A scenario is a plain function written top to bottom; the SC_* macros
+ * turn it into a resumable state machine (protothread, Duff's device):
+ * every wait stores its source line and returns, the next poll jumps
+ * straight back to it. No task, no stack, no blocking — the whole state is
+ * the fixed-size Scenario struct.
+ *
+ * Rules of the body:
+ *   - locals don't survive a wait: keep counters/results in the struct
+ *     (i, errors, ticket, arg);
+ *   - one SC_* wait per source line (the line number is the resume point);
+ *   - no switch statement around a wait.
+ *
+ * Waits: the result of a queued AT command, any condition (BT state,
+ * playback state), or time. Every wait is bounded; sc.timedOut tells how
+ * it ended. Run count, failures and completion times are kept per
+ * scenario and shown on /api/scenarios.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "bt1036_at.h"
+
+static const uint8_t  SC_MAX        = 4;
+static const uint32_t SC_AT_MAX_MS  = 15000;  // страховка: очередь AT + собственный таймаут команды
+
+enum class ScStatus : uint8_t {
+    IDLE,
+    RUNNING,
+    DONE,
+    FAILED,
+    ABORTED
+};
+
+struct Scenario;
+typedef ScStatus (*ScenarioFn)(Scenario &sc);
+
+struct Scenario {
+    const char *name;
+    ScenarioFn  fn;
+
+    // --- состояние продолжения (сбрасывается при запуске) ---
+    uint16_t    line;        // точка возобновления, 0 = начало
+    bool        timedOut;    // чем кончилось последнее ожидание
+    uint8_t     i;           // счётчик цикла тела
+    uint8_t     errors;      // нефатальные ошибки шагов
+    uint32_t    waitMs;      // начало текущего ожидания
+    uint32_t    ticket;      // последняя AT-команда (bt1036_lastTicket)
+    uint32_t    arg;         // параметр запуска
+
+    // --- статистика ---
+    ScStatus    status;
+    const char *failReason;
+    uint32_t    startMs;
+    uint32_t    lastMs;      // длительность последнего завершённого запуска
+    uint32_t    minMs;       // по успешным запускам
+    uint32_t    maxMs;
+    uint16_t    runs;
+    uint16_t    done;
+    uint16_t    failed;      // FAILED + ABORTED
+};
+
+#define SC_SCENARIO(n, f) { (n), (f), 0, false, 0, 0, 0, 0, 0, ScStatus::IDLE, "", 0, 0, 0, 0, 0, 0, 0 }
+
+#define SC_BEGIN(sc)  switch ((sc).line) { case 0:
+#define SC_END(sc)    } (void)(sc); return ScStatus::DONE
+
+// Ждать cond не дольше ms; (sc).timedOut = true, если дождались таймаута
+#define SC_WAIT(sc, cond, ms)                                                   \
+    do {                                                                        \
+        (sc).waitMs = millis();                                                 \
+        (sc).line = __LINE__;                                                   \
+        __attribute__((fallthrough));                                           \
+        case __LINE__:                                                          \
+        (sc).timedOut = !(cond);                                                \
+        if ((sc).timedOut && millis() - (sc).waitMs < (uint32_t)(ms))           \
+            return ScStatus::RUNNING;                                           \
+    } while (0)
+
+#define SC_SLEEP(sc, ms)  SC_WAIT(sc, false, ms)
+
+// call ставит ровно одну AT-команду (любой bt1036_*); ждём её результат
+#define SC_AT(sc, call)                                                         \
+    do {                                                                        \
+        call;                                                                   \
+        (sc).ticket = bt1036_lastTicket();                                      \
+        SC_WAIT(sc, bt1036_cmdResult((sc).ticket) != BtCmdResult::PENDING,      \
+                SC_AT_MAX_MS);                                                  \
+    } while (0)
+
+#define SC_AT_RESULT(sc)  bt1036_cmdResult((sc).ticket)
+
+#define SC_FAIL(sc, reason)                                                     \
+    do {                                                                        \
+        (sc).failReason = (reason);                                             \
+        return ScStatus::FAILED;                                                \
+    } while (0)
+
+// Добавить в таблицу (для /api/scenarios); sc_start регистрирует сам
+bool sc_register(Scenario &sc);
+
+// false — уже выполняется (или таблица полна)
+bool sc_start(Scenario &sc, uint32_t arg = 0);
+void sc_abort(Scenario &sc, const char *reason);
+bool sc_running(const Scenario &sc);
+
+// Шаг планировщика: продвинуть все активные сценарии
+void sc_poll();
+
+// Зарегистрированные сценарии
+uint8_t         sc_count();
+const Scenario *sc_get(uint8_t idx);
+const char     *sc_statusName(ScStatus s);
@@ -0,0 +1,163 @@
+#include "session_log.h"
+#include "vw_cdc.h"
+#include "dataout_decoder.h"
+#include "loop_sched.h"
+#include "mem_governor.h"
+#include "timer_wheel.h"
+#include "bt_webui.h"
+#include <Preferences.h>
+
+static const char *const NVS_NS = "sess";
+
+static SessionRecord g_cur         = {};
+static bool          g_started     = false;
+static bool          g_btUp        = false;
+static uint32_t      g_btUpMs      = 0;     // начало текущего подключения
+static uint32_t      g_btAccumMs   = 0;     // закрытые подключения
+static uint32_t      g_writes      = 0;
+
+static String slotKey(uint32_t seq) {
+    return "r" + String(seq % SESS_SLOTS);
+}
+
+static bool isConnected(BTConnState s) {
+    return s == BTConnState::CONNECTED_IDLE || s == BTConnState::PLAYING || s == BTConnState::PAUSED;
+}
+
+// Счётчики, которые ведут сами подсистемы, — снимок на момент вызова
+static void refresh() {
+    uint32_t now = millis();
+    g_cur.uptimeS = now / 1000;
+    g_cur.btConnectedS = (g_btAccumMs + (g_btUp ? now - g_btUpMs : 0)) / 1000;
+
+    for (uint8_t i = 0; i < sched_getStepCount(); ++i) {
+        const SchedStep *s = sched_getStep(i);
+        if (s->fn == cdc_sendFrame) {
+            g_cur.frames      = s->runs;
+            g_cur.frameMisses = s->misses;
+            break;
+        }
+    }
+
+    const BtCmdCounters &c = bt1036_getCmdCounters();
+    g_cur.cmdsSent    = c.sent;
+    g_cur.cmdsFailed  = c.errors + c.dropped;
+    g_cur.cmdTimeouts = c.timeouts > 0xFFFF ? 0xFFFF : (uint16_t)c.timeouts;
+
+    uint32_t decodeErrors = cdc_getEdgeOverflows();
+    for (uint8_t i = 0; i < cdc_getDecoderCount(); ++i) {
+        const char *name;
+        DecoderStats ds;
+        if (cdc_getDecoderStats(i, name, ds)) decodeErrors += ds.invalid + ds.aborted;
+    }
+    g_cur.decodeErrors = decodeErrors;
+    g_cur.minFreeHeap  = mem_getStats().minFreeHeap;
+}
+
+static void writeCurrent() {
+    if (!g_started) return;
+    refresh();
+    Preferences p;
+    p.begin(NVS_NS, false);
+    if (p.putBytes(slotKey(g_cur.seq).c_str(), &g_cur, sizeof(g_cur)) == sizeof(g_cur)) g_writes++;
+    p.end();
+}
+
+static void onCheckpoint() {
+    writeCurrent();
+}
+
+void sess_init(uint8_t resetReason) {
+    Preferences p;
+    p.begin(NVS_NS, false);
+    uint32_t seq = p.getUInt("seq", 0);
+    p.putUInt("seq", seq + 1);
+    p.end();
+
+    g_cur = SessionRecord();
+    g_cur.version       = SESS_RECORD_VERSION;
+    g_cur.resetReason   = resetReason;
+    g_cur.seq           = seq;
+    g_cur.timeToAudioMs = SESS_NO_AUDIO;
+    g_started = true;
+
+    // Слот этой сессии сразу перезаписываем: старая запись в нём —
+    // сессия SESS_SLOTS загрузок назад
+    writeCurrent();
+    timer_start(onCheckpoint, SESS_CHECKPOINT_MS, SESS_CHECKPOINT_MS);
+    btWebUI_log("[SYS] Session #" + String(seq) + " started", LogLevel::INFO);
+}
+
+void sess_onBtState(BTConnState state) {
+    uint32_t now = millis();
+    bool up = isConnected(state);
+    bool wasUp = g_btUp;
+    if (up && !wasUp) {
+        g_btUpMs = now;
+        if (g_cur.btConnects < 0xFFFF) g_cur.btConnects++;
+    } else if (!up && wasUp) {
+        g_btAccumMs += now - g_btUpMs;
+    }
+    g_btUp = up;
+
+    if (state == BTConnState::PLAYING && g_cur.timeToAudioMs == SESS_NO_AUDIO) {
+        g_cur.timeToAudioMs = now;
+        btWebUI_log("[SYS] Session: first audio after " + String(now) + " ms", LogLevel::INFO);
+    }
+
+    // Телефон ушёл — часто это и есть конец поездки
+    if (wasUp && !up) writeCurrent();
+}
+
+void sess_noteButton() {
+    if (g_cur.buttons < 0xFFFF) g_cur.buttons++;
+}
+
+void sess_flush() {
+    writeCurrent();
+}
+
+bool sess_get(uint8_t age, SessionRecord &out) {
+    if (!g_started || age >= SESS_SLOTS || age > g_cur.seq) return false;
+    if (age == 0) {
+        refresh();
+        out = g_cur;
+        return true;
+    }
+    uint32_t seq = g_cur.seq - age;
+    Preferences p;
+    p.begin(NVS_NS, true);
+    String key = slotKey(seq);
+    bool ok = p.getBytesLength(key.c_str()) == sizeof(SessionRecord) &&
+              p.getBytes(key.c_str(), &out, sizeof(SessionRecord)) == sizeof(SessionRecord);
+    p.end();
+    return ok && out.version == SESS_RECORD_VERSION && out.seq == seq;
+}
+
+void sess_clear() {
+    Preferences p;
+    p.begin(NVS_NS, false);
+    for (uint8_t i = 0; i < SESS_SLOTS; ++i) p.remove(("r" + String(i)).c_str());
+    p.end();
+    btWebUI_log("[SYS] Session history cleared", LogLevel::INFO);
+}
+
+uint32_t sess_getWrites() {
+    return g_writes;
+}
+
+const char *sess_resetReasonName(uint8_t reason) {
+    switch ((esp_reset_reason_t)reason) {
+        case ESP_RST_POWERON:   return "power-on";
+        case ESP_RST_EXT:       return "external";
+        case ESP_RST_SW:        return "software";
+        case ESP_RST_PANIC:     return "panic";
+        case ESP_RST_INT_WDT:   return "int-wdt";
+        case ESP_RST_TASK_WDT:  return "task-wdt";
+        case ESP_RST_WDT:       return "wdt";
+        case ESP_RST_DEEPSLEEP: return "deep-sleep";
+        case ESP_RST_BROWNOUT:  return "brownout";
+        case ESP_RST_SDIO:      return "sdio";
+        default:                return "unknown";
+    }
+}
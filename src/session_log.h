@@ -0,0 +1,70 @@
+/**
+ * @file session_log.h
+ * @brief Per-drive summary records kept across power cycles
+ *
+ * Every boot (one ignition cycle) is a session. Its counters — CDC frames
+ * and deadline misses, BT connected time and time to first audio, AT
+ * commands sent / failed / timed out, DataOut decode errors, buttons,
+ * minimum free heap — are collected in RAM and written as one fixed-size
+ * binary record into a ring of SESS_SLOTS records in NVS.
+ *
+ * Ignition off just cuts the power, so the record is not written "at the
+ * end": it is refreshed every SESS_CHECKPOINT_MS, when the phone
+ * disconnects and before a software reboot. At most the last checkpoint
+ * interval of a drive is lost.
+ *
+ * Flash wear: NVS is a log-structured, wear-levelled store — a rewrite of
+ * the same key lands in a fresh entry and pages are erased in rotation,
+ * so the per-minute checkpoint doesn't hammer one sector.
+ *
+ * /api/sessions lists the current session (live) and the stored ones,
+ * newest first.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "bt1036_at.h"
+
+static const uint8_t  SESS_SLOTS          = 16;      // поездок в кольце
+static const uint32_t SESS_CHECKPOINT_MS  = 60000;   // перезапись текущей записи
+static const uint8_t  SESS_RECORD_VERSION = 1;
+static const uint32_t SESS_NO_AUDIO       = 0xFFFFFFFF;
+
+// Запись в NVS (blob). Поля выровнены естественно — без packed.
+struct SessionRecord {
+    uint8_t  version;        // SESS_RECORD_VERSION
+    uint8_t  resetReason;    // esp_reset_reason() при старте сессии
+    uint16_t buttons;        // команд от магнитолы
+    uint32_t seq;            // номер сессии (растёт с каждой загрузкой)
+    uint32_t uptimeS;        // длительность на момент записи
+    uint32_t frames;         // кадров CDC отправлено
+    uint32_t frameMisses;    // кадр позже дедлайна
+    uint32_t btConnectedS;   // телефон подключён
+    uint32_t timeToAudioMs;  // от загрузки до первого PLAYING (SESS_NO_AUDIO — не было)
+    uint16_t btConnects;
+    uint16_t cmdTimeouts;
+    uint32_t cmdsSent;
+    uint32_t cmdsFailed;     // ERROR + не встали в очередь
+    uint32_t decodeErrors;   // DataOut: битые/оборванные пакеты + потерянные импульсы
+    uint32_t minFreeHeap;
+};
+static_assert(sizeof(SessionRecord) == 48, "SessionRecord layout changed: bump SESS_RECORD_VERSION");
+
+// После timer_init() и init подсистем; reason — esp_reset_reason()
+void sess_init(uint8_t resetReason);
+
+// Из appLoop() при смене состояния BT (подключения, время до звука)
+void sess_onBtState(BTConnState state);
+void sess_noteButton();
+
+// Записать текущую сессию сейчас (перед перезагрузкой)
+void sess_flush();
+
+// age 0 — текущая (живые счётчики), 1..SESS_SLOTS-1 — предыдущие.
+// false — записи нет (ещё не было столько загрузок / стёрта / другой формат)
+bool sess_get(uint8_t age, SessionRecord &out);
+
+// Стереть сохранённые записи (номер сессии не сбрасывается)
+void sess_clear();
+uint32_t sess_getWrites();  // записей в NVS с загрузки
+const char *sess_resetReasonName(uint8_t reason);
@@ -0,0 +1,217 @@
+#include "syslog_ship.h"
+#include "ring_buffer.h"
+#include "mem_governor.h"
+#include "cpu_load.h"
+#include "loop_sched.h"
+#include "bt1036_at.h"
+#include "vw_cdc.h"
+#include <WiFi.h>
+#include <Preferences.h>
+
+static const char *const NVS_NS = "syslog";
+
+static const char    *g_hostname = "esp32";
+static SyslogConfig   g_cfg      = { false, "", 514, LogLevel::INFO, 10, 30 };
+static SyslogStats    g_stats    = {};
+static IPAddress      g_ip;
+static bool           g_ipValid  = false;
+static WiFiUDP        g_udp;
+
+// Готовые строки "<PRI>host fw[seq]: msg\n"
+static SpscRing<char, SLOG_RING> g_ring;
+static uint32_t       g_seq       = 0;
+
+// Строка, вынутая из кольца, но не влезшая в прошлую датаграмму
+static char           g_carry[SLOG_MAX_LINE + 64];
+static uint16_t       g_carryLen  = 0;
+
+static uint32_t       g_lastSendMs   = 0;
+static uint32_t       g_lastRefillMs = 0;
+static uint32_t       g_tokensMilli  = 0;   // токены × 1000
+static bool           g_limited      = false;
+static uint32_t       g_lastMetricsMs = 0;
+
+static bool parseHost(const String &host, IPAddress &ip) {
+    return host.length() && ip.fromString(host);
+}
+
+static void enqueue(const char *msg, size_t len, uint8_t severity) {
+    uint32_t seq = g_seq++;  // и для отброшенных: дыра видна на коллекторе
+    if (len > SLOG_MAX_LINE) len = SLOG_MAX_LINE;
+
+    char head[64];
+    int hlen = snprintf(head, sizeof(head), "<%u>%s fw[%lu]: ",
+                        (unsigned)(16 * 8 + severity), g_hostname, (unsigned long)seq);
+    if (hlen < 0 || hlen >= (int)sizeof(head)) return;
+
+    if (SLOG_RING - g_ring.size() < (uint32_t)hlen + len + 1) {
+        g_stats.dropped++;
+        return;
+    }
+    for (int i = 0; i < hlen; ++i) g_ring.push(head[i]);
+    for (size_t i = 0; i < len; ++i) {
+        char c = msg[i];
+        g_ring.push(c == '\n' ? ' ' : c);
+    }
+    g_ring.push('\n');
+    g_stats.lines++;
+}
+
+void slog_push(const String &line, LogLevel level) {
+    if (!g_cfg.enabled || (uint8_t)level > (uint8_t)g_cfg.level) return;
+    enqueue(line.c_str(), line.length(), level == LogLevel::INFO ? 6 : 7);
+}
+
+static void pushMetrics() {
+    const MemStats &m = mem_getStats();
+    const CpuSample &cpu = cpu_getSample();
+    uint32_t frames = 0, misses = 0;
+    for (uint8_t i = 0; i < sched_getStepCount(); ++i) {
+        const SchedStep *s = sched_getStep(i);
+        if (s->fn == cdc_sendFrame) { frames = s->runs; misses = s->misses; break; }
+    }
+    char buf[200];
+    int n = snprintf(buf, sizeof(buf),
+                     "[MET] up=%lu heap=%lu minHeap=%lu cpu0=%.1f cpu1=%.1f loopHz=%lu "
+                     "bt=%d frames=%lu misses=%lu ws=%u drop=%lu fail=%lu",
+                     (unsigned long)(millis() / 1000), (unsigned long)m.freeHeap,
+                     (unsigned long)m.minFreeHeap, cpu.load[0], cpu.load[1],
+                     (unsigned long)cpu.loopHz, (int)bt1036_getState(),
+                     (unsigned long)frames, (unsigned long)misses,
+                     (unsigned)btWebUI_getWsStats().clients,
+                     (unsigned long)g_stats.dropped, (unsigned long)g_stats.sendFails);
+    if (n > 0) enqueue(buf, n < (int)sizeof(buf) ? n : sizeof(buf) - 1, 6);
+}
+
+// Следующая строка из кольца в g_carry (если там пусто)
+static bool takeLine() {
+    if (g_carryLen) return true;
+    char c;
+    while (g_carryLen < sizeof(g_carry) && g_ring.pop(c)) {
+        g_carry[g_carryLen++] = c;
+        if (c == '\n') return true;
+    }
+    return g_carryLen > 0;  // строка всегда заканчивается '\n' — сюда не дойдём
+}
+
+static void sendDatagram(uint32_t now) {
+    static char dgram[SLOG_DATAGRAM];
+    uint16_t len = 0, lines = 0;
+    while (takeLine() && len + g_carryLen <= SLOG_DATAGRAM) {
+        memcpy(dgram + len, g_carry, g_carryLen);
+        len += g_carryLen;
+        g_carryLen = 0;
+        lines++;
+    }
+    if (!len) return;
+
+    bool ok = g_udp.beginPacket(g_ip, g_cfg.port) &&
+              g_udp.write((const uint8_t *)dgram, len) == len &&
+              g_udp.endPacket();
+    g_lastSendMs = now;
+    if (ok) {
+        g_stats.datagrams++;
+        g_stats.sentLines += lines;
+        g_stats.bytes += len;
+    } else {
+        g_stats.sendFails++;
+        g_stats.failedLines += lines;
+    }
+}
+
+void slog_poll() {
+    if (!g_cfg.enabled) return;
+    uint32_t now = millis();
+
+    // token bucket: rate датаграмм/с, запас — одна секунда
+    uint32_t cap = (uint32_t)g_cfg.rate * 1000;
+    uint32_t elapsed = now - g_lastRefillMs;
+    if (elapsed > 1000) elapsed = 1000;
+    g_tokensMilli += elapsed * g_cfg.rate;
+    if (g_tokensMilli > cap) g_tokensMilli = cap;
+    g_lastRefillMs = now;
+
+    if (g_cfg.metricsS && now - g_lastMetricsMs >= (uint32_t)g_cfg.metricsS * 1000) {
+        g_lastMetricsMs = now;
+        pushMetrics();
+    }
+
+    if (!g_ipValid || WiFi.status() != WL_CONNECTED) return;  // копим, лишнее — в dropped
+
+    for (uint8_t k = 0; k < SLOG_BURST; ++k) {
+        uint32_t pending = g_ring.size() + g_carryLen;
+        if (!pending) return;
+        if (pending < SLOG_DATAGRAM && now - g_lastSendMs < SLOG_BATCH_MS) return;
+        if (g_tokensMilli < 1000) {
+            if (!g_limited) g_stats.throttled++;
+            g_limited = true;
+            return;
+        }
+        g_limited = false;
+        g_tokensMilli -= 1000;
+        sendDatagram(now);
+    }
+}
+
+void slog_init(const char *hostname) {
+    g_hostname = hostname;
+    Preferences p;
+    p.begin(NVS_NS, true);
+    g_cfg.enabled  = p.getBool("on", false);
+    g_cfg.host     = p.getString("host", "");
+    g_cfg.port     = p.getUShort("port", 514);
+    g_cfg.level    = (LogLevel)p.getUChar("lv", (uint8_t)LogLevel::INFO);
+    g_cfg.rate     = p.getUChar("rate", 10);
+    g_cfg.metricsS = p.getUShort("met", 30);
+    p.end();
+
+    if (g_cfg.level > LogLevel::VERBOSE) g_cfg.level = LogLevel::INFO;
+    if (g_cfg.rate < 1 || g_cfg.rate > 50) g_cfg.rate = 10;
+    g_ipValid = parseHost(g_cfg.host, g_ip);
+    g_lastRefillMs = g_lastMetricsMs = millis();
+    if (g_cfg.enabled) {
+        btWebUI_log("[SYS] Syslog -> " + g_cfg.host + ":" + String(g_cfg.port) +
+                    (g_ipValid ? "" : " (bad address)"), LogLevel::INFO);
+    }
+}
+
+const SyslogConfig &slog_getConfig() {
+    return g_cfg;
+}
+
+bool slog_setConfig(const SyslogConfig &cfg) {
+    IPAddress ip;
+    bool ipValid = parseHost(cfg.host, ip);
+    if (cfg.enabled && (!ipValid || cfg.port == 0)) return false;
+    if (cfg.rate < 1 || cfg.rate > 50 || cfg.level > LogLevel::VERBOSE) return false;
+
+    g_cfg     = cfg;
+    g_ip      = ip;
+    g_ipValid = ipValid;
+    if (!cfg.enabled) {
+        g_ring.clear();
+        g_carryLen = 0;
+    }
+
+    Preferences p;
+    p.begin(NVS_NS, false);
+    p.putBool("on", cfg.enabled);
+    p.putString("host", cfg.host);
+    p.putUShort("port", cfg.port);
+    p.putUChar("lv", (uint8_t)cfg.level);
+    p.putUChar("rate", cfg.rate);
+    p.putUShort("met", cfg.metricsS);
+    p.end();
+
+    if (cfg.enabled) btWebUI_log("[SYS] Syslog ON -> " + cfg.host + ":" + String(cfg.port), LogLevel::INFO);
+    else             btWebUI_log("[SYS] Syslog OFF", LogLevel::INFO);
+    return true;
+}
+
+const SyslogStats &slog_getStats() {
+    return g_stats;
+}
+
+uint32_t slog_buffered() {
+    return g_ring.size() + g_carryLen;
+}
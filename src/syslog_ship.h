@@ -0,0 +1,71 @@
+/**
+ * @file syslog_ship.h
+ * @brief Ships log lines and periodic metrics to a UDP syslog collector
+ *
+ * Meant for the shop: when the STA interface is joined to a local network,
+ * every log line that passes the configured level (plus a "[MET]" metrics
+ * line every metricsS seconds) goes to collector host:port, so history is
+ * kept without a browser tab open.
+ *
+ * Lines are formatted as RFC 3164 messages, facility local0:
+ *     <134>vw-bt fw[1234]: [BT] State: PLAYING
+ * where the PID field is a running line number — a gap on the collector
+ * side is a line dropped here or a datagram lost on the way.
+ *
+ * Never blocks the loop:
+ *   - btWebUI_log() only copies the line into a SLOG_RING byte ring; when
+ *     it doesn't fit the line is dropped and counted;
+ *   - slog_poll() (web step) packs whole lines into datagrams of up to
+ *     SLOG_DATAGRAM bytes, sent when full or SLOG_BATCH_MS after the
+ *     previous one, at most cfg.rate datagrams per second (token bucket);
+ *   - a failed send (lwIP out of buffers) drops that datagram, counted.
+ *
+ * Several lines per datagram, '\n'-separated: tools/syslog_collector.py
+ * splits them; a stock syslogd shows a batch as one message.
+ * Configured on the WiFi page (/api/syslog), stored in NVS "syslog".
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "bt_webui.h"  // LogLevel
+
+static const uint16_t SLOG_RING       = 4096;  // байт очереди строк
+static const uint16_t SLOG_MAX_LINE   = 480;   // длиннее — обрезается
+static const uint16_t SLOG_DATAGRAM   = 1200;  // < MTU: без фрагментации IP
+static const uint32_t SLOG_BATCH_MS   = 500;   // неполная датаграмма уходит не позже
+static const uint8_t  SLOG_BURST      = 2;     // датаграмм за один вызов slog_poll()
+
+struct SyslogConfig {
+    bool     enabled;
+    String   host;       // IPv4 коллектора
+    uint16_t port;       // 514
+    LogLevel level;      // строки этого уровня и важнее
+    uint8_t  rate;       // датаграмм в секунду, 1..50
+    uint16_t metricsS;   // период строки [MET], 0 — выкл.
+};
+
+struct SyslogStats {
+    uint32_t lines;       // строк принято в очередь
+    uint32_t dropped;     // не влезло в очередь (в т.ч. пока нет WiFi)
+    uint32_t datagrams;
+    uint32_t sentLines;
+    uint32_t bytes;
+    uint32_t sendFails;   // датаграмма не ушла (строки потеряны)
+    uint32_t failedLines;
+    uint32_t throttled;   // сколько раз упёрлись в rate
+};
+
+// hostname — поле HOSTNAME сообщений
+void slog_init(const char *hostname);
+
+// Из btWebUI_log(): копия в очередь, без сети
+void slog_push(const String &line, LogLevel level);
+
+// Шаг web: метрики, упаковка, отправка
+void slog_poll();
+
+const SyslogConfig &slog_getConfig();
+// false — host не IPv4 (при enabled) или rate вне 1..50; сохраняет в NVS
+bool slog_setConfig(const SyslogConfig &cfg);
+const SyslogStats &slog_getStats();
+uint32_t slog_buffered();  // байт ждёт отправки
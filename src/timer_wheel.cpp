@@ -0,0 +1,215 @@
+#include "timer_wheel.h"
+#include "bt_webui.h"
+
+static const uint8_t  LEVELS     = 3;
+static const uint8_t  SLOT_BITS  = 6;
+static const uint8_t  SLOTS      = 1 << SLOT_BITS;   // 64
+static const uint32_t SLOT_MASK  = SLOTS - 1;
+static const uint32_t LEVEL_SPAN[LEVELS] = { 1UL << 6, 1UL << 12, 1UL << 18 };
+static const uint8_t  NIL        = 0xFF;
+
+struct Timer {
+    TimerFn  fn;
+    uint32_t expires;   // абсолютный тик
+    uint32_t periodMs;  // 0 = one-shot
+    uint8_t  next;      // двусвязный список слота (индексы пула)
+    uint8_t  prev;
+    uint8_t  level;
+    uint8_t  slot;
+    uint8_t  gen;       // поколение, входит в хэндл
+    bool     active;
+};
+
+static Timer    g_timers[TIMER_MAX];
+static uint8_t  g_slots[LEVELS][SLOTS];   // голова списка
+static uint64_t g_occupied[LEVELS];       // бит на непустой слот
+static uint8_t  g_free    = NIL;          // свободные — через next
+static uint32_t g_now     = 0;            // последний обработанный тик
+static uint8_t  g_active  = 0;
+static uint32_t g_fired   = 0;
+static uint32_t g_exhausted = 0;
+static uint8_t  g_peak    = 0;
+
+static inline TimerId makeId(uint8_t idx) {
+    return (TimerId)(((uint16_t)g_timers[idx].gen << 8) | (uint16_t)(idx + 1));
+}
+
+// Хэндл → индекс пула, NIL если хэндл устарел
+static uint8_t lookup(TimerId id) {
+    if (id == TIMER_NONE) return NIL;
+    uint8_t idx = (uint8_t)((id & 0xFF) - 1);
+    if (idx >= TIMER_MAX) return NIL;
+    const Timer &t = g_timers[idx];
+    if (!t.active || t.gen != (uint8_t)(id >> 8)) return NIL;
+    return idx;
+}
+
+static void link(uint8_t idx) {
+    Timer &t = g_timers[idx];
+    uint32_t delta = t.expires - g_now;
+    if (delta >= LEVEL_SPAN[LEVELS - 1]) {
+        // Дальше горизонта — ждём на последнем уровне, при каскаде перепосчитается
+        delta = LEVEL_SPAN[LEVELS - 1] - 1;
+    }
+    uint8_t level = 0;
+    while (delta >= LEVEL_SPAN[level]) level++;
+    uint32_t at = g_now + delta;
+    uint8_t slot = (uint8_t)((at >> (SLOT_BITS * level)) & SLOT_MASK);
+
+    t.level = level;
+    t.slot  = slot;
+    t.prev  = NIL;
+    t.next  = g_slots[level][slot];
+    if (t.next != NIL) g_timers[t.next].prev = idx;
+    g_slots[level][slot] = idx;
+    g_occupied[level] |= (1ULL << slot);
+}
+
+static void unlink(uint8_t idx) {
+    Timer &t = g_timers[idx];
+    if (t.prev != NIL) g_timers[t.prev].next = t.next;
+    else               g_slots[t.level][t.slot] = t.next;
+    if (t.next != NIL) g_timers[t.next].prev = t.prev;
+    if (g_slots[t.level][t.slot] == NIL) g_occupied[t.level] &= ~(1ULL << t.slot);
+}
+
+static void release(uint8_t idx) {
+    Timer &t = g_timers[idx];
+    t.active = false;
+    t.gen++;
+    t.next = g_free;
+    g_free = idx;
+    g_active--;
+}
+
+void timer_init() {
+    for (uint8_t l = 0; l < LEVELS; ++l) {
+        for (uint8_t s = 0; s < SLOTS; ++s) g_slots[l][s] = NIL;
+        g_occupied[l] = 0;
+    }
+    g_free = NIL;
+    for (int8_t i = TIMER_MAX - 1; i >= 0; --i) {
+        g_timers[i].active = false;
+        g_timers[i].next = g_free;
+        g_free = (uint8_t)i;
+    }
+    g_active = 0;
+    g_now = millis();
+}
+
+TimerId timer_start(TimerFn fn, uint32_t delayMs, uint32_t periodMs) {
+    if (g_free == NIL) {
+        g_exhausted++;
+        btWebUI_log("[TIMER] pool exhausted (" + String(TIMER_MAX) + "), timer not started", LogLevel::INFO);
+        return TIMER_NONE;
+    }
+    uint8_t idx = g_free;
+    Timer &t = g_timers[idx];
+    g_free = t.next;
+
+    t.fn       = fn;
+    t.periodMs = periodMs;
+    t.expires  = millis() + delayMs;
+    // Текущий тик уже обработан — не раньше следующего
+    if ((int32_t)(t.expires - g_now) <= 0) t.expires = g_now + 1;
+    t.active   = true;
+    g_active++;
+    if (g_active > g_peak) g_peak = g_active;
+    link(idx);
+    return makeId(idx);
+}
+
+void timer_cancel(TimerId &id) {
+    uint8_t idx = lookup(id);
+    id = TIMER_NONE;
+    if (idx == NIL) return;
+    unlink(idx);
+    release(idx);
+}
+
+TimerId timer_restart(TimerId &id, TimerFn fn, uint32_t delayMs, uint32_t periodMs) {
+    timer_cancel(id);
+    id = timer_start(fn, delayMs, periodMs);
+    return id;
+}
+
+bool timer_active(TimerId id) {
+    return lookup(id) != NIL;
+}
+
+// Перенести слот старшего уровня на нижние
+static void cascade(uint8_t level, uint8_t slot) {
+    uint8_t idx = g_slots[level][slot];
+    g_slots[level][slot] = NIL;
+    g_occupied[level] &= ~(1ULL << slot);
+    while (idx != NIL) {
+        uint8_t next = g_timers[idx].next;
+        link(idx);
+        idx = next;
+    }
+}
+
+static void expireSlot(uint8_t slot) {
+    // Берём по одному с головы: колбэк может отменить/запустить другие таймеры
+    uint8_t idx;
+    while ((idx = g_slots[0][slot]) != NIL) {
+        Timer &t = g_timers[idx];
+        unlink(idx);
+        TimerFn fn = t.fn;
+        if (t.periodMs) {
+            t.expires += t.periodMs;
+            // Отстали больше чем на период — без пачки пропущенных срабатываний
+            if ((int32_t)(t.expires - g_now) <= 0) t.expires = g_now + t.periodMs;
+            link(idx);
+        } else {
+            release(idx);
+        }
+        g_fired++;
+        if (fn) fn();
+    }
+}
+
+void timer_poll() {
+    uint32_t target = millis();
+    while (g_now != target) {
+        g_now++;
+        uint8_t slot0 = (uint8_t)(g_now & SLOT_MASK);
+        if (slot0 == 0) {
+            uint8_t slot1 = (uint8_t)((g_now >> SLOT_BITS) & SLOT_MASK);
+            if (slot1 == 0) cascade(2, (uint8_t)((g_now >> (2 * SLOT_BITS)) & SLOT_MASK));
+            cascade(1, slot1);
+        }
+        if (g_occupied[0] & (1ULL << slot0)) expireSlot(slot0);
+    }
+}
+
+// Расстояние (в слотах, 1..SLOTS) от текущего до ближайшего занятого слота
+static uint32_t slotsToNext(uint64_t occupied, uint8_t cur) {
+    // Повернуть битмап так, чтобы бит 0 соответствовал слоту cur+1
+    uint8_t  r = (uint8_t)((cur + 1) & SLOT_MASK);
+    uint64_t rot = r ? ((occupied >> r) | (occupied << (SLOTS - r))) : occupied;
+    return (uint32_t)__builtin_ctzll(rot) + 1;
+}
+
+uint32_t timer_msUntilNext() {
+    if (g_active == 0) return UINT32_MAX;
+
+    uint32_t lag = millis() - g_now;  // тики, ещё не обработанные timer_poll()
+    uint32_t best = UINT32_MAX;
+    if (g_occupied[0]) {
+        best = slotsToNext(g_occupied[0], (uint8_t)(g_now & SLOT_MASK));
+    }
+    // Старшие уровни: ближайший каскад — граница текущего блока
+    for (uint8_t l = 1; l < LEVELS; ++l) {
+        if (!g_occupied[l]) continue;
+        uint32_t span = LEVEL_SPAN[l - 1];
+        uint32_t toBoundary = span - (g_now & (span - 1));
+        if (toBoundary < best) best = toBoundary;
+    }
+    return best > lag ? best - lag : 0;
+}
+
+uint8_t  timer_getActiveCount()   { return g_active; }
+uint32_t timer_getFired()         { return g_fired; }
+uint32_t timer_getPoolExhausted() { return g_exhausted; }
+uint8_t  timer_getPeak()          { return g_peak; }
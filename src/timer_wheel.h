@@ -0,0 +1,60 @@
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timer wheel for firmware timeouts and periodic actions
+ *
+ * 1 ms tick, 3 levels × 64 slots (64 ms / 4.1 s / 262 s). Start, cancel and
+ * expiry are O(1); timers live in a fixed pool and are addressed by handles
+ * that carry an 8-bit generation: a stale handle is rejected unless its slot
+ * was reused a multiple of 256 times since (keep handles short-lived and
+ * reset them to TIMER_NONE when the timer fires or is cancelled).
+ * All time arithmetic is on uint32_t ticks and survives millis() wraparound.
+ *
+ * timer_poll() is a scheduler step (see loop_sched.h); callbacks run there,
+ * never from an ISR.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+typedef void (*TimerFn)();
+
+// Хэндл таймера: 0 = нет таймера
+typedef uint16_t TimerId;
+static const TimerId TIMER_NONE = 0;
+
+// Одновременно живут: 6 постоянных (vw_cdc ×2, mem, cpu, session, statPoll),
+// до 7 разовых (таймаут AT-команды, trackLogHold, окно track_sync, play_state,
+// импульсы SCAN/MIX, "Connected") и 3 у стендов isr/ws_bench — 16 в пике.
+// Двойной запас; индекс пула — младший байт хэндла, поэтому не больше 254.
+static const uint8_t TIMER_MAX = 32;
+
+// Вызывать в начале setup()
+void timer_init();
+
+// One-shot (periodMs = 0) или периодический таймер.
+// fn может быть nullptr — тогда таймер только отмеряет интервал (timer_active()).
+// Возвращает TIMER_NONE, если пул исчерпан.
+TimerId timer_start(TimerFn fn, uint32_t delayMs, uint32_t periodMs = 0);
+
+// Остановить; безопасно для TIMER_NONE и уже сработавших таймеров.
+// Обнуляет хэндл, чтобы его нельзя было остановить повторно.
+void timer_cancel(TimerId &id);
+
+// Перезапустить (cancel + start с теми же fn/period)
+TimerId timer_restart(TimerId &id, TimerFn fn, uint32_t delayMs, uint32_t periodMs = 0);
+
+// Таймер запущен и ещё не сработал (периодический — пока не остановлен)
+bool timer_active(TimerId id);
+
+// Продвинуть колесо до millis() и выполнить истёкшие таймеры
+void timer_poll();
+
+// Сколько ms до ближайшего срабатывания (UINT32_MAX — таймеров нет).
+// Для таймеров на дальних уровнях — нижняя граница (момент каскада).
+uint32_t timer_msUntilNext();
+
+// Статистика
+uint8_t  timer_getActiveCount();
+uint32_t timer_getFired();
+uint32_t timer_getPoolExhausted();
+uint8_t  timer_getPeak();          // максимум одновременно активных с загрузки
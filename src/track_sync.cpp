@@ -0,0 +1,99 @@
+#include "track_sync.h"
+#include "timer_wheel.h"
+#include "bt_webui.h"
+
+static const uint32_t STAT_FRESH_MS   = 5000;  // модуль считается "говорящим"
+static const uint32_t RESTART_MAX_SEC = 3;     // elapsed нового трека
+
+static TrackSyncStats        g_stats = {};
+static TrackRollbackCallback g_rollbackCb = nullptr;
+static TimerId               g_window = TIMER_NONE;
+
+static uint8_t  g_baseTrack   = 0;
+static uint32_t g_startMs     = 0;
+static bool     g_verifiable  = false;
+static String   g_snapTitle;
+static uint32_t g_snapInfoSeq = 0;
+static uint32_t g_snapStatSeq = 0;
+static uint32_t g_snapElapsed = 0;
+
+// Для проверки "говорит ли модуль"
+static uint32_t g_seenStatSeq  = 0;
+static uint32_t g_lastStatMs   = 0;
+
+static void finish() {
+    g_stats.pending = false;
+    timer_cancel(g_window);
+    g_snapTitle = "";
+}
+
+static void onWindowExpired() {
+    g_window = TIMER_NONE;
+    if (!g_stats.pending) return;
+    if (g_verifiable) {
+        g_stats.rollbacks++;
+        btWebUI_log("[SYNC] Not confirmed in " + String(TSYNC_CONFIRM_MS) +
+                    "ms, track back to " + String(g_baseTrack), LogLevel::INFO);
+        if (g_rollbackCb) g_rollbackCb(g_baseTrack);
+    } else {
+        g_stats.unverified++;
+    }
+    finish();
+}
+
+static bool confirmed(const TrackInfo &ti) {
+    if (ti.infoSeq != g_snapInfoSeq && ti.title != g_snapTitle) return true;
+    // Без метаданных — только по сбросу времени
+    if (g_snapTitle.length() == 0 && ti.statSeq != g_snapStatSeq &&
+        ti.elapsedSec <= RESTART_MAX_SEC && ti.elapsedSec < g_snapElapsed) return true;
+    return false;
+}
+
+void tsync_setRollbackCallback(TrackRollbackCallback cb) { g_rollbackCb = cb; }
+
+void tsync_begin(uint8_t confirmedTrack, const TrackInfo &ti) {
+    g_stats.presses++;
+    if (!g_stats.pending) {
+        g_stats.batches++;
+        g_stats.pending = true;
+        g_baseTrack   = confirmedTrack;
+        g_startMs     = millis();
+        g_verifiable  = false;
+    }
+    // Подтвердить может свежий TRACKSTAT или смена названия (+TRACKINFO)
+    bool statFresh = g_lastStatMs && (millis() - g_lastStatMs) < STAT_FRESH_MS;
+    if (statFresh || ti.title.length()) g_verifiable = true;
+    // Сравниваем с состоянием на момент последнего нажатия
+    g_snapTitle   = ti.title;
+    g_snapInfoSeq = ti.infoSeq;
+    g_snapStatSeq = ti.statSeq;
+    g_snapElapsed = ti.elapsedSec;
+    if (timer_restart(g_window, onWindowExpired, TSYNC_CONFIRM_MS) == TIMER_NONE) {
+        // Без окна подтверждения не ждём: иначе pending (и удержание времени) навсегда
+        g_stats.unverified++;
+        finish();
+    }
+}
+
+void tsync_poll(const TrackInfo &ti) {
+    if (ti.statSeq != g_seenStatSeq) {
+        g_seenStatSeq = ti.statSeq;
+        g_lastStatMs  = millis();
+    }
+    if (!g_stats.pending || !confirmed(ti)) return;
+
+    uint32_t dt = millis() - g_startMs;
+    g_stats.hits++;
+    g_stats.confirmMsSum += dt;
+    if (dt > g_stats.confirmMsMax) g_stats.confirmMsMax = dt;
+    btWebUI_log("[SYNC] Track change confirmed in " + String(dt) + "ms", LogLevel::DEBUG);
+    finish();
+}
+
+void tsync_cancel() {
+    if (g_stats.pending) finish();
+}
+
+bool tsync_holdTime() { return g_stats.pending; }
+
+const TrackSyncStats &tsync_getStats() { return g_stats; }
@@ -0,0 +1,54 @@
+/**
+ * @file track_sync.h
+ * @brief Optimistic track display with reconciliation against the phone
+ *
+ * NEXT/PREV change the track number on the radio immediately (zero
+ * perceived latency) and hold the time at 00:00. The change is then
+ * confirmed by the module's own reports within TSYNC_CONFIRM_MS:
+ *   - +TRACKINFO with a different title, or
+ *   - for phones without metadata, +TRACKSTAT elapsed restarting near 0.
+ * No confirmation — the phone ignored the command or hit the end of the
+ * playlist — and the track number is rolled back to the last confirmed one.
+ *
+ * The change is verifiable when, at press time, the module was reporting
+ * TRACKSTAT or the current track came with +TRACKINFO metadata (a title).
+ * A phone that does neither can't confirm anything, so the optimistic
+ * number is kept ("unverified").
+ * Rapid presses join one batch; the window restarts on every press.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "bt1036_at.h"
+
+static const uint32_t TSYNC_CONFIRM_MS = 3000;
+
+struct TrackSyncStats {
+    uint32_t batches;        // серий NEXT/PREV (оптимистичных изменений)
+    uint32_t presses;
+    uint32_t hits;           // подтверждено телефоном
+    uint32_t rollbacks;      // откат номера трека
+    uint32_t unverified;     // ни TRACKSTAT, ни метаданных — оставили как есть
+    uint32_t confirmMsSum;   // время до подтверждения (для hits)
+    uint32_t confirmMsMax;
+    bool     pending;
+};
+
+// Откат: вернуть на дисплей последний подтверждённый трек
+typedef void (*TrackRollbackCallback)(uint8_t track);
+void tsync_setRollbackCallback(TrackRollbackCallback cb);
+
+// Сразу после оптимистичного изменения: confirmedTrack — номер до нажатия
+// (для серии нажатий учитывается только первый), ti — текущее от модуля
+void tsync_begin(uint8_t confirmedTrack, const TrackInfo &ti);
+
+// Каждый проход appLoop() в режиме воспроизведения
+void tsync_poll(const TrackInfo &ti);
+
+// Смена режима дисплея (TRACK 80/10) — ожидание больше не имеет смысла
+void tsync_cancel();
+
+// Пока ждём подтверждения, время с модуля (от старого трека) не показываем
+bool tsync_holdTime();
+
+const TrackSyncStats &tsync_getStats();
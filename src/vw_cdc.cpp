@@ -1,6 +1,14 @@
 #include "vw_cdc.h"
+#include "cdc_profile.h"
+#include "dataout_decoder.h"
 #include "bt_webui.h"
+#include "timer_wheel.h"
+#include "mem_governor.h"
+#include "ring_buffer.h"
+#include "loop_sched.h"
+#include "build_config.h"
 #include <SPI.h>
+#include <Preferences.h>
 
 // Флаг debug режима (определён в bt_webui.cpp)
 extern bool g_debugMode;
@@ -34,6 +42,22 @@ static uint8_t g_playSeconds = 0;  // Начинаем с 00:00
 static uint32_t g_lastBtTimeUpdate = 0;  // Когда последний раз получили время от BT
 static uint8_t g_discLoad = 0x2E;     // vwcdpic: StateInitPlay disc announce counter (0x2E=CD1)
 
+// Активный профиль магнитолы (выбирается в cdc_init из NVS / build flag)
+struct CdcProfileOps {
+    CdcProfileId id;
+    const char*  name;
+    uint32_t     framePeriodMs;
+    uint32_t     minFrameGapMs;
+    uint8_t      modeNeutral;
+    void      (*frameStep)();                    // один кадр state machine
+    void      (*pollDecoders)();                 // разбор DataOut импульсов
+    bool      (*validatePacket)(const uint8_t pkt[4]);
+    uint8_t   (*modeByte)(bool scan, bool mix);  // байт 5
+    uint8_t   (*scanByte)(bool scan);            // байт 6
+};
+static const CdcProfileOps *g_profile = nullptr;
+static void updateModeBytes();
+
 // ---------------- Logging Helpers ----------------
 static void cdc_log(const String &s) {
     btWebUI_log("[CDC] " + s);
@@ -46,26 +70,28 @@ static void cdc_log_nec(const String &s) {
 
 // ---------------- RAW PULSE SNIFFER (Кольцевой буфер) ----------------
 // Позволяет видеть "сырые" тайминги в логе, даже если декодер не узнал кнопку
-#define RAW_BUF_SIZE 64
-static volatile uint16_t g_rawBuf[RAW_BUF_SIZE];
-static volatile uint8_t  g_rawHead = 0;
-static uint8_t           g_rawTail = 0;
+#if FW_DEBUG
+static SpscRing<uint16_t, 64> g_rawBuf;  // ISR → loop; при переполнении новые теряются
 
 static void IRAM_ATTR log_raw_pulse(uint32_t dur) {
     if (dur > 60000) dur = 60000;
-    g_rawBuf[g_rawHead] = (uint16_t)dur;
-    g_rawHead = (g_rawHead + 1) % RAW_BUF_SIZE;
+    g_rawBuf.push((uint16_t)dur);
 }
 
 // Отправка накопленных RAW данных в WebUI (вызывается в loop)
 static void processRawLog() {
-    if (g_rawHead == g_rawTail) return; // Пусто
+    if (g_rawBuf.empty()) return; // Пусто
+
+    // Нехватка памяти или никто не подписан на RAW — не собираем строки, просто сбрасываем буфер
+    if (!mem_rawAllowed() || !btWebUI_wsWants(WS_CH_RAW, LogLevel::DEBUG)) {
+        g_rawBuf.clear();
+        return;
+    }
 
     String s = "RAW:";
     int count = 0;
-    while (g_rawHead != g_rawTail) {
-        uint16_t d = g_rawBuf[g_rawTail];
-        g_rawTail = (g_rawTail + 1) % RAW_BUF_SIZE;
+    uint16_t d;
+    while (g_rawBuf.pop(d)) {
         s += " " + String(d);
         count++;
         if (count >= 20) {  // Увеличили до 20 чтобы видеть больше
@@ -76,44 +102,30 @@ static void processRawLog() {
     }
     if (count > 0) cdc_log_nec(s);  // Отправим остаток
 }
-
-// ---------------- VW CDC DataOut Decoder (vwcdpic protocol) ----------------
-// Protocol: Measures LOW pulse duration to determine bit values
-// Packet format: 32 bits = 4 bytes: [0x53] [0x2C] [cmdcode] [~cmdcode]
-// Timing (with ESP32 microsecond precision):
-//   Start bit:  LOW > 3200µs (~4.57ms)
-//   Bit '1':    LOW > 1248µs (~1.77ms)
-//   Bit '0':    LOW < 1248µs (~650µs)
-//   Noise filter: LOW > 256µs minimum
-
-// Thresholds (in microseconds, matching vwcdpic with 32x prescaler)
-static const uint32_t VW_START_THRESHOLD = 3200;  // vwcdpic: 100 * 32µs
-static const uint32_t VW_HIGH_THRESHOLD  = 1248;  // vwcdpic: 39 * 32µs (bit 1)
-static const uint32_t VW_LOW_THRESHOLD   = 256;   // vwcdpic: 8 * 32µs (noise)
-static const uint8_t  VW_PKTSIZE         = 32;    // 32 bits per packet
-
-// Ring buffer for captured packets (24 bytes = 6 packets of 4 bytes)
-#define VW_CAPBUFFER_SIZE 24
-volatile uint8_t vw_capBuffer[VW_CAPBUFFER_SIZE];
-volatile uint8_t vw_capPtr = 0;        // Write pointer
-volatile uint8_t vw_scanPtr = 0;       // Read pointer for parsing
-volatile bool vw_capBusy = false;      // Capturing in progress
-
-// Current bit capture state
-volatile uint8_t vw_capBit = 0;        // Bits remaining in current byte (-8 to 0)
-volatile uint8_t vw_capBitPacket = 0;  // Bits remaining in packet (-32 to 0)
-volatile uint8_t vw_currentByte = 0;   // Byte being assembled
+#else
+static inline void log_raw_pulse(uint32_t) {}
+static inline void processRawLog() {}
+#endif
+
+// ---------------- DataOut Edge Capture ----------------
+// ISR только меряет импульсы (уровень + длительность) и кладёт их в кольцевой
+// буфер. Декодирование (VW DataOut / NEC, см. dataout_decoder.h) — в cdc_loop().
+// Запись: bit31 = уровень импульса (1 = HIGH), bits 0..30 = длительность в µs.
+// Переполнение (loop не успел) — vw_edgeBuf.overflows().
+static SpscRing<uint32_t, 128> vw_edgeBuf;
 
 // Timing measurement
-volatile uint32_t vw_lastFallingEdge = 0;  // Timestamp of last falling edge
-volatile bool vw_measuringLow = false;     // True if currently measuring LOW pulse
+volatile uint32_t vw_lastEdge = 0;            // Timestamp of last edge
+volatile bool vw_haveEdge = false;            // Первый фронт после старта — длительности ещё нет
 
-volatile uint32_t vw_isr_counter = 0;  // ISR invocation counter
+volatile uint32_t vw_isr_counter = 0;  // ISR invocation counter (также для /api/cpu)
+#if FW_DEBUG
 volatile uint32_t vw_falling_edges = 0; // Falling edge counter (for debug)
 volatile uint32_t vw_rising_edges = 0;  // Rising edge counter (for debug)
+#endif
 
 // ISR: Triggered on BOTH edges (CHANGE mode)
-static void IRAM_ATTR vw_dataout_isr() {
+static inline void IRAM_ATTR vw_dataout_edge() {
     vw_isr_counter++;
     
     if (g_dataOutPin < 0) return;
@@ -121,179 +133,147 @@ static void IRAM_ATTR vw_dataout_isr() {
     uint32_t now = micros();
     bool level = digitalRead(g_dataOutPin);
     
-    if (!level) {
-        // FALLING EDGE: Start measuring LOW pulse
-        vw_falling_edges++;
-        vw_lastFallingEdge = now;
-        vw_measuringLow = true;
-    } else {
-        // RISING EDGE: Capture LOW pulse duration
-        vw_rising_edges++;
-        if (!vw_measuringLow) return; // Spurious interrupt
-        
-        uint32_t lowDuration = now - vw_lastFallingEdge;
-        vw_measuringLow = false;
-        
-        // Log ALL pulses including noise (for level shifter debugging)
-        log_raw_pulse(lowDuration);
-        
-        // Also log if very short (might indicate inverted signal)
-        if (lowDuration < 100) {
-            // Extremely short - might be noise or inverted signal
-            return;
-        }
-        
-        // Filter noise (too short)
-        if (lowDuration < VW_LOW_THRESHOLD) {
-            return; // Ignore
-        }
-        
-        // Check for START bit (begins new packet)
-        if (lowDuration >= VW_START_THRESHOLD) {
-            vw_capBusy = true;
-            vw_capBitPacket = VW_PKTSIZE;  // Reset to 32 bits
-            vw_capBit = 8;                 // Start fresh byte
-            vw_currentByte = 0;
-            // NOTE: НЕ вызываем cdc_log_nec() здесь - String запрещён в ISR!
-            return; // Don't store start bit itself
-        }
-        
-        // Only capture data if we're in a packet
-        if (!vw_capBusy || vw_capBitPacket == 0) {
-            return;
-        }
-        
-        // Determine bit value from LOW duration
-        uint8_t bitValue = (lowDuration >= VW_HIGH_THRESHOLD) ? 1 : 0;
-        
-        // Shift bit into current byte - vwcdpic uses rlf (rotate left)
-        // New bit goes to LSB, byte shifts left
-        vw_currentByte <<= 1;
-        if (bitValue) {
-            vw_currentByte |= 0x01;
-        }
-        
-        vw_capBit--;
-        vw_capBitPacket--;
-        
-        // Byte complete?
-        if (vw_capBit == 0) {
-            // Store byte in ring buffer
-            vw_capBuffer[vw_capPtr] = vw_currentByte;
-            vw_capPtr = (vw_capPtr + 1) % VW_CAPBUFFER_SIZE;
-            
-            // Prepare for next byte
-            vw_capBit = 8;
-            vw_currentByte = 0;
-        }
-        
-        // Packet complete?
-        if (vw_capBitPacket == 0) {
-            vw_capBusy = false;
-            // NOTE: Логирование перенесено в cdc_pollNec() - String запрещён в ISR!
-        }
+    // Закончился импульс противоположного уровня
+    bool pulseHigh = !level;
+    uint32_t dur = now - vw_lastEdge;
+    vw_lastEdge = now;
+
+#if FW_DEBUG
+    if (level) vw_rising_edges++;
+    else       vw_falling_edges++;
+#endif
+
+    if (!vw_haveEdge) {
+        vw_haveEdge = true;
+        return;
     }
+
+    // Log ALL LOW pulses including noise (for level shifter debugging)
+    if (!pulseHigh) log_raw_pulse(dur);
+
+    if (dur > 0x7FFFFFFF) dur = 0x7FFFFFFF;
+    vw_edgeBuf.push(dur | (pulseHigh ? 0x80000000UL : 0));
+    // NOTE: String запрещён в ISR — всё логирование в cdc_pollNec()
 }
 
-// ---------------- VW Packet Parser ----------------
-// Scans ring buffer for valid packets: [0x53] [0x2C] [cmdcode] [~cmdcode]
-// Validation: byte1=0x53, byte2=0x2C, byte3+byte4=0xFF, byte3 multiple of 4
+// Время в ISR (такты CPU, накопительно) — для /api/cpu
+static volatile uint32_t vw_isrCycles = 0;
 
-static void vw_scanCommandBytes() {
-    // Search for 0x53 0x2C packet start
-    while (vw_scanPtr != vw_capPtr) {
-        uint8_t byte1 = vw_capBuffer[vw_scanPtr];
-        
-        if (byte1 != 0x53) {
-            vw_scanPtr = (vw_scanPtr + 1) % VW_CAPBUFFER_SIZE;
-            continue;
-        }
-        
-        // Check if we have at least 4 bytes available
-        uint8_t available = (vw_capPtr >= vw_scanPtr) ? 
-                           (vw_capPtr - vw_scanPtr) : 
-                           (VW_CAPBUFFER_SIZE - vw_scanPtr + vw_capPtr);
-        
-        if (available < 4) {
-            return; // Wait for more data
-        }
-        
-        // Read full packet
-        uint8_t byte2 = vw_capBuffer[(vw_scanPtr + 1) % VW_CAPBUFFER_SIZE];
-        uint8_t byte3 = vw_capBuffer[(vw_scanPtr + 2) % VW_CAPBUFFER_SIZE];
-        uint8_t byte4 = vw_capBuffer[(vw_scanPtr + 3) % VW_CAPBUFFER_SIZE];
-        
-        // Validate packet
-        if (byte2 != 0x2C) {
-            vw_scanPtr = (vw_scanPtr + 1) % VW_CAPBUFFER_SIZE;
-            continue;
-        }
-        
-        // Check byte3 + byte4 = 0xFF
-        if ((uint8_t)(byte3 + byte4) != 0xFF) {
-            cdc_log_nec("VW: Invalid checksum: " + String(byte3, HEX) + " + " + String(byte4, HEX));
-            vw_scanPtr = (vw_scanPtr + 1) % VW_CAPBUFFER_SIZE;
-            continue;
-        }
-        
-        // Check byte3 is multiple of 4 (vwcdpic requirement)
-        if ((byte3 & 0x03) != 0) {
-            cdc_log_nec("VW: cmdcode not multiple of 4: " + String(byte3, HEX));
-            vw_scanPtr = (vw_scanPtr + 1) % VW_CAPBUFFER_SIZE;
-            continue;
-        }
-        
-        // Valid packet found!
-        uint8_t cmdcode = byte3;
-        // Логируем команды только в debug режиме
-        if (g_debugMode) {
-            cdc_log_nec("VW CMD: 0x" + String(cmdcode, HEX) + " (53 2C " + 
-                        String(byte3, HEX) + " " + String(byte4, HEX) + ")");
+static void IRAM_ATTR vw_dataout_isr() {
+    uint32_t c0 = ESP.getCycleCount();
+    vw_dataout_edge();
+    vw_isrCycles += ESP.getCycleCount() - c0;
+}
+
+// ---------------- Decoders ----------------
+// Склейка LOW, разорванных иголкой HIGH короче этого порога (0 = выкл.);
+// NVS "cdc"/"deglitch" переопределяет. Настоящий HIGH у VW/NEC ≥ ~500µs.
+#ifndef CDC_DEGLITCH_US
+#define CDC_DEGLITCH_US 80
+#endif
+
+static PulseDeglitcher   g_deglitch;
+static VwDataOutDecoder  g_vwDecoder;
+static NecDecoder        g_necDecoder;
+static DataOutDecoderMux g_decoders;
+
+#if FW_DEBUG
+static uint32_t IRAM_ATTR cycleClock() {
+    return ESP.getCycleCount();
+}
+#endif
+
+// ---------------- VW Packet Handling ----------------
+// Packet: [ADDR1] [ADDR2] [cmdcode] [~cmdcode] (NEC уже приведён к порядку бит VW)
+// Validation: byte1/byte2 = адрес профиля, byte3+byte4=0xFF, byte3 multiple of 4
+// Инстанцируется для каждого профиля (cdc_profile.h), без ветвлений по профилю внутри.
+
+template <class P>
+static bool vw_validatePacket(const uint8_t pkt[4]) {
+    if (pkt[0] != P::DATAOUT_ADDR1 || pkt[1] != P::DATAOUT_ADDR2) return false;
+
+    // Check byte3 + byte4 = 0xFF
+    if ((uint8_t)(pkt[2] + pkt[3]) != 0xFF) {
+        cdc_log_nec("VW: Invalid checksum: " + String(pkt[2], HEX) + " + " + String(pkt[3], HEX));
+        return false;
+    }
+
+    // Check byte3 is multiple of 4 (vwcdpic requirement)
+    if ((pkt[2] & 0x03) != 0) {
+        cdc_log_nec("VW: cmdcode not multiple of 4: " + String(pkt[2], HEX));
+        return false;
+    }
+    return true;
+}
+
+template <class P>
+static void vw_handlePacket(const uint8_t pkt[4], uint8_t source) {
+    uint8_t cmdcode = pkt[2];
+    // Логируем команды только в debug режиме (и если RAW канал кому-то нужен)
+    if (g_debugMode && btWebUI_wsWants(WS_CH_RAW, LogLevel::DEBUG)) {
+        cdc_log_nec("VW CMD: 0x" + String(cmdcode, HEX) + " (" +
+                    String(pkt[0], HEX) + " " + String(pkt[1], HEX) + " " +
+                    String(pkt[2], HEX) + " " + String(pkt[3], HEX) + ") via " +
+                    g_decoders.decoder(source)->name());
+    }
+    
+    // Map to button - таблица кодов профиля
+    CdcButton btn = P::decode(cmdcode);
+    
+    // Debounce: игнорируем повторы той же кнопки в течение DEBOUNCE_MS
+    // cppcheck-suppress variableScope  ; static needed to persist across calls
+    static CdcButton lastBtn = CdcButton::UNKNOWN;
+    // cppcheck-suppress variableScope  ; static needed to persist across calls
+    static uint32_t lastBtnTime = 0;
+    uint32_t now = millis();
+    
+    if (g_btnCb && btn != CdcButton::UNKNOWN) {
+        if (btn != lastBtn || (now - lastBtnTime) > P::DEBOUNCE_MS) {
+            lastBtn = btn;
+            lastBtnTime = now;
+            g_btnCb(btn);
+        } else if (g_debugMode) {
+            cdc_log("Button debounced: " + String((int)btn));
         }
-        
-        // Map to button - РЕАЛЬНЫЕ КОДЫ от RNS-MFD
-        CdcButton btn = CdcButton::UNKNOWN;
-        switch (cmdcode) {
-            // Треки
-            case 0xF8: btn = CdcButton::NEXT_TRACK; break;
-            case 0x78: btn = CdcButton::PREV_TRACK; break;
-            
-            // CD кнопки (коды подтверждены RAW логами)
-            case 0x0C: btn = CdcButton::DISC_1; break;
-            case 0x8C: btn = CdcButton::DISC_2; break;
-            case 0x4C: btn = CdcButton::DISC_3; break;
-            case 0xCC: btn = CdcButton::DISC_4; break;
-            case 0x2C: btn = CdcButton::DISC_5; break;  // Подтверждено
-            case 0xAC: btn = CdcButton::DISC_6; break;  // Подтверждено
-            
-            // Функции
-            case 0xA0: btn = CdcButton::SCAN_TOGGLE; break;
-            case 0xE0: btn = CdcButton::RANDOM_TOGGLE; break;
-            
-            // Игнорируем служебные коды
-            case 0x14: break;  // Repeat-код (игнор)
-            case 0x38: break;  // CD confirm (игнор)
+    }
+}
+
+template <class P>
+static void vw_feedDecoders(const PulseDeglitcher::Pulse *p, uint8_t n) {
+    for (uint8_t i = 0; i < n; ++i) {
+        uint8_t pkt[4];
+        uint8_t source = 0;
+        if (g_decoders.feed(p[i].level, p[i].us, pkt, source)) {
+            vw_handlePacket<P>(pkt, source);
         }
-        
-        // Debounce: игнорируем повторы той же кнопки в течение 300мс
-        // cppcheck-suppress variableScope  ; static needed to persist across calls
-        static CdcButton lastBtn = CdcButton::UNKNOWN;
-        // cppcheck-suppress variableScope  ; static needed to persist across calls
-        static uint32_t lastBtnTime = 0;
-        uint32_t now = millis();
-        
-        if (g_btnCb && btn != CdcButton::UNKNOWN) {
-            if (btn != lastBtn || (now - lastBtnTime) > 300) {
-                lastBtn = btn;
-                lastBtnTime = now;
-                g_btnCb(btn);
-            } else if (g_debugMode) {
-                cdc_log("Button debounced: " + String((int)btn));
-            }
+    }
+}
+
+// Разбор накопленных импульсов всеми декодерами
+template <class P>
+static void vw_pollDecoders() {
+    int8_t lockedBefore = g_decoders.locked();
+
+    PulseDeglitcher::Pulse p[3];
+    uint8_t n;
+    uint32_t e;
+    while (vw_edgeBuf.pop(e)) {
+        n = g_deglitch.feed((e & 0x80000000UL) != 0, e & 0x7FFFFFFF, p);
+        vw_feedDecoders<P>(p, n);
+    }
+
+    // Линия уже дольше порога в HIGH — отложенный LOW окончательный
+    // (иначе последний бит пакета ждал бы следующего фронта)
+    if (g_deglitch.pending() && g_dataOutPin >= 0) {
+        uint32_t last = vw_lastEdge;
+        if (digitalRead(g_dataOutPin) && vw_edgeBuf.empty()) {
+            n = g_deglitch.flushIdle(micros() - last, p);
+            vw_feedDecoders<P>(p, n);
         }
-        
-        // Advance scan pointer past this packet
-        vw_scanPtr = (vw_scanPtr + 4) % VW_CAPBUFFER_SIZE;
+    }
+
+    if (g_decoders.locked() != lockedBefore && g_decoders.locked() >= 0) {
+        cdc_log("DataOut protocol locked: " + String(g_decoders.decoder(g_decoders.locked())->name()));
     }
 }
 
@@ -301,8 +281,58 @@ static void cdc_pollNec() {
     // Send raw logs
     processRawLog();
 
-    // Scan ring buffer for valid VW packets
-    vw_scanCommandBytes();
+    // Decode captured pulses (VW DataOut + NEC in parallel)
+    g_profile->pollDecoders();
+}
+
+// Состояния state machine кадров (см. cdc_frameStep ниже)
+enum CdcFrameState { ST_IDLE_THEN_PLAY, ST_INIT_PLAY, ST_PLAY_LEAD_IN, ST_PLAY };
+static CdcFrameState g_frameState = ST_IDLE_THEN_PLAY;
+
+// ---------------- SPI TX Readback (loopback) ----------------
+// Опционально: перемычка MOSI → свободный вход, который передаётся в cdc_init()
+// как misoPin. SPI full-duplex читает обратно каждый отправленный байт,
+// сравниваем с тем, что хотели отправить.
+static CdcBusStats g_busStats;
+static uint16_t    g_busBurst = 0;  // текущая серия подряд битых кадров
+
+static void busCheckFrame(const uint8_t tx[8], const uint8_t rx[8]) {
+    uint8_t badBytes = 0;
+    uint8_t badBits = 0;
+    for (int i = 0; i < 8; ++i) {
+        uint8_t diff = tx[i] ^ rx[i];
+        if (diff) {
+            badBytes++;
+            badBits += __builtin_popcount(diff);
+        }
+    }
+
+    g_busStats.framesChecked++;
+    if (badBytes == 0) {
+        if (g_busBurst > 0) {
+            cdc_log("Bus: error burst ended after " + String(g_busBurst) + " frames");
+        }
+        g_busBurst = 0;
+        return;
+    }
+
+    g_busStats.framesCorrupted++;
+    g_busStats.byteErrors += badBytes;
+    g_busStats.bitErrors += badBits;
+    g_busStats.errorsByState[g_frameState]++;
+    g_busStats.lastErrorMs = millis();
+
+    if (g_busBurst == 0) {
+        g_busStats.bursts++;
+        // Первый битый кадр серии — в лог с расшифровкой (дальше только счётчики)
+        String hex = "Bus: TX/RX mismatch:";
+        for (int i = 0; i < 8; ++i) {
+            hex += " " + String(tx[i], HEX) + "/" + String(rx[i], HEX);
+        }
+        cdc_log(hex);
+    }
+    g_busBurst++;
+    if (g_busBurst > g_busStats.longestBurst) g_busStats.longestBurst = g_busBurst;
 }
 
 // ---------------- SPI Functions ----------------
@@ -311,6 +341,21 @@ static inline uint8_t fromBCD(uint8_t bcd) {
     return ((bcd >> 4) * 10) + (bcd & 0x0F);
 }
 
+// Отправка одного 8-байтного кадра с таймингом профиля
+template <class P>
+static void spiSendFrame(const uint8_t frame[8]) {
+    uint8_t rx[8];
+    g_spi->beginTransaction(SPISettings(P::SPI_HZ, MSBFIRST, SPI_MODE1));
+    for (int i = 0; i < 8; ++i) {
+        rx[i] = g_spi->transfer(frame[i]);
+        delayMicroseconds(P::BYTE_GAP_US);
+    }
+    g_spi->endTransaction();
+
+    if (g_busStats.enabled) busCheckFrame(frame, rx);
+}
+
+template <class P>
 static void cdc_sendPackage(const uint8_t frame[8]) {
     // Логируем ВСЕ отправляемые пакеты для диагностики
     String hex = "SPI TX: ";
@@ -321,7 +366,7 @@ static void cdc_sendPackage(const uint8_t frame[8]) {
     
     // Расшифровка пакета (track и время в BCD!)
     uint8_t cmd = frame[0];
-    if (cmd == 0x34) {
+    if (cmd == P::CMD_PLAY) {
         uint8_t disc = 0xBF - frame[1];
         uint8_t trackBCD = 0xFF - frame[2];
         uint8_t minBCD = 0xFF - frame[3];
@@ -329,42 +374,388 @@ static void cdc_sendPackage(const uint8_t frame[8]) {
         // Конвертируем BCD обратно в десятичные для читаемого лога
         hex += "→ PLAY CD" + String(disc) + " T" + String(fromBCD(trackBCD)) + 
                " " + String(fromBCD(minBCD)) + ":" + String(fromBCD(secBCD));
-    } else if (cmd == 0x74) {
+    } else if (cmd == P::CMD_IDLE) {
         hex += "→ IDLE";
     }
     cdc_log(hex);
     
-    g_spi->beginTransaction(SPISettings(62500, MSBFIRST, SPI_MODE1));
-    for (int i = 0; i < 8; ++i) {
-        g_spi->transfer(frame[i]);
-        delayMicroseconds(874);
+    spiSendFrame<P>(frame);
+}
+
+// ---------------- Frame State Machine ----------------
+// vwcdpic state machine: StateIdleThenPlay → StateInitPlay → StatePlayLeadIn → StatePlay
+// Один шаг = один кадр; шаблон инстанцируется для каждого профиля.
+
+template <class P>
+static void cdc_frameStep() {
+    // cppcheck-suppress variableScope  ; static needed for state machine persistence
+    static int stateCounter = 0;  // BIDIcount equivalent (negative countdown)
+    // cppcheck-suppress variableScope  ; static needed for state machine persistence
+    static bool initStarted = false;
+
+    uint8_t disc = g_status.disc; if(disc<1) disc=1; if(disc>6) disc=6;
+    uint8_t track = g_status.track; if(track<1) track=1; if(track>99) track=99;
+    
+    if (!initStarted) {
+        initStarted = true;
+        cdc_log("=== CDC Init [" + String(P::name()) + "]: StateIdleThenPlay (" +
+                String(P::IDLE_THEN_PLAY_PACKETS) + " packets) ===");
+        g_frameState = ST_IDLE_THEN_PLAY;
+        stateCounter = -P::IDLE_THEN_PLAY_PACKETS;  // vwcdpic: BIDIcount = -20
+    }
+    
+    // ====== STATE: IdleThenPlay (vwcdpic lines 2203-2212) ======
+    if (g_frameState == ST_IDLE_THEN_PLAY) {
+        // Send IDLE packet: 74 BE FE FF FF FF 8F 7C
+        uint8_t idle[8] = {
+            P::CMD_IDLE, 
+            (uint8_t)(0xBF - disc),
+            (uint8_t)(0xFF - track),
+            0xFF, 0xFF, 0xFF,  // vwcdpic uses 0xFF for mode in IDLE
+            P::IDLE_BYTE6, P::IDLE_TRAILER
+        };
+        
+        if (stateCounter >= -5 || (stateCounter % 5) == 0) {  // Log first 5 and every 5th
+            String hex = "[IdleThenPlay " + String(-stateCounter) + "/" +
+                         String(P::IDLE_THEN_PLAY_PACKETS) + "] ";
+            for(int i=0; i<8; i++) {
+                if (idle[i] < 0x10) hex += "0";
+                hex += String(idle[i], HEX) + " ";
+            }
+            cdc_log(hex);
+        }
+        
+        spiSendFrame<P>(idle);
+        
+        stateCounter++;
+        if (stateCounter >= 0) {  // incfsz BIDIcount, f → goto StateIdle (then call SetStateInitPlay)
+            cdc_log("=== Transition: StateInitPlay (" + String(P::INIT_PLAY_PACKETS) + " packets) ===");
+            g_frameState = ST_INIT_PLAY;
+            stateCounter = -P::INIT_PLAY_PACKETS;  // vwcdpic: BIDIcount = -24
+            g_discLoad = P::DISCLOAD_FIRST;        // vwcdpic: discload = 0x2E (CD1 announce)
+        }
+    }
+    
+    // ====== STATE: InitPlay (vwcdpic lines 2226-2268) ======
+    else if (g_frameState == ST_INIT_PLAY) {
+        // Alternating packets: odd=announce CD info, even=normal display
+        // btfss BIDIcount, 0 → goto StateInitPlayAnnounceCD (bit 0 clear = even counter)
+        bool isAnnounce = ((stateCounter & 1) == 0);  // Even countdown = announce
+        
+        if (isAnnounce) {
+            // StateInitPlayAnnounceCD: 34 2E XX XX XX B7 FF 3C
+            // Sends CD info with discload cycling 0x2E→0x2D→...→0x29→0x2E
+            uint8_t frame[8] = {
+                P::CMD_PLAY,
+                g_discLoad,  // 0x29..0x2F = AUDIO CD Loaded
+                0xFF - 0x99, // 99 tracks
+                0xFF - 0x99, // 99 minutes  
+                0xFF - 0x59, // 59 seconds
+                P::ANNOUNCE_MODE,
+                0xFF,
+                P::TRAILER
+            };
+            
+            if (stateCounter >= -5) {  // Log first few
+                String hex = "[InitPlay-Announce " + String(-stateCounter) + "/" +
+                             String(P::INIT_PLAY_PACKETS) + "] discload=";
+                hex += String(g_discLoad, HEX) + " → ";
+                for(int i=0; i<8; i++) {
+                    if (frame[i] < 0x10) hex += "0";
+                    hex += String(frame[i], HEX) + " ";
+                }
+                cdc_log(hex);
+            }
+            
+            spiSendFrame<P>(frame);
+            
+            // Cycle discload: 0x29 → reached CD6? → 0x2E : decf discload
+            if (g_discLoad == P::DISCLOAD_LAST) {
+                g_discLoad = P::DISCLOAD_FIRST;  // Loop back to CD1
+            } else {
+                g_discLoad--;  // 0x2E→0x2D→0x2C→0x2B→0x2A→0x29
+            }
+        }
+        else {
+            // Normal packet: 34 BE FE FF FF FF EF 3C
+            uint8_t frame[8] = {
+                P::CMD_PLAY,
+                (uint8_t)(0xBF - disc),
+                (uint8_t)(0xFF - track),
+                0xFF, 0xFF, 0xFF,  // minute/second/mode all 0xFF during init
+                P::MUTE_INIT,      // vwcdpic init mute byte
+                P::TRAILER
+            };
+            
+            if (stateCounter >= -5) {
+                String hex = "[InitPlay-Normal " + String(-stateCounter) + "/" +
+                             String(P::INIT_PLAY_PACKETS) + "] ";
+                for(int i=0; i<8; i++) {
+                    if (frame[i] < 0x10) hex += "0";
+                    hex += String(frame[i], HEX) + " ";
+                }
+                cdc_log(hex);
+            }
+            
+            spiSendFrame<P>(frame);
+        }
+        
+        stateCounter++;
+        if (stateCounter >= 0) {  // incfsz → goto SetStatePlayLeadIn
+            cdc_log("=== Transition: StatePlayLeadIn (" + String(P::LEAD_IN_PACKETS) + " packets) ===");
+            g_frameState = ST_PLAY_LEAD_IN;
+            stateCounter = -P::LEAD_IN_PACKETS;
+            // vwcdpic: sets time 0xFF here (already initialized)
+        }
+    }
+    
+    // ====== STATE: PlayLeadIn (vwcdpic lines 2278-2303) ======
+    else if (g_frameState == ST_PLAY_LEAD_IN) {
+        // Alternating announce/normal like InitPlay but different mute byte
+        bool isAnnounce = ((stateCounter & 1) == 0);
+        
+        if (isAnnounce) {
+            // StatePlayLeadInAnnounceCD: disc's lower nibble | 0x20
+            uint8_t frame[8] = {
+                P::CMD_PLAY,
+                (uint8_t)((disc & 0x0F) | 0x20),  // vwcdpic: andlw 0x0F; iorlw 0x20
+                0xFF - 0x99,
+                0xFF - 0x99,
+                0xFF - 0x59,
+                P::ANNOUNCE_MODE,
+                0xFF,
+                P::TRAILER
+            };
+            
+            spiSendFrame<P>(frame);
+        }
+        else {
+            // Normal: 34 BE FE FF FF FF AE 3C
+            uint8_t frame[8] = {
+                P::CMD_PLAY,
+                (uint8_t)(0xBF - disc),
+                (uint8_t)(0xFF - track),
+                0xFF, 0xFF, 0xFF,
+                P::MUTE_LEAD_IN,  // PlayLeadIn mute byte
+                P::TRAILER
+            };
+            
+            spiSendFrame<P>(frame);
+        }
+        
+        stateCounter++;
+        if (stateCounter >= 0) {
+            cdc_log("=== Transition: StatePlay (normal operation) ===");
+            g_frameState = ST_PLAY;
+            // Start time from 00:00 (vwcdpic increments 0xFF→0x00→0x01...)
+        }
+    }
+    
+    // ====== STATE: Play (vwcdpic lines 2329-2340) ======
+    else if (g_frameState == ST_PLAY) {
+        // StatePlay: 34 BE FE MM SS FB CF 3C (continuous)
+        // Track и время в BCD формате!
+        uint8_t trackBCD = toBCD(track);
+        uint8_t minBCD = toBCD(g_playMinutes);
+        uint8_t secBCD = toBCD(g_playSeconds);
+        
+        uint8_t frame[8] = {
+            P::CMD_PLAY,
+            (uint8_t)(0xBF - disc),
+            (uint8_t)(0xFF - trackBCD),
+            (uint8_t)(0xFF - minBCD),
+            (uint8_t)(0xFF - secBCD),
+            g_modeByte,  // Байт 5: SCAN/MIX (таблица профиля)
+            g_scanByte,  // Байт 6: SCAN (таблица профиля)
+            P::TRAILER
+        };
+        
+#if FW_DEBUG
+        // Логируем [PLAY] только в debug режиме
+        if (g_debugMode) {
+            static int playCount = 0;
+            playCount++;
+            if (playCount <= 10 || playCount % 20 == 0) {  // Log first 10, then every second
+                String hex = "[PLAY] ";
+                for(int i=0; i<8; i++) {
+                    if (frame[i] < 0x10) hex += "0";
+                    hex += String(frame[i], HEX) + " ";
+                }
+                hex += "→ CD" + String(disc) + " T" + String(track) + " ";
+                // Время всегда показываем (начинаем с 00:00)
+                if (g_playMinutes < 10) hex += "0";
+                hex += String(g_playMinutes) + ":";
+                if (g_playSeconds < 10) hex += "0";
+                hex += String(g_playSeconds);
+                cdc_log(hex);
+            }
+        }
+#endif
+        
+        spiSendFrame<P>(frame);
+    }
+}
+
+// ---------------- Profile Selection ----------------
+// Таблица инстанцированных профилей. Выбор делается один раз в cdc_init(),
+// дальше cdc_loop() только вызывает функции через указатели.
+template <class P>
+static CdcProfileOps makeOps() {
+    CdcProfileOps ops = {
+        P::ID,
+        P::name(),
+        P::FRAME_PERIOD_MS,
+        P::MIN_FRAME_GAP_MS,
+        P::MODE_NEUTRAL,
+        &cdc_frameStep<P>,
+        &vw_pollDecoders<P>,
+        &vw_validatePacket<P>,
+        &P::modeByte,
+        &P::scanByte
+    };
+    return ops;
+}
+
+#ifdef CDC_PROFILE_FIXED
+static const CdcProfileOps g_profiles[] = {
+#if CDC_PROFILE_FIXED == 1
+    makeOps<CdcProfileGamma>()
+#elif CDC_PROFILE_FIXED == 2
+    makeOps<CdcProfileSkoda>()
+#else
+    makeOps<CdcProfileRnsMfd>()
+#endif
+};
+#else
+// Порядок = CdcProfileId
+static const CdcProfileOps g_profiles[CDC_PROFILE_COUNT] = {
+    makeOps<CdcProfileRnsMfd>(),
+    makeOps<CdcProfileGamma>(),
+    makeOps<CdcProfileSkoda>()
+};
+#endif
+
+static const CdcProfileOps *findProfile(uint8_t id) {
+    for (size_t i = 0; i < sizeof(g_profiles) / sizeof(g_profiles[0]); ++i) {
+        if ((uint8_t)g_profiles[i].id == id) return &g_profiles[i];
+    }
+    return nullptr;
+}
+
+static void cdc_loadProfile() {
+    Preferences p;
+    p.begin("cdc", true);
+    uint8_t id = p.getUChar("profile", CDC_DEFAULT_PROFILE);
+    p.end();
+
+    g_profile = findProfile(id);
+    if (!g_profile) {
+        cdc_log("Profile " + String(id) + " not compiled in, using " + String(g_profiles[0].name));
+        g_profile = &g_profiles[0];
+    }
+}
+
+// ---------------- Event frames ----------------
+// Смена трека / SCAN / MIX уходит внеочередным кадром, не дожидаясь слота
+// 50 мс (не раньше MIN_FRAME_GAP_MS после прошлого кадра). Задержка
+// "сеттер → начало кадра" меряется всегда — и с внеочередными кадрами,
+// и без них (cdc_setEventFrames(false) — как было).
+static bool            g_eventFrames = true;
+static bool            g_displayDirty = false;
+static uint32_t        g_dirtySinceUs = 0;
+static CdcLatencyStats g_latency;
+
+static void markDisplayDirty() {
+    if (g_frameState != ST_PLAY || !g_profile) return;  // старт: кадры по счётчикам vwcdpic
+    if (!g_displayDirty) {
+        g_displayDirty = true;
+        g_dirtySinceUs = micros();
+    }
+    if (g_eventFrames && sched_expedite(cdc_sendFrame, g_profile->minFrameGapMs * 1000)) {
+        g_latency.expedited++;
     }
-    g_spi->endTransaction();
+}
+
+static void recordLatency(uint32_t us) {
+    uint32_t bin = us / 1000;
+    if (bin >= CDC_LAT_BINS) bin = CDC_LAT_BINS - 1;
+    g_latency.hist[bin]++;
+    g_latency.changes++;
+    g_latency.sumUs += us;
+    if (us > g_latency.maxUs) g_latency.maxUs = us;
 }
 
 // ---------------- Init / Loop ----------------
+#if FW_DEBUG
+// Debug: ISR counters every 5 seconds (only in debug mode)
+static void logIsrCounters() {
+    if (!g_debugMode) return;
+    cdc_log("VW ISR: total=" + String(vw_isr_counter) + 
+            " fall=" + String(vw_falling_edges) + 
+            " rise=" + String(vw_rising_edges) + 
+            " | edges in:" + String(vw_edgeBuf.pushed()) + " out:" + String(vw_edgeBuf.popped()) +
+            " ovf=" + String(vw_edgeBuf.overflows()));
+}
+#endif
+
+// Инкремент времени каждую секунду (только если НЕ получаем от BT)
+// Если BT присылает TRACKSTAT, используем его время, иначе считаем сами
+static void countPlaySecond() {
+    uint32_t now = millis();
+    bool btTimeActive = (g_lastBtTimeUpdate > 0) && ((now - g_lastBtTimeUpdate) < 3000);
+    
+    if (!btTimeActive && g_frameState == ST_PLAY && g_status.state == CdcPlayState::PLAYING) {
+        g_playSeconds++;
+        if (g_playSeconds >= 60) {
+            g_playSeconds = 0;
+            g_playMinutes++;
+            if (g_playMinutes >= 100) g_playMinutes = 0;
+        }
+    }
+}
+
 void cdc_init(int sckPin, int misoPin, int mosiPin, int ssPin, int necPin, CdcButtonCallback cb) {
     g_sckPin = sckPin; g_misoPin = misoPin; g_mosiPin = mosiPin; g_ssPin = ssPin;
     g_btnCb = cb;
     g_status.disc = 1; g_status.track = 1; g_status.state = CdcPlayState::PLAYING;
 
+    cdc_loadProfile();
+    updateModeBytes();
+    cdc_log("Head unit profile: " + String(g_profile->name));
+
     g_spi->begin(g_sckPin, g_misoPin, g_mosiPin, g_ssPin);
     cdc_log("SPI initialized: SCK=" + String(g_sckPin) + 
             " MISO=" + String(g_misoPin) + " MOSI=" + String(g_mosiPin));
 
+    // MISO задан → это loopback-вход (перемычка с MOSI), включаем самоконтроль
+    g_busStats = CdcBusStats();
+    g_busStats.enabled = (g_misoPin >= 0);
+    if (g_busStats.enabled) {
+        cdc_log("SPI TX readback enabled (MOSI looped back to GPIO" + String(g_misoPin) + ")");
+    }
+
     // NEC decoder на отдельном пине (не MISO!)
     g_dataOutPin = necPin;
     
-    // Инициализируем VW протокол
-    vw_capPtr = 0;
-    vw_scanPtr = 0;
-    vw_capBusy = false;
-    vw_capBit = 8;
-    vw_capBitPacket = 0;
-    vw_currentByte = 0;
-    vw_measuringLow = false;
-    vw_lastFallingEdge = 0;
+    // Декодеры DataOut: оба протокола параллельно, автоопределение
+    vw_edgeBuf.reset();
+    vw_haveEdge = false;
     vw_isr_counter = 0;
+    if (g_decoders.count() == 0) {
+        g_decoders.add(&g_vwDecoder);
+        g_decoders.add(&g_necDecoder);
+    }
+    g_decoders.setValidator(g_profile->validatePacket);
+#if FW_DEBUG
+    g_decoders.setClock(cycleClock);
+#endif
+    g_decoders.reset();
+    {
+        Preferences p;
+        p.begin("cdc", true);
+        g_deglitch.setLimit(p.getUShort("deglitch", CDC_DEGLITCH_US));
+        p.end();
+    }
     
     if (g_dataOutPin >= 0) {
         // Внешняя схемотехника уже задаёт подтяжку, поэтому внутренний pull-up отключаем,
@@ -385,318 +776,92 @@ void cdc_init(int sckPin, int misoPin, int mosiPin, int ssPin, int necPin, CdcBu
     // Это активирует пункт CDC в меню магнитолы.
     cdc_log("=== CDC INIT: Will send init sequence (10s warmup) ===");
     g_prevMs = millis();
+    
+    timer_start(countPlaySecond, 1000, 1000);
+#if FW_DEBUG
+    timer_start(logIsrCounters, 5000, 5000);
+#endif
 }
 
-void cdc_loop() {
-    // vwcdpic state machine: StateIdleThenPlay → StateInitPlay → StatePlayLeadIn → StatePlay
-    static enum { ST_IDLE_THEN_PLAY, ST_INIT_PLAY, ST_PLAY_LEAD_IN, ST_PLAY } state = ST_IDLE_THEN_PLAY;
-    // cppcheck-suppress variableScope  ; static needed for state machine persistence
-    static int stateCounter = 0;  // BIDIcount equivalent (negative countdown)
-    // cppcheck-suppress variableScope  ; static needed for state machine persistence
-    static bool initStarted = false;
-    
-    // Debug: Log ISR counter every 5 seconds (only in debug mode)
-    static uint32_t lastIsrLog = 0;
-    uint32_t nowMs = millis();
-    if (g_debugMode && (nowMs - lastIsrLog >= 5000)) {
-        lastIsrLog = nowMs;
-        cdc_log("VW ISR: total=" + String(vw_isr_counter) + 
-                " fall=" + String(vw_falling_edges) + 
-                " rise=" + String(vw_rising_edges) + 
-                " | CapPtr:" + String(vw_capPtr) + " ScanPtr:" + String(vw_scanPtr));
-    }
-    
-    processRawLog();
+// Всё, кроме отправки кадра: логи и декодеры DataOut
+// (счёт времени и отладочный лог — периодические таймеры из cdc_init)
+void cdc_poll() {
     cdc_pollNec();
-    
-    uint32_t now = millis();
-    
-    // Инкремент времени каждую секунду (только если НЕ получаем от BT)
-    // Если BT присылает TRACKSTAT, используем его время, иначе считаем сами
-    static uint32_t lastSecond = 0;
-    bool btTimeActive = (g_lastBtTimeUpdate > 0) && ((now - g_lastBtTimeUpdate) < 3000);
-    
-    if (!btTimeActive && state == ST_PLAY && g_status.state == CdcPlayState::PLAYING && (now - lastSecond >= 1000)) {
-        lastSecond = now;
-        g_playSeconds++;
-        if (g_playSeconds >= 60) {
-            g_playSeconds = 0;
-            g_playMinutes++;
-            if (g_playMinutes >= 100) g_playMinutes = 0;
-        }
+}
+
+// Один кадр state machine (по расписанию вызывающего)
+void cdc_sendFrame() {
+    g_prevMs = millis();
+    if (g_displayDirty) {
+        g_displayDirty = false;
+        recordLatency(micros() - g_dirtySinceUs);
     }
+    g_profile->frameStep();
+}
+
+void cdc_getIsrLoad(uint32_t &cycles, uint32_t &calls) {
+    cycles = vw_isrCycles;
+    calls  = vw_isr_counter;
+}
+
+uint32_t cdc_getFramePeriodMs() {
+    return g_profile ? g_profile->framePeriodMs : 50;
+}
+
+uint32_t cdc_getMinFrameGapMs() {
+    return g_profile ? g_profile->minFrameGapMs : 20;
+}
+
+void cdc_loop() {
+    cdc_poll();
     
-    if (now - g_prevMs >= 50) {  // 50ms = 20 packets/sec (vwcdpic timing)
-        g_prevMs = now;
-        
-        uint8_t disc = g_status.disc; if(disc<1) disc=1; if(disc>6) disc=6;
-        uint8_t track = g_status.track; if(track<1) track=1; if(track>99) track=99;
-        
-        if (!initStarted) {
-            initStarted = true;
-            cdc_log("=== CDC Init: StateIdleThenPlay (20 packets) ===");
-            state = ST_IDLE_THEN_PLAY;
-            stateCounter = -20;  // vwcdpic: BIDIcount = -20
-        }
-        
-        // ====== STATE: IdleThenPlay (vwcdpic lines 2203-2212) ======
-        if (state == ST_IDLE_THEN_PLAY) {
-            // Send IDLE packet: 74 BE FE FF FF FF 8F 7C
-            uint8_t idle[8] = {
-                0x74, 
-                (uint8_t)(0xBF - disc),
-                (uint8_t)(0xFF - track),
-                0xFF, 0xFF, 0xFF,  // vwcdpic uses 0xFF for mode in IDLE
-                0x8F, 0x7C
-            };
-            
-            if (stateCounter >= -5 || (stateCounter % 5) == 0) {  // Log first 5 and every 5th
-                String hex = "[IdleThenPlay " + String(-stateCounter) + "/20] ";
-                for(int i=0; i<8; i++) {
-                    if (idle[i] < 0x10) hex += "0";
-                    hex += String(idle[i], HEX) + " ";
-                }
-                cdc_log(hex);
-            }
-            
-            g_spi->beginTransaction(SPISettings(62500, MSBFIRST, SPI_MODE1));
-            for (int i = 0; i < 8; ++i) {
-                g_spi->transfer(idle[i]);
-                delayMicroseconds(874);
-            }
-            g_spi->endTransaction();
-            
-            stateCounter++;
-            if (stateCounter >= 0) {  // incfsz BIDIcount, f → goto StateIdle (then call SetStateInitPlay)
-                cdc_log("=== Transition: StateInitPlay (24 packets) ===");
-                state = ST_INIT_PLAY;
-                stateCounter = -24;  // vwcdpic: BIDIcount = -24
-                g_discLoad = 0x2E;   // vwcdpic: discload = 0x2E (CD1 announce)
-            }
-        }
-        
-        // ====== STATE: InitPlay (vwcdpic lines 2226-2268) ======
-        else if (state == ST_INIT_PLAY) {
-            // Alternating packets: odd=announce CD info, even=normal display
-            // btfss BIDIcount, 0 → goto StateInitPlayAnnounceCD (bit 0 clear = even counter)
-            bool isAnnounce = ((stateCounter & 1) == 0);  // Even countdown = announce
-            
-            if (isAnnounce) {
-                // StateInitPlayAnnounceCD: 34 2E XX XX XX B7 FF 3C
-                // Sends CD info with discload cycling 0x2E→0x2D→...→0x29→0x2E
-                uint8_t frame[8] = {
-                    0x34,
-                    g_discLoad,  // 0x29..0x2F = AUDIO CD Loaded
-                    0xFF - 0x99, // 99 tracks
-                    0xFF - 0x99, // 99 minutes  
-                    0xFF - 0x59, // 59 seconds
-                    0xB7,        // vwcdpic constant (B7, AC, CE, DA, C8 seen)
-                    0xFF,
-                    0x3C
-                };
-                
-                if (stateCounter >= -5) {  // Log first few
-                    String hex = "[InitPlay-Announce " + String(-stateCounter) + "/24] discload=";
-                    hex += String(g_discLoad, HEX) + " → ";
-                    for(int i=0; i<8; i++) {
-                        if (frame[i] < 0x10) hex += "0";
-                        hex += String(frame[i], HEX) + " ";
-                    }
-                    cdc_log(hex);
-                }
-                
-                g_spi->beginTransaction(SPISettings(62500, MSBFIRST, SPI_MODE1));
-                for (int i = 0; i < 8; ++i) {
-                    g_spi->transfer(frame[i]);
-                    delayMicroseconds(874);
-                }
-                g_spi->endTransaction();
-                
-                // Cycle discload: 0x29 → reached CD6? → 0x2E : decf discload
-                if (g_discLoad == 0x29) {
-                    g_discLoad = 0x2E;  // Loop back to CD1
-                } else {
-                    g_discLoad--;  // 0x2E→0x2D→0x2C→0x2B→0x2A→0x29
-                }
-            }
-            else {
-                // Normal packet: 34 BE FE FF FF FF EF 3C
-                uint8_t frame[8] = {
-                    0x34,
-                    (uint8_t)(0xBF - disc),
-                    (uint8_t)(0xFF - track),
-                    0xFF, 0xFF, 0xFF,  // minute/second/mode all 0xFF during init
-                    0xEF,  // vwcdpic init mute byte
-                    0x3C
-                };
-                
-                if (stateCounter >= -5) {
-                    String hex = "[InitPlay-Normal " + String(-stateCounter) + "/24] ";
-                    for(int i=0; i<8; i++) {
-                        if (frame[i] < 0x10) hex += "0";
-                        hex += String(frame[i], HEX) + " ";
-                    }
-                    cdc_log(hex);
-                }
-                
-                g_spi->beginTransaction(SPISettings(62500, MSBFIRST, SPI_MODE1));
-                for (int i = 0; i < 8; ++i) {
-                    g_spi->transfer(frame[i]);
-                    delayMicroseconds(874);
-                }
-                g_spi->endTransaction();
-            }
-            
-            stateCounter++;
-            if (stateCounter >= 0) {  // incfsz → goto SetStatePlayLeadIn
-                cdc_log("=== Transition: StatePlayLeadIn (10 packets) ===");
-                state = ST_PLAY_LEAD_IN;
-                stateCounter = -10;
-                // vwcdpic: sets time 0xFF here (already initialized)
-            }
-        }
-        
-        // ====== STATE: PlayLeadIn (vwcdpic lines 2278-2303) ======
-        else if (state == ST_PLAY_LEAD_IN) {
-            // Alternating announce/normal like InitPlay but different mute byte
-            bool isAnnounce = ((stateCounter & 1) == 0);
-            
-            if (isAnnounce) {
-                // StatePlayLeadInAnnounceCD: disc's lower nibble | 0x20
-                uint8_t frame[8] = {
-                    0x34,
-                    (uint8_t)((disc & 0x0F) | 0x20),  // vwcdpic: andlw 0x0F; iorlw 0x20
-                    0xFF - 0x99,
-                    0xFF - 0x99,
-                    0xFF - 0x59,
-                    0xB7,
-                    0xFF,
-                    0x3C
-                };
-                
-                g_spi->beginTransaction(SPISettings(62500, MSBFIRST, SPI_MODE1));
-                for (int i = 0; i < 8; ++i) {
-                    g_spi->transfer(frame[i]);
-                    delayMicroseconds(874);
-                }
-                g_spi->endTransaction();
-            }
-            else {
-                // Normal: 34 BE FE FF FF FF AE 3C
-                uint8_t frame[8] = {
-                    0x34,
-                    (uint8_t)(0xBF - disc),
-                    (uint8_t)(0xFF - track),
-                    0xFF, 0xFF, 0xFF,
-                    0xAE,  // PlayLeadIn mute byte
-                    0x3C
-                };
-                
-                g_spi->beginTransaction(SPISettings(62500, MSBFIRST, SPI_MODE1));
-                for (int i = 0; i < 8; ++i) {
-                    g_spi->transfer(frame[i]);
-                    delayMicroseconds(874);
-                }
-                g_spi->endTransaction();
-            }
-            
-            stateCounter++;
-            if (stateCounter >= 0) {
-                cdc_log("=== Transition: StatePlay (normal operation) ===");
-                state = ST_PLAY;
-                // Start time from 00:00 (vwcdpic increments 0xFF→0x00→0x01...)
-            }
-        }
-        
-        // ====== STATE: Play (vwcdpic lines 2329-2340) ======
-        else if (state == ST_PLAY) {
-            // StatePlay: 34 BE FE MM SS FB CF 3C (continuous)
-            // Track и время в BCD формате!
-            uint8_t trackBCD = toBCD(track);
-            uint8_t minBCD = toBCD(g_playMinutes);
-            uint8_t secBCD = toBCD(g_playSeconds);
-            
-            uint8_t frame[8] = {
-                0x34,
-                (uint8_t)(0xBF - disc),
-                (uint8_t)(0xFF - trackBCD),
-                (uint8_t)(0xFF - minBCD),
-                (uint8_t)(0xFF - secBCD),
-                g_modeByte,  // Байт 5: MIX (0xFF=off, 0x55=on)
-                g_scanByte,  // Байт 6: SCAN (0xCF=off, 0x4F=on)
-                0x3C
-            };
-            
-            // Логируем [PLAY] только в debug режиме
-            if (g_debugMode) {
-                static int playCount = 0;
-                playCount++;
-                if (playCount <= 10 || playCount % 20 == 0) {  // Log first 10, then every second
-                    String hex = "[PLAY] ";
-                    for(int i=0; i<8; i++) {
-                        if (frame[i] < 0x10) hex += "0";
-                        hex += String(frame[i], HEX) + " ";
-                    }
-                    hex += "→ CD" + String(disc) + " T" + String(track) + " ";
-                    // Время всегда показываем (начинаем с 00:00)
-                    if (g_playMinutes < 10) hex += "0";
-                    hex += String(g_playMinutes) + ":";
-                    if (g_playSeconds < 10) hex += "0";
-                    hex += String(g_playSeconds);
-                    cdc_log(hex);
-                }
-            }
-            
-            g_spi->beginTransaction(SPISettings(62500, MSBFIRST, SPI_MODE1));
-            for (int i = 0; i < 8; ++i) {
-                g_spi->transfer(frame[i]);
-                delayMicroseconds(874);
-            }
-            g_spi->endTransaction();
-        }
+    uint32_t sinceMs = millis() - g_prevMs;
+    if (sinceMs >= g_profile->framePeriodMs ||  // 50ms = 20 packets/sec (vwcdpic timing)
+        (g_displayDirty && g_eventFrames && sinceMs >= g_profile->minFrameGapMs)) {
+        cdc_sendFrame();
     }
 }
 
 // Setters
 void cdc_setDiscTrack(uint8_t d, uint8_t t) { 
+    bool changed = (g_status.disc != d || g_status.track != t);
     g_status.disc=d; 
     g_status.track=t; 
     g_playMinutes = 0;  // Сброс времени на 00:00 при смене трека
     g_playSeconds = 0;
+    if (changed) markDisplayDirty();
 }
 void cdc_setPlayState(CdcPlayState s) { g_status.state=s; }
 
-// Таблица из vwcdpic (без инверсий!):
+// Байты 5/6 берутся из таблицы профиля (для RNS-MFD, vwcdpic, без инверсий!):
 // 0x00 = scan off, mix off (норма)
 // 0x04 = scan off, mix on
 // 0xD0 = scan on, mix off
 // 0xD4 = scan on, mix on
 static void updateModeBytes() {
+    if (!g_profile) return;  // до cdc_init() — применится при загрузке профиля
     uint8_t oldMode = g_modeByte;
+    uint8_t oldScan = g_scanByte;
     
-    if (g_status.scanOn && g_status.randomOn) {
-        g_modeByte = 0xD4;
-    } else if (g_status.scanOn) {
-        g_modeByte = 0xD0;
-    } else if (g_status.randomOn) {
-        g_modeByte = 0x04;
-    } else {
-        g_modeByte = 0x00;
-    }
-    
-    // Байт 6: НЕ трогаем! Всегда 0xCF
-    g_scanByte = 0xCF;
+    g_modeByte = g_profile->modeByte(g_status.scanOn, g_status.randomOn);
+    g_scanByte = g_profile->scanByte(g_status.scanOn);
     
     if (oldMode != g_modeByte) {
         cdc_log("ModeByte[5]: 0x" + String(oldMode, HEX) + " → 0x" + String(g_modeByte, HEX));
     }
+    if (oldMode != g_modeByte || oldScan != g_scanByte) markDisplayDirty();
 }
 
 void cdc_resetModeFF() {
     g_status.scanOn = false;
     g_status.randomOn = false;
-    g_modeByte = 0xFF;
-    cdc_log("ModeByte[5] reset to 0xFF");
+    if (!g_profile) return;
+    uint8_t oldMode = g_modeByte;
+    uint8_t oldScan = g_scanByte;
+    g_modeByte = g_profile->modeNeutral;
+    g_scanByte = g_profile->scanByte(false);
+    cdc_log("ModeByte[5] reset to 0x" + String(g_modeByte, HEX));
+    if (oldMode != g_modeByte || oldScan != g_scanByte) markDisplayDirty();
 }
 
 void cdc_setPlayTime(uint8_t minutes, uint8_t seconds) {
@@ -716,4 +881,69 @@ void cdc_setScan(bool o) {
     g_status.scanOn = o; 
     updateModeBytes(); 
 }
-CdcStatus cdc_getStatus() { return g_status; }
\ No newline at end of file
+CdcStatus cdc_getStatus() { return g_status; }
+CdcBusStats cdc_getBusStats() { return g_busStats; }
+
+uint8_t cdc_getDecoderCount() { return g_decoders.count(); }
+int8_t  cdc_getLockedDecoder() { return g_decoders.locked(); }
+uint32_t cdc_getEdgeOverflows() { return vw_edgeBuf.overflows(); }
+
+const VwDataOutDecoder &cdc_getVwDecoder() { return g_vwDecoder; }
+void cdc_resetSignalStats() {
+    g_vwDecoder.resetSignalStats();
+    g_deglitch.repaired = 0;
+}
+
+bool cdc_getDecoderStats(uint8_t idx, const char *&name, DecoderStats &stats) {
+    if (idx >= g_decoders.count()) return false;
+    PulseDecoder *d = g_decoders.decoder(idx);
+    name  = d->name();
+    stats = d->stats;
+    return true;
+}
+
+// ---------------- Event frame latency ----------------
+void cdc_setEventFrames(bool on) { g_eventFrames = on; }
+bool cdc_getEventFrames() { return g_eventFrames; }
+
+const CdcLatencyStats &cdc_getLatencyStats() { return g_latency; }
+
+void cdc_resetLatencyStats() { g_latency = CdcLatencyStats(); }
+
+uint8_t cdc_latencyPercentileMs(uint8_t pct) {
+    if (g_latency.changes == 0) return 0;
+    uint32_t acc = 0;
+    for (uint8_t i = 0; i < CDC_LAT_BINS; ++i) {
+        acc += g_latency.hist[i];
+        if ((uint64_t)acc * 100 >= (uint64_t)g_latency.changes * pct) return i + 1;
+    }
+    return CDC_LAT_BINS;
+}
+
+// ---------------- Deglitch ----------------
+uint32_t cdc_getDeglitchUs() { return g_deglitch.limit(); }
+uint32_t cdc_getDeglitchRepaired() { return g_deglitch.repaired; }
+
+void cdc_setDeglitchUs(uint16_t us) {
+    g_deglitch.setLimit(us);
+    Preferences p;
+    p.begin("cdc", false);
+    p.putUShort("deglitch", us);
+    p.end();
+    cdc_log("DataOut deglitch: " + (us ? String(us) + "us" : String("off")));
+}
+
+// ---------------- Profile API ----------------
+CdcProfileId cdc_getProfile() { return g_profile->id; }
+const char*  cdc_getProfileName() { return g_profile->name; }
+
+bool cdc_setProfile(CdcProfileId id) {
+    const CdcProfileOps *ops = findProfile((uint8_t)id);
+    if (!ops) return false;
+    Preferences p;
+    p.begin("cdc", false);
+    p.putUChar("profile", (uint8_t)id);
+    p.end();
+    cdc_log("Profile saved: " + String(ops->name) + " (active after reboot)");
+    return true;
+}
@@ -50,11 +50,36 @@ struct CdcStatus {
     bool         scanOn;    // scan-режим
 };
 
+// Самоконтроль SPI шины (MOSI заведён обратно на вход MISO)
+struct CdcBusStats {
+    bool     enabled;            // loopback-вход задан в cdc_init()
+    uint32_t framesChecked;      // кадров отправлено и прочитано обратно
+    uint32_t framesCorrupted;    // кадров с хотя бы одним неверным байтом
+    uint32_t byteErrors;         // неверных байт всего
+    uint32_t bitErrors;          // неверных бит всего
+    uint32_t bursts;             // серий подряд битых кадров
+    uint32_t longestBurst;       // самая длинная серия (кадров)
+    uint32_t errorsByState[4];   // битые кадры по состоянию: IdleThenPlay, InitPlay, LeadIn, Play
+    uint32_t lastErrorMs;        // millis() последней ошибки
+};
+
+// Задержка "смена трека/SCAN/MIX → начало кадра на шине"
+static const uint8_t CDC_LAT_BINS = 64;  // гистограмма по 1 мс, последний бин — ≥63 мс
+struct CdcLatencyStats {
+    uint32_t changes;             // изменений, ушедших на шину
+    uint32_t expedited;           // запросов внеочередного кадра
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint32_t hist[CDC_LAT_BINS];
+};
+
 // callback: магнитола нажала кнопку (или послала команду)
 typedef void (*CdcButtonCallback)(CdcButton btn);
 
 // Инициализация CDC-эмулятора.
 // sck, miso, mosi, ss — пины SPI шины, подключённой к RNS-MFD.
+// miso >= 0 — loopback-вход: MOSI заведён на него перемычкой, каждый кадр
+// читается обратно и сверяется (см. cdc_getBusStats()).
 // necPin — отдельный пин для приема NEC IR сигнала от магнитолы.
 // buttonCb — колбэк, который будет вызываться при командах от магнитолы.
 void cdc_init(int sckPin, int misoPin, int mosiPin, int ssPin, int necPin,
@@ -63,6 +88,15 @@ void cdc_init(int sckPin, int misoPin, int mosiPin, int ssPin, int necPin,
 // Вызывать в loop()
 void cdc_loop();
 
+// То же по частям — для планировщика (loop_sched.h):
+void     cdc_poll();              // декодеры DataOut, логи, счёт времени (ASAP)
+void     cdc_sendFrame();         // отправить один кадр (HARD, каждые cdc_getFramePeriodMs())
+uint32_t cdc_getFramePeriodMs();  // период кадров активного профиля
+uint32_t cdc_getMinFrameGapMs();  // минимум между кадрами (внеочередной кадр)
+
+// DataOut ISR: накопленные такты CPU и число вызовов (для cpu_load)
+void cdc_getIsrLoad(uint32_t &cycles, uint32_t &calls);
+
 // --- API для BT-слоя / логики плеера ---
 
 // Установить диск и трек (1..6, 1..99)
@@ -85,3 +119,30 @@ void cdc_setPlayTime(uint8_t minutes, uint8_t seconds);
 
 // Получить текущее состояние
 CdcStatus cdc_getStatus();
+
+// Счётчики целостности SPI шины (только при включённом loopback)
+CdcBusStats cdc_getBusStats();
+
+// Внеочередной кадр при смене отображаемого состояния (по умолчанию вкл.)
+void cdc_setEventFrames(bool on);
+bool cdc_getEventFrames();
+const CdcLatencyStats &cdc_getLatencyStats();
+void    cdc_resetLatencyStats();
+uint8_t cdc_latencyPercentileMs(uint8_t pct);  // верхняя граница бина, мс
+
+// --- Декодеры DataOut (dataout_decoder.h) ---
+struct DecoderStats;
+uint8_t  cdc_getDecoderCount();
+int8_t   cdc_getLockedDecoder();   // -1 = протокол ещё не определён
+uint32_t cdc_getEdgeOverflows();   // импульсы, потерянные до декодера
+bool     cdc_getDecoderStats(uint8_t idx, const char *&name, DecoderStats &stats);
+
+// Качество сигнала DataOut: статистика по классам импульсов (start/1/0/шум/иголки)
+class VwDataOutDecoder;
+const VwDataOutDecoder &cdc_getVwDecoder();
+void cdc_resetSignalStats();
+
+// Склейка LOW, разорванных короткой иголкой HIGH (PulseDeglitcher)
+uint32_t cdc_getDeglitchUs();
+uint32_t cdc_getDeglitchRepaired();
+void     cdc_setDeglitchUs(uint16_t us);   // 0 = выкл., сохраняется в NVS
@@ -0,0 +1,557 @@
+#include "web_api.h"
+#include "bt1036_at.h"
+#include "vw_cdc.h"
+#include "cdc_profile.h"
+#include "dataout_decoder.h"
+#include "loop_sched.h"
+#include "timer_wheel.h"
+#include "mem_governor.h"
+#include "cpu_load.h"
+#include "track_sync.h"
+#include "play_state.h"
+#include "scenario.h"
+#include "bt_scenarios.h"
+#include "at_bridge.h"
+#include "session_log.h"
+
+// bt_webui.cpp (без WebServer.h — host-сборке хватает заглушек)
+extern bool g_debugMode;
+void btWebUI_setDebug(bool on);
+
+// Длина корректной последовательности UTF-8 с байта i (RFC 3629: без
+// overlong, суррогатов и > U+10FFFF), 0 — байт негодный
+static size_t utf8Len(const String &s, size_t i) {
+    uint8_t c = (uint8_t)s[i];
+    size_t n;
+    uint8_t lo = 0x80, hi = 0xBF;
+    if (c >= 0xC2 && c <= 0xDF)      n = 2;
+    else if (c == 0xE0)              { n = 3; lo = 0xA0; }
+    else if (c == 0xED)              { n = 3; hi = 0x9F; }
+    else if (c >= 0xE1 && c <= 0xEF) n = 3;
+    else if (c == 0xF0)              { n = 4; lo = 0x90; }
+    else if (c == 0xF4)              { n = 4; hi = 0x8F; }
+    else if (c >= 0xF1 && c <= 0xF3) n = 4;
+    else return 0;
+    if (i + n > s.length()) return 0;
+    for (size_t k = 1; k < n; ++k) {
+        uint8_t b = (uint8_t)s[i + k];
+        if (k == 1 ? (b < lo || b > hi) : (b < 0x80 || b > 0xBF)) return 0;
+    }
+    return n;
+}
+
+String webApi_jsonEscape(const String &s) {
+    String out;
+    out.reserve(s.length() + 8);
+    for (size_t i = 0; i < s.length(); ++i) {
+        char c = s[i];
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((uint8_t)c < 0x20) {
+                    char buf[7];
+                    snprintf(buf, sizeof(buf), "\\u%04x", (uint8_t)c);
+                    out += buf;
+                } else if ((uint8_t)c < 0x80) {
+                    out += c;
+                } else {
+                    // Метаданные AVRCP бывают в Latin-1/CP1251 — негодный байт
+                    // заменяем на U+FFFD, иначе ответ не UTF-8 и строгий парсер его отвергнет
+                    size_t n = utf8Len(s, i);
+                    if (!n) {
+                        out += "\\ufffd";
+                        continue;
+                    }
+                    for (size_t k = 0; k < n; ++k) out += s[i + k];
+                    i += n - 1;
+                }
+        }
+    }
+    return out;
+}
+
+// ========== Обработчики ==========
+static const char* stateToStr(BTConnState st) {
+    switch (st) {
+        case BTConnState::DISCONNECTED:   return "DISCONNECTED";
+        case BTConnState::CONNECTING:     return "CONNECTING";
+        case BTConnState::CONNECTED_IDLE: return "CONNECTED_IDLE";
+        case BTConnState::PLAYING:        return "PLAYING";
+        case BTConnState::PAUSED:         return "PAUSED";
+    }
+    return "UNKNOWN";
+}
+
+static void handleStatus(const ApiRequest &req, ApiResponse &res) {
+    BTConnState st = bt1036_getState();
+    BtDevStat   ds = bt1036_getDevStat();
+    String json = "{";
+    json += "\"state\":\"" + String(stateToStr(st)) + "\",";
+    json += "\"devstat\":{\"powerOn\":" + String(ds.powerOn ? "true":"false") + "},";
+    const PlayStateStats &ps = pstate_getStats();
+    json += "\"play\":{\"state\":\"" + String(pstate_name(pstate_get())) + "\"";
+    json += ",\"reported\":\"" + String(pstate_name(pstate_reported())) + "\"";
+    json += ",\"pending\":" + String(pstate_pending() ? "true" : "false");
+    json += ",\"seq\":" + String(pstate_seq());
+    json += ",\"commands\":" + String(ps.commands);
+    json += ",\"confirmed\":" + String(ps.confirmed);
+    json += ",\"timedOut\":" + String(ps.timedOut);
+    json += ",\"conflicts\":" + String(ps.conflicts);
+    json += ",\"remoteChanges\":" + String(ps.remoteChanges);
+    json += ",\"savedPresses\":" + String(ps.savedPresses) + "}";
+    json += "}";
+    res.send(200, "application/json", json);
+}
+
+static void handleBtIdentity(const ApiRequest &req, ApiResponse &res) {
+    BtModuleIdentity id = bt1036_getIdentity();
+    String json = "{";
+    json += "\"valid\":" + String(id.valid ? "true" : "false") + ",";
+    json += "\"version\":\"" + webApi_jsonEscape(id.version) + "\",";
+    json += "\"address\":\"" + webApi_jsonEscape(id.address) + "\",";
+    json += "\"quirks\":" + String(id.quirkCount) + ",";
+    json += "\"skipped\":" + String(id.skipped) + ",";
+    json += "\"substituted\":" + String(id.substituted) + ",";
+    json += "\"unsupported\":\"" + webApi_jsonEscape(bt1036_getUnsupportedCommands()) + "\"";
+    json += "}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/bt/bridge          → состояние и счётчики AT-моста (/term)
+// GET /api/bt/bridge?close=1  → закрыть (опрос статусов возобновится)
+static void handleBtBridge(const ApiRequest &req, ApiResponse &res) {
+    if (req.arg("close") == "1") atb_close("via API");
+    const AtBridgeStats &s = atb_getStats();
+    String json = "{";
+    json += "\"active\":" + String(atb_active() ? "true" : "false");
+    json += ",\"backgroundPoll\":" + String(bt1036_getBackgroundPoll() ? "true" : "false");
+    json += ",\"pending\":" + String(atb_pending());
+    json += ",\"opens\":" + String(s.opens);
+    json += ",\"commands\":" + String(s.commands);
+    json += ",\"ok\":" + String(s.ok);
+    json += ",\"errors\":" + String(s.errors);
+    json += ",\"timeouts\":" + String(s.timeouts);
+    json += ",\"busy\":" + String(s.busy);
+    json += ",\"rxBytes\":" + String(s.rxBytes);
+    json += ",\"rxDropped\":" + String(s.rxDropped);
+    json += ",\"chunks\":" + String(s.chunks);
+    json += ",\"sinkFails\":" + String(s.sinkFails);
+    json += ",\"lastMs\":" + String(s.lastMs);
+    json += ",\"maxMs\":" + String(s.maxMs);
+    json += "}";
+    res.send(200, "application/json", json);
+}
+
+static void handleSetBasic(const ApiRequest &req, ApiResponse &res) {
+    String name = req.arg("name");
+    bool nsuf = req.arg("ns") == "1";
+    String lname = req.arg("lname");
+    bool lsuf = req.arg("ls") == "1";
+    String cod = req.arg("cod");
+    if (name.length()) bt1036_setName(name, nsuf);
+    if (lname.length()) bt1036_setBLEName(lname, lsuf);
+    if (cod.length()) bt1036_setCod(cod);
+    res.send(200, "text/plain", "OK");
+}
+
+static void handleSetHfp(const ApiRequest &req, ApiResponse &res) {
+    uint32_t rate = req.arg("rate").toInt();
+    uint8_t cfg = 0;
+    if (req.arg("cfg") != "") cfg = (uint8_t)req.arg("cfg").toInt(); 
+    bt1036_setHfpSampleRate(rate);
+    bt1036_setHfpConfig(cfg);
+    res.send(200, "text/plain", "OK");
+}
+
+static void handleProfile(const ApiRequest &req, ApiResponse &res) {
+    bt1036_setProfile(req.arg("p").toInt());
+    bt1036_setAutoconn(req.arg("a").toInt());
+    res.send(200, "text/plain", "OK");
+}
+
+static void handleAudio(const ApiRequest &req, ApiResponse &res) {
+    bt1036_setMicGain(req.arg("mg").toInt());
+    bt1036_setSpkVol(req.arg("a2").toInt(), req.arg("hf").toInt());
+    bt1036_setTxPower(req.arg("tx").toInt());
+    res.send(200, "text/plain", "OK");
+}
+
+static void handleCmd(const ApiRequest &req, ApiResponse &res) {
+    String act = req.arg("act");
+    if(act=="playpause") pstate_toggle();
+    else if(act=="next") bt1036_nextTrack();
+    else if(act=="prev") bt1036_prevTrack();
+    else if(act=="connect") bt1036_connectLast();
+    else if(act=="disconnect") bt1036_disconnect();
+    else if(act=="scan") bt1036_startScan();
+    res.send(200, "text/plain", "OK");
+}
+
+static void handleFactory(const ApiRequest &req, ApiResponse &res) {
+    res.send(200, "text/plain", scen_factory() ? "OK" : "BUSY");
+}
+
+// GET /api/cdc/profile            → {"id":0,"name":"RNS-MFD"}
+// GET /api/cdc/profile?set=<id>   → сохранить в NVS (после перезагрузки)
+static void handleCdcProfile(const ApiRequest &req, ApiResponse &res) {
+    if (req.hasArg("set")) {
+        uint8_t id = (uint8_t)req.arg("set").toInt();
+        if (id >= CDC_PROFILE_COUNT || !cdc_setProfile((CdcProfileId)id)) {
+            res.send(400, "text/plain", "Unknown profile");
+            return;
+        }
+        res.send(200, "text/plain", "OK (reboot to apply)");
+        return;
+    }
+    String json = "{\"id\":" + String((int)cdc_getProfile()) +
+                  ",\"name\":\"" + String(cdc_getProfileName()) + "\"}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/cdc/bus → счётчики SPI loopback
+static void handleCdcBus(const ApiRequest &req, ApiResponse &res) {
+    CdcBusStats b = cdc_getBusStats();
+    String json = "{";
+    json += "\"enabled\":" + String(b.enabled ? "true" : "false") + ",";
+    json += "\"frames\":" + String(b.framesChecked) + ",";
+    json += "\"corrupted\":" + String(b.framesCorrupted) + ",";
+    json += "\"byteErrors\":" + String(b.byteErrors) + ",";
+    json += "\"bitErrors\":" + String(b.bitErrors) + ",";
+    json += "\"bursts\":" + String(b.bursts) + ",";
+    json += "\"longestBurst\":" + String(b.longestBurst) + ",";
+    json += "\"byState\":{\"idleThenPlay\":" + String(b.errorsByState[0]) +
+            ",\"initPlay\":" + String(b.errorsByState[1]) +
+            ",\"leadIn\":" + String(b.errorsByState[2]) +
+            ",\"play\":" + String(b.errorsByState[3]) + "},";
+    json += "\"lastErrorAgoMs\":" + String(b.lastErrorMs ? millis() - b.lastErrorMs : 0);
+    json += "}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/cdc/decoders → статистика декодеров DataOut + стоимость на импульс
+static void handleCdcDecoders(const ApiRequest &req, ApiResponse &res) {
+    int8_t locked = cdc_getLockedDecoder();
+    uint32_t mhz = cpu_getFreqMHz();
+    String json = "{\"locked\":";
+    const char *lname;
+    DecoderStats ls;
+    if (locked >= 0 && cdc_getDecoderStats((uint8_t)locked, lname, ls)) {
+        json += "\"" + webApi_jsonEscape(lname) + "\"";
+    } else {
+        json += "null";
+    }
+    json += ",\"edgeOverflows\":" + String(cdc_getEdgeOverflows());
+    json += ",\"decoders\":[";
+    for (uint8_t i = 0; i < cdc_getDecoderCount(); ++i) {
+        const char *name = "?";
+        DecoderStats ds = {};
+        cdc_getDecoderStats(i, name, ds);
+        uint32_t perEdge = ds.pulses ? ds.cycles / ds.pulses : 0;
+        if (i) json += ",";
+        json += "{\"name\":\"" + webApi_jsonEscape(name) + "\"";
+        json += ",\"pulses\":" + String(ds.pulses);
+        json += ",\"frames\":" + String(ds.frames);
+        json += ",\"valid\":" + String(ds.valid);
+        json += ",\"invalid\":" + String(ds.invalid);
+        json += ",\"aborted\":" + String(ds.aborted);
+        json += ",\"cyclesPerEdge\":" + String(perEdge);
+        json += ",\"nsPerEdge\":" + String(mhz ? (uint32_t)((uint64_t)perEdge * 1000 / mhz) : 0);
+        json += ",\"maxCycles\":" + String(ds.maxCycles) + "}";
+    }
+    json += "]}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/cdc/latency[?event=0|1][&reset=1] → смена трека/SCAN/MIX → кадр на шине
+static void handleCdcLatency(const ApiRequest &req, ApiResponse &res) {
+    if (req.hasArg("event")) {
+        cdc_setEventFrames(req.arg("event") == "1");
+        cdc_resetLatencyStats();  // до/после не смешиваем
+    }
+    if (req.arg("reset") == "1") cdc_resetLatencyStats();
+
+    const CdcLatencyStats &l = cdc_getLatencyStats();
+    String json = "{\"eventFrames\":" + String(cdc_getEventFrames() ? "true" : "false");
+    json += ",\"minGapMs\":" + String(cdc_getMinFrameGapMs());
+    json += ",\"changes\":" + String(l.changes);
+    json += ",\"expedited\":" + String(l.expedited);
+    json += ",\"avgUs\":" + String(l.changes ? (uint32_t)(l.sumUs / l.changes) : 0);
+    json += ",\"p50Ms\":" + String(cdc_latencyPercentileMs(50));
+    json += ",\"p99Ms\":" + String(cdc_latencyPercentileMs(99));
+    json += ",\"maxUs\":" + String(l.maxUs);
+    json += "}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/cdc/signal[?reset=1][&deglitch=<us>] → качество сигнала DataOut по классам
+// импульсов; deglitch — порог склейки иголок HIGH (0 = выкл., в NVS)
+static const char* healthToStr(SignalHealth h) {
+    switch (h) {
+        case SignalHealth::GOOD:     return "GOOD";
+        case SignalHealth::MARGINAL: return "MARGINAL";
+        case SignalHealth::BAD:      return "BAD";
+        case SignalHealth::NO_DATA:  return "NO_DATA";
+    }
+    return "UNKNOWN";
+}
+
+static void handleCdcSignal(const ApiRequest &req, ApiResponse &res) {
+    if (req.arg("reset") == "1") cdc_resetSignalStats();
+    if (req.hasArg("deglitch")) {
+        long us = req.arg("deglitch").toInt();
+        if (us < 0 || us > 400) {
+            res.send(400, "text/plain", "deglitch: 0..400 us");
+            return;
+        }
+        cdc_setDeglitchUs((uint16_t)us);
+    }
+
+    static const char* const CLASS_NAMES[PC_COUNT] = { "glitch", "noise", "zero", "one", "start" };
+    const VwDataOutDecoder &vw = cdc_getVwDecoder();
+    String json = "{\"health\":\"" + String(healthToStr(vw.health())) + "\"";
+    json += ",\"longLow\":" + String(vw.longLow);
+    json += ",\"deglitch\":{\"limitUs\":" + String(cdc_getDeglitchUs());
+    json += ",\"repaired\":" + String(cdc_getDeglitchRepaired()) + "}";
+    json += ",\"classes\":{";
+    for (uint8_t c = 0; c < PC_COUNT; ++c) {
+        const PulseClassStats &st = vw.pulseClass[c];
+        if (c) json += ",";
+        json += "\"" + String(CLASS_NAMES[c]) + "\":{";
+        json += "\"count\":" + String(st.count);
+        json += ",\"mean\":" + String(st.mean(), 1);
+        json += ",\"std\":" + String(st.stddev(), 1);
+        json += ",\"min\":" + String(st.count ? st.min : 0);
+        json += ",\"max\":" + String(st.max);
+        json += ",\"marginLo\":" + String(vw.marginLowUs((PulseClass)c));
+        json += ",\"marginHi\":" + String(vw.marginHighUs((PulseClass)c));
+        json += "}";
+    }
+    json += "}}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/sched[?reset=1] → статистика шагов планировщика loop()
+static void handleSched(const ApiRequest &req, ApiResponse &res) {
+    if (req.arg("reset") == "1") sched_resetStats();
+    String json = "{\"passes\":" + String(sched_getPasses()) + ",\"steps\":[";
+    for (uint8_t i = 0; i < sched_getStepCount(); ++i) {
+        const SchedStep *s = sched_getStep(i);
+        if (i) json += ",";
+        json += "{\"name\":\"" + String(s->name) + "\"";
+        json += ",\"runs\":" + String(s->runs);
+        json += ",\"avgUs\":" + String(s->runs ? (uint32_t)(s->totalRunUs / s->runs) : 0);
+        json += ",\"maxUs\":" + String(s->maxRunUs);
+        json += ",\"budgetUs\":" + String(s->budgetUs);
+        json += ",\"overruns\":" + String(s->overruns);
+        json += ",\"misses\":" + String(s->misses);
+        json += ",\"maxLateUs\":" + String(s->maxLateUs);
+        json += ",\"deferred\":" + String(s->deferred);
+        json += ",\"expedited\":" + String(s->expedited) + "}";
+    }
+    json += "]";
+    uint32_t nextMs = timer_msUntilNext();
+    json += ",\"timers\":{\"active\":" + String(timer_getActiveCount());
+    json += ",\"peak\":" + String(timer_getPeak()) + ",\"max\":" + String(TIMER_MAX);
+    json += ",\"fired\":" + String(timer_getFired());
+    json += ",\"poolExhausted\":" + String(timer_getPoolExhausted());
+    json += ",\"nextMs\":" + (nextMs == UINT32_MAX ? String("null") : String(nextMs));
+    json += ",\"hardInUs\":" + String(sched_usUntilHard()) + "}}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/cpu → загрузка ядер за последнюю секунду
+static void handleCpu(const ApiRequest &req, ApiResponse &res) {
+    const CpuSample &c = cpu_getSample();
+    String json = "{\"windowUs\":" + String(c.windowUs) + ",\"loopCore\":" + String(cpu_getLoopCore());
+    json += ",\"cores\":[";
+    for (uint8_t i = 0; i < CPU_CORES; ++i) {
+        if (i) json += ",";
+        json += "{\"core\":" + String(i) + ",\"load\":" + String(c.load[i], 1) + "}";
+    }
+    json += "],\"isr\":{\"dataOutPct\":" + String(c.dataOutIsrPct, 3);
+    json += ",\"dataOutCalls\":" + String(c.dataOutIsrCalls);
+    json += ",\"dataOutAvgNs\":" + String(c.dataOutIsrAvgNs) + "}";
+    json += ",\"steps\":[";
+    for (uint8_t i = 0; i < c.stepCount; ++i) {
+        if (i) json += ",";
+        json += "{\"name\":\"" + String(sched_getStep(i)->name) + "\",\"pct\":" + String(c.stepPct[i], 2) + "}";
+    }
+    json += "]}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/mem → состояние governor'а памяти
+static void handleMem(const ApiRequest &req, ApiResponse &res) {
+    const MemStats &m = mem_getStats();
+    String json = "{";
+    json += "\"level\":\"" + String(mem_levelName(m.level)) + "\",";
+    json += "\"freeHeap\":" + String(m.freeHeap) + ",";
+    json += "\"largestBlock\":" + String(m.largestBlock) + ",";
+    json += "\"minFreeHeap\":" + String(m.minFreeHeap) + ",";
+    json += "\"transitions\":" + String(m.transitions) + ",";
+    json += "\"rawDropped\":" + String(m.rawDropped) + ",";
+    json += "\"linesDropped\":" + String(m.linesDropped) + ",";
+    json += "\"wsRefused\":" + String(m.wsRefused);
+    json += "}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/track → метаданные трека (строки из AVRCP — экранируются целиком)
+// + подтверждение NEXT/PREV телефоном (track_sync)
+static void handleTrack(const ApiRequest &req, ApiResponse &res) {
+    TrackInfo ti = bt1036_getTrackInfo();
+    String json = "{";
+    json += "\"title\":\"" + webApi_jsonEscape(ti.title) + "\",";
+    json += "\"artist\":\"" + webApi_jsonEscape(ti.artist) + "\",";
+    json += "\"album\":\"" + webApi_jsonEscape(ti.album) + "\",";
+    json += "\"elapsed\":" + String(ti.elapsedSec) + ",";
+    json += "\"total\":" + String(ti.totalSec) + ",";
+    json += "\"valid\":" + String(ti.valid ? "true" : "false") + ",";
+    const TrackSyncStats &ts = tsync_getStats();
+    json += "\"sync\":{\"pending\":" + String(ts.pending ? "true" : "false");
+    json += ",\"batches\":" + String(ts.batches);
+    json += ",\"presses\":" + String(ts.presses);
+    json += ",\"hits\":" + String(ts.hits);
+    json += ",\"rollbacks\":" + String(ts.rollbacks);
+    json += ",\"unverified\":" + String(ts.unverified);
+    json += ",\"avgConfirmMs\":" + String(ts.hits ? ts.confirmMsSum / ts.hits : 0);
+    json += ",\"maxConfirmMs\":" + String(ts.confirmMsMax) + "}";
+    json += "}";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/scenarios                       → состояние и длительности сценариев
+// GET /api/scenarios?run=pairing|connect|factory → запустить
+static void handleScenarios(const ApiRequest &req, ApiResponse &res) {
+    if (req.hasArg("run")) {
+        String what = req.arg("run");
+        bool started;
+        if (what == "pairing")      started = scen_pairing();
+        else if (what == "connect") started = scen_connectPlay(0);
+        else if (what == "factory") started = scen_factory();
+        else {
+            res.send(400, "text/plain", "Unknown scenario");
+            return;
+        }
+        res.send(200, "text/plain", started ? "OK" : "BUSY");
+        return;
+    }
+    String json = "[";
+    for (uint8_t i = 0; i < sc_count(); ++i) {
+        const Scenario *sc = sc_get(i);
+        if (i) json += ",";
+        json += "{\"name\":\"" + String(sc->name) + "\"";
+        json += ",\"status\":\"" + String(sc_statusName(sc->status)) + "\"";
+        json += ",\"runs\":" + String(sc->runs);
+        json += ",\"done\":" + String(sc->done);
+        json += ",\"failed\":" + String(sc->failed);
+        json += ",\"lastMs\":" + String(sc->lastMs);
+        json += ",\"minMs\":" + String(sc->minMs);
+        json += ",\"maxMs\":" + String(sc->maxMs);
+        json += ",\"runningMs\":" + String(sc_running(*sc) ? millis() - sc->startMs : 0);
+        json += ",\"stepErrors\":" + String(sc->errors);
+        json += ",\"reason\":\"" + webApi_jsonEscape(sc->failReason) + "\"}";
+    }
+    json += "]";
+    res.send(200, "application/json", json);
+}
+
+// GET /api/sessions          → сводки поездок, новые первыми ("current" — идёт сейчас)
+// GET /api/sessions?n=<1..16> → только последние n
+// GET /api/sessions?clear=1   → стереть историю
+static void handleSessions(const ApiRequest &req, ApiResponse &res) {
+    if (req.arg("clear") == "1") {
+        sess_clear();
+        res.send(200, "text/plain", "OK");
+        return;
+    }
+    uint8_t n = SESS_SLOTS;
+    if (req.hasArg("n")) {
+        long v = req.arg("n").toInt();
+        if (v < 1 || v > SESS_SLOTS) {
+            res.send(400, "text/plain", "n out of range");
+            return;
+        }
+        n = (uint8_t)v;
+    }
+    String json = "{\"writes\":" + String(sess_getWrites()) + ",\"sessions\":[";
+    bool first = true;
+    for (uint8_t age = 0; age < n; ++age) {
+        SessionRecord r;
+        if (!sess_get(age, r)) continue;
+        if (!first) json += ",";
+        first = false;
+        json += "{\"seq\":" + String(r.seq);
+        json += ",\"current\":" + String(age == 0 ? "true" : "false");
+        json += ",\"reset\":\"" + String(sess_resetReasonName(r.resetReason)) + "\"";
+        json += ",\"uptimeS\":" + String(r.uptimeS);
+        json += ",\"frames\":" + String(r.frames);
+        json += ",\"frameMisses\":" + String(r.frameMisses);
+        json += ",\"btConnects\":" + String(r.btConnects);
+        json += ",\"btConnectedS\":" + String(r.btConnectedS);
+        json += ",\"timeToAudioMs\":" + (r.timeToAudioMs == SESS_NO_AUDIO ? String("null") : String(r.timeToAudioMs));
+        json += ",\"cmdsSent\":" + String(r.cmdsSent);
+        json += ",\"cmdsFailed\":" + String(r.cmdsFailed);
+        json += ",\"cmdTimeouts\":" + String(r.cmdTimeouts);
+        json += ",\"decodeErrors\":" + String(r.decodeErrors);
+        json += ",\"buttons\":" + String(r.buttons);
+        json += ",\"minFreeHeap\":" + String(r.minFreeHeap) + "}";
+    }
+    json += "]}";
+    res.send(200, "application/json", json);
+}
+
+static void handleDebug(const ApiRequest &req, ApiResponse &res) {
+    btWebUI_setDebug(!g_debugMode);
+    res.send(200, "text/plain", g_debugMode ? "ON" : "OFF");
+}
+
+static void handleDebugStatus(const ApiRequest &req, ApiResponse &res) {
+    res.send(200, "text/plain", g_debugMode ? "ON" : "OFF");
+}
+
+// ========== Маршруты ==========
+static const ApiRoute ROUTES[] = {
+    { "/api/status",       handleStatus },
+    { "/api/bt/identity",  handleBtIdentity },
+    { "/api/bt/bridge",    handleBtBridge },
+    { "/api/cmd",          handleCmd },
+    { "/api/audio",        handleAudio },
+    { "/api/set_basic",    handleSetBasic },
+    { "/api/set_profile",  handleProfile },
+    { "/api/set_hfp",      handleSetHfp },
+    { "/api/factory",      handleFactory },
+    { "/api/track",        handleTrack },
+    { "/api/debug",        handleDebug },
+    { "/api/debug_status", handleDebugStatus },
+    { "/api/cdc/profile",  handleCdcProfile },
+    { "/api/cdc/bus",      handleCdcBus },
+    { "/api/cdc/signal",   handleCdcSignal },
+    { "/api/cdc/decoders", handleCdcDecoders },
+    { "/api/cdc/latency",  handleCdcLatency },
+    { "/api/sched",        handleSched },
+    { "/api/mem",          handleMem },
+    { "/api/cpu",          handleCpu },
+    { "/api/scenarios",    handleScenarios },
+    { "/api/sessions",     handleSessions },
+};
+static const size_t ROUTE_COUNT = sizeof(ROUTES) / sizeof(ROUTES[0]);
+
+const ApiRoute *webApi_routes(size_t &count) {
+    count = ROUTE_COUNT;
+    return ROUTES;
+}
+
+bool webApi_dispatch(const char *path, const ApiRequest &req, ApiResponse &res) {
+    for (size_t i = 0; i < ROUTE_COUNT; ++i) {
+        if (strcmp(ROUTES[i].path, path) == 0) {
+            ROUTES[i].handler(req, res);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+/**
+ * @file web_api.h
+ * @brief Transport-independent JSON/text API handlers
+ *
+ * Handlers that only talk to the bt1036_* / cdc_* / sched / mem / cpu
+ * modules live here and see the request through ApiRequest and answer
+ * into ApiResponse. bt_webui.cpp adapts them to WebServer; test/host links
+ * this file against mock backends and calls webApi_dispatch() directly
+ * (JSON validity of every route, per-route CPU/heap benchmark). Handlers
+ * that need the WiFi stack, NVS or ESP.* stay in bt_webui.cpp.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+class ApiRequest {
+public:
+    virtual ~ApiRequest() {}
+    virtual String arg(const char *name) const = 0;  // "" если нет
+    virtual bool   hasArg(const char *name) const = 0;
+};
+
+struct ApiResponse {
+    int         code = 0;
+    const char *contentType = "text/plain";
+    String      body;
+
+    void send(int c, const char *type, const String &b) {
+        code = c;
+        contentType = type;
+        body = b;
+    }
+};
+
+typedef void (*ApiHandler)(const ApiRequest &req, ApiResponse &res);
+
+struct ApiRoute {
+    const char *path;
+    ApiHandler  handler;
+};
+
+// Таблица маршрутов (для регистрации в WebServer)
+const ApiRoute *webApi_routes(size_t &count);
+
+// false — маршрут не найден (res не тронут)
+bool webApi_dispatch(const char *path, const ApiRequest &req, ApiResponse &res);
+
+// Экранирование строки для JSON ("…" не включены): кавычки, \, управляющие;
+// байты, не образующие корректный UTF-8, — U+FFFD
+String webApi_jsonEscape(const String &s);
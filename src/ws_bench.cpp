@@ -0,0 +1,81 @@
+#include "ws_bench.h"
+#include "timer_wheel.h"
+#include "cpu_load.h"
+#include "bt_webui.h"
+
+static const uint32_t TICK_MS        = 10;
+static const uint32_t TICKS_PER_SEC  = 1000 / TICK_MS;
+
+static WsBenchResult g_res = {};
+static TimerId  g_tickTimer = TIMER_NONE;
+static uint32_t g_ticksLeft = 0;
+static uint32_t g_tick      = 0;
+static uint32_t g_credit    = 0;   // rate × тиков, сообщение = TICKS_PER_SEC
+static char     g_msg[WSB_MAX_SIZE + 1];
+
+static void sendOne() {
+    int n = snprintf(g_msg, sizeof(g_msg), "[WSB] %lu %lu ",
+                     (unsigned long)g_res.sent, (unsigned long)micros());
+    if (n < g_res.size) memset(g_msg + n, '.', g_res.size - n);
+    g_msg[g_res.size] = 0;
+    btWebUI_broadcastBench(g_msg);
+    g_res.sent++;
+}
+
+static void onTick() {
+    uint8_t clients = btWebUI_getWsStats().clients;
+    if (clients < g_res.minClients) g_res.minClients = clients;
+    if (clients > g_res.maxClients) g_res.maxClients = clients;
+
+    // Дробная скорость: rate=30 → 3 сообщения на каждые 10 тиков
+    g_credit += g_res.rate;
+    while (g_credit >= TICKS_PER_SEC) {
+        g_credit -= TICKS_PER_SEC;
+        sendOne();
+    }
+
+    // loopHz обновляется раз в секунду; первая секунда — переходная
+    if (++g_tick % TICKS_PER_SEC == 0 && g_tick > TICKS_PER_SEC) {
+        uint32_t hz = cpu_getSample().loopHz;
+        if (g_res.loopSamples == 0 || hz < g_res.loopHzMin) g_res.loopHzMin = hz;
+        g_res.loopHzSum += hz;
+        g_res.loopSamples++;
+    }
+
+    if (--g_ticksLeft == 0) ws_bench_stop();
+}
+
+bool ws_bench_start(uint16_t seconds, uint16_t rate, uint16_t size) {
+    if (g_res.running || seconds == 0 || rate == 0) return false;
+
+    g_res = WsBenchResult();
+    g_res.running      = true;
+    g_res.seconds      = seconds;
+    g_res.rate         = rate > WSB_MAX_RATE ? WSB_MAX_RATE : rate;
+    g_res.size         = (uint16_t)constrain(size, WSB_MIN_SIZE, WSB_MAX_SIZE);
+    g_res.minClients   = 0xFF;
+    g_res.loopHzBefore = cpu_getSample().loopHz;
+    g_ticksLeft = (uint32_t)seconds * TICKS_PER_SEC;
+    g_tick      = 0;
+    g_credit    = 0;
+
+    btWebUI_resetWsStats();
+    btWebUI_log("[WSB] start " + String(seconds) + "s, " + String(g_res.rate) + " msg/s x " +
+                String(g_res.size) + " B", LogLevel::INFO);
+    timer_restart(g_tickTimer, onTick, TICK_MS, TICK_MS);
+    return true;
+}
+
+void ws_bench_stop() {
+    if (!g_res.running) return;
+    timer_cancel(g_tickTimer);
+    g_res.running = false;
+    if (g_res.minClients == 0xFF) g_res.minClients = 0;
+    const WsFanoutStats &ws = btWebUI_getWsStats();
+    btWebUI_log("[WSB] done: sent=" + String(g_res.sent) +
+                " clients=" + String(g_res.minClients) + ".." + String(g_res.maxClients) +
+                " sendFails=" + String(ws.sendFails) +
+                " maxBcastUs=" + String(ws.maxBroadcastUs), LogLevel::INFO);
+}
+
+const WsBenchResult &ws_bench_getResult() { return g_res; }
@@ -0,0 +1,42 @@
+/**
+ * @file ws_bench.h
+ * @brief WebSocket fan-out benchmark
+ *
+ * Broadcasts numbered messages "[WSB] <seq> <micros> ...." at a fixed rate
+ * and size to every connected WS client, through the same send path as the
+ * log. Clients (tools/ws_swarm.py) count sequence gaps and per-message
+ * delay; the firmware side reports what each broadcast cost the loop:
+ * per-client send time and failures (btWebUI_getWsStats()) and the loop
+ * rate before and during the run (cpu_getSample().loopHz).
+ *
+ * Run it with 1..WS_MAX_CLIENTS clients and increasing rates to see where
+ * sends start blocking or failing — that is the budget for per-client
+ * queues and the log rate limit.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+static const uint16_t WSB_MAX_RATE = 500;   // сообщений/с (тик 10ms)
+static const uint16_t WSB_MIN_SIZE = 32;
+static const uint16_t WSB_MAX_SIZE = 1024;
+
+struct WsBenchResult {
+    bool     running;
+    uint16_t rate;              // сообщений/с
+    uint16_t size;              // байт в сообщении
+    uint16_t seconds;
+    uint32_t sent;              // сообщений разослано (seq последнего + 1)
+    uint8_t  minClients;        // клиентов во время прогона
+    uint8_t  maxClients;
+    uint32_t loopHzBefore;      // проходов loop()/с до старта
+    uint32_t loopHzMin;         // худшая секунда во время прогона
+    uint32_t loopHzSum;
+    uint16_t loopSamples;
+};
+
+// Запустить на seconds секунд (rate, size ограничиваются пределами выше)
+bool ws_bench_start(uint16_t seconds, uint16_t rate, uint16_t size);
+void ws_bench_stop();
+
+const WsBenchResult &ws_bench_getResult();
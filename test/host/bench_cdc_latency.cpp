@@ -0,0 +1,148 @@
+/**
+ * @file bench_cdc_latency.cpp
+ * @brief Change-to-wire latency of CDC event frames, simulated on the host
+ *        around the firmware's own scheduler (src/loop_sched.cpp)
+ *
+ * The real sched_loop() / sched_expedite() run against a simulated clock.
+ * The steps are registered the way main.cpp registers them, and each
+ * step advances the clock by a modelled cost:
+ *   cdc_frame  8 × (128 µs SPI + byte gap)  — 8.0 ms RNS-MFD, 9.0 ms Skoda
+ *   bt         50..300 µs   cdc_rx 20 µs   timers 10 µs   scenario 10 µs
+ *   main       50 µs; a track/SCAN/MIX change lands here, on average every
+ *              700 ms, through the same markDisplayDirty() logic as vw_cdc.cpp
+ *   web        BEST_EFFORT, 0.2..15 ms (HTTP / WebSocket work)
+ * and cdc_frame records "change → start of the frame" exactly as
+ * cdc_sendFrame() does, with event frames on (sched_expedite, min gap)
+ * and off (wait for the 50 ms slot).
+ *
+ * This measures the scheduling policy, not the board: WiFi interrupts,
+ * flash cache misses and real step costs only show up in /api/cdc/latency
+ * on the target.
+ *
+ * Build and run: make -C test/host bench
+ */
+
+#include "loop_sched.h"
+#include "bt_webui.h"
+#include <cstdio>
+
+// ---------- simulated time ----------
+static uint64_t g_nowUs = 0;
+uint32_t micros() { return (uint32_t)g_nowUs; }
+uint32_t millis() { return (uint32_t)(g_nowUs / 1000); }
+void btWebUI_log(const String &, LogLevel) {}
+
+static uint32_t g_rng = 12345;
+static uint32_t rnd(uint32_t lo, uint32_t hi) {  // [lo, hi]
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return lo + (g_rng >> 8) % (hi - lo + 1);
+}
+
+// ---------- vw_cdc.cpp: event frame and latency bookkeeping ----------
+static const uint8_t LAT_BINS = 64;  // как CDC_LAT_BINS
+static bool     g_eventFrames;
+static bool     g_dirty;
+static uint32_t g_dirtySinceUs;
+static uint32_t g_minGapMs;
+static uint32_t g_frameUs;
+static uint32_t g_hist[LAT_BINS];
+static uint32_t g_changes, g_maxUs;
+static uint64_t g_sumUs;
+
+static void cdcFrame() {
+    if (g_dirty) {
+        g_dirty = false;
+        uint32_t us = micros() - g_dirtySinceUs;
+        uint32_t bin = us / 1000;
+        g_hist[bin < LAT_BINS ? bin : LAT_BINS - 1]++;
+        g_changes++;
+        g_sumUs += us;
+        if (us > g_maxUs) g_maxUs = us;
+    }
+    g_nowUs += g_frameUs;
+}
+
+static void markDisplayDirty() {
+    if (!g_dirty) {
+        g_dirty = true;
+        g_dirtySinceUs = micros();
+    }
+    if (g_eventFrames) sched_expedite(cdcFrame, g_minGapMs * 1000);
+}
+
+// ---------- other loop steps ----------
+static uint64_t g_nextChangeUs;
+static void btStep()       { g_nowUs += rnd(50, 300); }
+static void cdcRxStep()    { g_nowUs += 20; }
+static void timersStep()   { g_nowUs += 10; }
+static void scenarioStep() { g_nowUs += 10; }
+static void webStep()      { g_nowUs += rnd(200, 15000); }
+static void mainStep() {
+    g_nowUs += 50;
+    if (g_nowUs >= g_nextChangeUs) {
+        markDisplayDirty();
+        g_nextChangeUs = g_nowUs + rnd(100000, 1300000);
+    }
+}
+
+static uint8_t percentileMs(uint8_t pct) {  // как cdc_latencyPercentileMs()
+    uint32_t acc = 0;
+    for (uint8_t i = 0; i < LAT_BINS; ++i) {
+        acc += g_hist[i];
+        if ((uint64_t)acc * 100 >= (uint64_t)g_changes * pct) return i + 1;
+    }
+    return LAT_BINS;
+}
+
+// Планировщик — статический модуль: шаги регистрируются один раз,
+// между прогонами сбрасываются статистика и состояние модели
+static void run(const char *profile, uint32_t byteGapUs, uint32_t minGapMs, bool eventFrames,
+                uint32_t simSeconds) {
+    g_frameUs = 8 * (128 + byteGapUs);
+    g_minGapMs = minGapMs;
+    g_eventFrames = eventFrames;
+    g_dirty = false;
+    g_changes = g_maxUs = 0;
+    g_sumUs = 0;
+    memset(g_hist, 0, sizeof(g_hist));
+    g_rng = 12345;
+    g_nextChangeUs = g_nowUs + 500000;
+    sched_resetStats();
+
+    uint64_t end = g_nowUs + (uint64_t)simSeconds * 1000000;
+    while (g_nowUs < end) {
+        uint64_t before = g_nowUs;
+        sched_loop();
+        if (g_nowUs == before) g_nowUs += 5;  // пустой проход loop() тоже стоит времени
+    }
+
+    const SchedStep *frame = sched_getStep(0);
+    const SchedStep *web = sched_getStep(6);
+    std::printf("%-8s %-5s %7lu %7.1f %4u %4u %7.1f %6.1f %6lu %7.1f\n",
+                profile, eventFrames ? "on" : "off", (unsigned long)g_changes,
+                g_changes ? g_sumUs / 1000.0 / g_changes : 0.0,
+                percentileMs(50), percentileMs(99), g_maxUs / 1000.0,
+                frame->runs / (double)simSeconds, (unsigned long)frame->misses,
+                web->runs / (double)simSeconds);
+}
+
+int main() {
+    // Порядок и классы — как в main.cpp; номер шага 0 — кадр, 6 — web
+    sched_addStep("cdc_frame", cdcFrame,     StepClass::HARD, 50, 5000, 9000);
+    sched_addStep("bt",        btStep,       StepClass::ASAP, 0, 0, 2000);
+    sched_addStep("cdc_rx",    cdcRxStep,    StepClass::ASAP, 0, 0, 2000);
+    sched_addStep("timers",    timersStep,   StepClass::ASAP, 0, 0, 1000);
+    sched_addStep("main",      mainStep,     StepClass::ASAP, 0, 0, 1000);
+    sched_addStep("scenario",  scenarioStep, StepClass::ASAP, 0, 0, 1000);
+    sched_addStep("web",       webStep,      StepClass::BEST_EFFORT, 0, 0, 20000);
+
+    const uint32_t SIM_S = 3600;
+    std::printf("simulated %u s per row; latency = change -> start of the frame on the bus\n", (unsigned)SIM_S);
+    std::printf("%-8s %-5s %7s %7s %4s %4s %7s %6s %6s %7s\n",
+                "profile", "event", "changes", "avg ms", "p50", "p99", "max ms", "fr/s", "misses", "web/s");
+    run("RNS-MFD", 874,  20, false, SIM_S);
+    run("RNS-MFD", 874,  20, true,  SIM_S);
+    run("Skoda",   1000, 30, false, SIM_S);
+    run("Skoda",   1000, 30, true,  SIM_S);
+    return 0;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file bench_profiles.cpp
+ * @brief Host cost of the DataOut path in the release and debug profiles
+ *
+ * Built twice by the Makefile with the flags of the platformio.ini
+ * environments: bench_profile_release (-O2, FW_DEBUG=0) and
+ * bench_profile_debug (-Os, FW_DEBUG=1). Printed per edge, on a stream of
+ * valid VW DataOut packets:
+ *   isr       — the body of vw_dataout_edge() (vw_cdc.cpp): edge ring push,
+ *               plus the edge counters and RAW sniffer push in debug
+ *   decode    — PulseDeglitcher + DataOutDecoderMux (VW + NEC) from
+ *               dataout_decoder.cpp, with the cycle clock set in debug
+ *   idle poll — a cdc_poll() pass with no edges: the loop-rate cost
+ *
+ * The ISR body is copied here (it is static in vw_cdc.cpp) — keep the two
+ * in sync. The cycle clock is rdtsc on x86, far dearer than the one-cycle
+ * ccount read on the ESP32, so the debug decode overhead is overstated.
+ * Only the ratio between the profiles means anything; ISR cost on the
+ * target is /api/build and /api/bench/isr.
+ *
+ * Build and run: make -C test/host bench
+ */
+
+#include "ring_buffer.h"
+#include "dataout_decoder.h"
+#include "build_config.h"
+#include <chrono>
+#include <cstdio>
+
+#define IRAM_ATTR
+
+typedef std::chrono::steady_clock Clock;
+
+// ---------- vw_cdc.cpp: DataOut ISR ----------
+static uint32_t g_fakeUs = 0;
+static bool     g_fakeLevel = false;
+static const uint32_t *g_pulse;   // длительности, которые «увидит» ISR
+static uint32_t g_pulseIdx, g_pulseCount;
+
+static inline uint32_t micros_() { return g_fakeUs; }
+static inline bool digitalRead_() { return g_fakeLevel; }
+
+static SpscRing<uint32_t, 128> vw_edgeBuf;
+static volatile uint32_t vw_lastEdge = 0;
+static volatile bool     vw_haveEdge = false;
+static volatile uint32_t vw_isr_counter = 0;
+#if FW_DEBUG
+static SpscRing<uint16_t, 64> g_rawBuf;
+static volatile uint32_t vw_falling_edges = 0;
+static volatile uint32_t vw_rising_edges = 0;
+
+static void IRAM_ATTR log_raw_pulse(uint32_t dur) {
+    if (dur > 60000) dur = 60000;
+    g_rawBuf.push((uint16_t)dur);
+}
+static void processRawLog() {
+    if (g_rawBuf.empty()) return;
+    g_rawBuf.clear();  // никто не подписан на RAW — обычный случай
+}
+static uint32_t cycleClock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__builtin_ia32_rdtsc();
+#else
+    return (uint32_t)Clock::now().time_since_epoch().count();
+#endif
+}
+#else
+static inline void log_raw_pulse(uint32_t) {}
+static inline void processRawLog() {}
+#endif
+
+static inline void IRAM_ATTR vw_dataout_edge() {
+    vw_isr_counter++;
+
+    uint32_t now = micros_();
+    bool level = digitalRead_();
+
+    bool pulseHigh = !level;
+    uint32_t dur = now - vw_lastEdge;
+    vw_lastEdge = now;
+
+#if FW_DEBUG
+    if (level) vw_rising_edges++;
+    else       vw_falling_edges++;
+#endif
+
+    if (!vw_haveEdge) {
+        vw_haveEdge = true;
+        return;
+    }
+
+    if (!pulseHigh) log_raw_pulse(dur);
+
+    if (dur > 0x7FFFFFFF) dur = 0x7FFFFFFF;
+    vw_edgeBuf.push(dur | (pulseHigh ? 0x80000000UL : 0));
+}
+
+// ---------- vw_cdc.cpp: loop side ----------
+static PulseDeglitcher   g_deglitch;
+static VwDataOutDecoder  g_vwDecoder;
+static NecDecoder        g_necDecoder;
+static DataOutDecoderMux g_decoders;
+static uint32_t          g_packets = 0;
+
+static bool validate(const uint8_t pkt[4]) {
+    return pkt[0] == 0x53 && pkt[1] == 0x2C && (uint8_t)(pkt[2] + pkt[3]) == 0xFF;
+}
+
+static void pollDecoders() {
+    PulseDeglitcher::Pulse p[3];
+    uint32_t e;
+    while (vw_edgeBuf.pop(e)) {
+        uint8_t n = g_deglitch.feed((e & 0x80000000UL) != 0, e & 0x7FFFFFFF, p);
+        for (uint8_t i = 0; i < n; ++i) {
+            uint8_t pkt[4], src;
+            if (g_decoders.feed(p[i].level, p[i].us, pkt, src)) g_packets++;
+        }
+    }
+}
+
+static void cdcPoll() {
+    processRawLog();
+    pollDecoders();
+}
+
+// ---------- стимул: пакеты VW DataOut (чередуются LOW / HIGH) ----------
+static uint32_t g_stream[2 + 32 * 2 + 2];
+static uint32_t buildPacket(const uint8_t pkt[4]) {
+    uint32_t n = 0;
+    g_stream[n++] = 4570;  // start LOW
+    g_stream[n++] = 4500;  // HIGH
+    for (uint8_t b = 0; b < 32; ++b) {
+        bool one = (pkt[b / 8] >> (7 - b % 8)) & 1;
+        g_stream[n++] = one ? 1770 : 650;
+        g_stream[n++] = 550;
+    }
+    g_stream[n - 1] = 30000;  // пауза до следующего пакета
+    return n;
+}
+
+// Следующий фронт: линия меняет уровень после очередного импульса
+static inline void nextEdge() {
+    g_fakeUs += g_pulse[g_pulseIdx];
+    if (++g_pulseIdx == g_pulseCount) g_pulseIdx = 0;
+    g_fakeLevel = !g_fakeLevel;
+}
+
+static double nsPer(Clock::time_point t0, uint64_t n) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / n;
+}
+
+static volatile uint32_t g_sink;
+
+int main() {
+    g_deglitch.setLimit(80);
+    g_decoders.add(&g_vwDecoder);
+    g_decoders.add(&g_necDecoder);
+    g_decoders.setValidator(validate);
+#if FW_DEBUG
+    g_decoders.setClock(cycleClock);
+#endif
+    g_decoders.reset();
+
+    static const uint8_t PKT[4] = { 0x53, 0x2C, 0x0C, 0xF3 };  // CD1
+    g_pulse = g_stream;
+    g_pulseCount = buildPacket(PKT);
+    // Уровень — после фронта: первый фронт заканчивает LOW start bit
+    g_fakeLevel = false;
+
+    const uint32_t BATCH = 64;  // loop разбирает ring раньше, чем он заполнится
+    const uint32_t ROUNDS = 200000;
+
+    // isr: только ISR, ring опустошается вне замера
+    double isrNs = 0;
+    for (uint32_t r = 0; r < ROUNDS; ++r) {
+        auto t0 = Clock::now();
+        for (uint32_t k = 0; k < BATCH; ++k) { nextEdge(); vw_dataout_edge(); }
+        isrNs += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+        cdcPoll();
+    }
+    isrNs /= (double)ROUNDS * BATCH;
+
+    // decode: разбор тех же фронтов в loop
+    double decodeNs = 0;
+    for (uint32_t r = 0; r < ROUNDS; ++r) {
+        for (uint32_t k = 0; k < BATCH; ++k) { nextEdge(); vw_dataout_edge(); }
+        auto t0 = Clock::now();
+        cdcPoll();
+        decodeNs += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    }
+    decodeNs /= (double)ROUNDS * BATCH;
+
+    // idle poll: проход loop без фронтов
+    const uint32_t IDLE = 50000000;
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < IDLE; ++i) cdcPoll();
+    double idleNs = nsPer(t0, IDLE);
+
+    g_sink = g_packets;
+    std::printf("profile %-7s  isr %6.2f ns/edge  decode %6.2f ns/edge  idle poll %5.2f ns  (%u packets, %u valid)\n",
+                FW_PROFILE_NAME, isrNs, decodeNs, idleNs, (unsigned)g_packets,
+                (unsigned)g_vwDecoder.stats.valid);
+    return g_packets ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file bench_ring_buffer.cpp
+ * @brief Host throughput benchmark for src/ring_buffer.h (Linux, g++)
+ *
+ * Single thread, push + pop of uint32_t in batches of half the capacity:
+ * the cost of the ring itself — atomics, masking, the CAS of MpscRing —
+ * without contention. Then SpscRing and MpscRing with producer threads,
+ * where the result depends on the host's cores (on one core it measures
+ * mostly context switches).
+ *
+ * Host numbers only compare the rings with each other; the cost on the
+ * ESP32 is what isr_bench (/api/bench/isr) measures on the target.
+ *
+ * Build and run: make -C test/host bench
+ */
+
+#include "ring_buffer.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint32_t OPS = 20000000;
+
+static double nsPerOp(Clock::time_point t0, uint32_t ops) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / ops;
+}
+
+static void report(const char *name, double ns) {
+    std::printf("%-34s %7.2f ns/op  %8.1f Mops/s\n", name, ns, 1000.0 / ns);
+}
+
+static volatile uint32_t g_sink;
+
+template <typename Ring>
+static void benchSingle(const char *name) {
+    static Ring r;
+    const uint32_t batch = Ring::CAPACITY / 2;
+    uint32_t v = 0, sum = 0;
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < OPS; i += batch) {
+        for (uint32_t k = 0; k < batch; ++k) r.push(i + k);
+        for (uint32_t k = 0; k < batch; ++k) { r.pop(v); sum += v; }
+    }
+    report(name, nsPerOp(t0, OPS));
+    g_sink = sum;
+}
+
+static void benchOverwrite() {
+    static OverwriteRing<uint32_t, 128> r;
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < OPS; ++i) r.push(i);
+    report("OverwriteRing<128> push", nsPerOp(t0, OPS));
+    g_sink = r.newest();
+}
+
+template <typename Ring>
+static void benchThreads(const char *name, uint32_t producers) {
+    static Ring r;
+    const uint32_t per = OPS / 4 / producers;
+    auto t0 = Clock::now();
+    std::vector<std::thread> prods;
+    for (uint32_t p = 0; p < producers; ++p) {
+        prods.emplace_back([per] {
+            for (uint32_t i = 0; i < per; ) {
+                if (r.push(i)) ++i;
+                else std::this_thread::yield();
+            }
+        });
+    }
+    uint32_t got = 0, v;
+    while (got < per * producers) {
+        if (r.pop(v)) got++;
+        else std::this_thread::yield();
+    }
+    for (auto &t : prods) t.join();
+    char label[64];
+    std::snprintf(label, sizeof(label), "%s, %u producer%s", name, (unsigned)producers, producers > 1 ? "s" : "");
+    report(label, nsPerOp(t0, got));
+}
+
+int main() {
+    std::printf("host: %u hardware threads\n", std::thread::hardware_concurrency());
+    benchSingle<SpscRing<uint32_t, 256>>("SpscRing<256> push+pop");
+    benchSingle<MpscRing<uint32_t, 256>>("MpscRing<256> push+pop");
+    benchOverwrite();
+    benchThreads<SpscRing<uint32_t, 1024>>("SpscRing<1024> threads", 1);
+    benchThreads<MpscRing<uint32_t, 1024>>("MpscRing<1024> threads", 1);
+    benchThreads<MpscRing<uint32_t, 1024>>("MpscRing<1024> threads", 4);
+    return 0;
+}
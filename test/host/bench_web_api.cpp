@@ -0,0 +1,89 @@
+/**
+ * @file bench_web_api.cpp
+ * @brief Host CPU / heap benchmark of the web_api.cpp routes (Linux, g++)
+ *
+ * Every route is called with typical backend data (a playing track with
+ * metadata, four scheduler steps, a full session ring). Printed per route:
+ * time per call, heap allocations per call (String growth while the JSON
+ * is concatenated) and the allocated bytes, plus the response size.
+ * Allocations are counted by replacing the global operator new.
+ *
+ * The host String grows like std::string, not like the core's String, so
+ * the allocation counts show which routes churn the heap and how that
+ * changes between versions — not the exact numbers on the ESP32.
+ *
+ * Build and run: make -C test/host bench
+ */
+
+#include "web_api.h"
+#include "mock_backends.h"
+#include <chrono>
+#include <new>
+
+static size_t g_allocs = 0;
+static size_t g_allocBytes = 0;
+
+void *operator new(size_t n) {
+    g_allocs++;
+    g_allocBytes += n;
+    void *p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+class NoArgs : public ApiRequest {
+public:
+    String arg(const char *) const override { return String(); }
+    bool hasArg(const char *) const override { return false; }
+};
+
+static void fillTypical() {
+    mock_reset();
+    mock_setMillis(3600000);
+    g_mock.state = BTConnState::PLAYING;
+    g_mock.identity.valid = true;
+    g_mock.identity.version = "V1.3.2";
+    g_mock.identity.address = "A1B2C3D4E5F6";
+    g_mock.track.title = "Song title with some length";
+    g_mock.track.artist = "Artist";
+    g_mock.track.album = "Album name";
+    g_mock.track.valid = true;
+    static const char *const STEPS[4] = { "cdc_frame", "bt", "timers", "web" };
+    g_mock.stepCount = 4;
+    for (uint8_t i = 0; i < 4; ++i) {
+        g_mock.steps[i] = SchedStep();
+        g_mock.steps[i].name = STEPS[i];
+        g_mock.steps[i].runs = 123456;
+        g_mock.steps[i].totalRunUs = 9876543;
+    }
+    g_mock.cpu.stepCount = 4;
+    g_mock.sessionCount = SESS_SLOTS;
+    for (uint8_t i = 0; i < SESS_SLOTS; ++i) g_mock.sessions[i].seq = 100 - i;
+    uint8_t pkt[4];
+    for (int i = 0; i < 1000; ++i) g_mock.vw.feed(false, i & 1 ? 650 : 1770, pkt);
+}
+
+int main() {
+    fillTypical();
+    size_t count = 0;
+    const ApiRoute *routes = webApi_routes(count);
+    NoArgs req;
+    const int ITER = 20000;
+
+    std::printf("%-20s %9s %8s %9s %7s\n", "route", "us/call", "allocs", "bytes", "resp");
+    for (size_t i = 0; i < count; ++i) {
+        size_t a0 = g_allocs, b0 = g_allocBytes, resp = 0;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < ITER; ++k) {
+            ApiResponse res;
+            webApi_dispatch(routes[i].path, req, res);
+            resp = res.body.length();
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / ITER;
+        std::printf("%-20s %9.2f %8.1f %9.0f %7zu\n", routes[i].path, us,
+                    (double)(g_allocs - a0) / ITER, (double)(g_allocBytes - b0) / ITER, resp);
+    }
+    return 0;
+}
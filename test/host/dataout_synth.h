@@ -0,0 +1,64 @@
+/**
+ * @file dataout_synth.h
+ * @brief Synthetic VW DataOut pulse streams with HIGH noise spikes
+ *
+ * Used by test_dataout_decoder (replay with and without PulseDeglitcher)
+ * and by gen_dataout_capture (the same stream as a CSV for
+ * tools/cdc_capture). Levels alternate the way the edge ISR delivers them.
+ * Deterministic for a given seed.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+struct SynthPulse {
+    bool     level;  // уровень линии во время импульса
+    uint32_t us;
+};
+
+struct SynthStats {
+    uint32_t packets = 0;
+    uint32_t lowBits = 0;
+    uint32_t spiked  = 0;  // LOW-битов, разорванных иголкой
+};
+
+// Кнопки RNS-MFD (cmdcode), пакеты идут по кругу
+static const uint8_t SYNTH_CMDS[] = { 0x0C, 0x8C, 0x4C, 0xF8, 0x78, 0xA0, 0x60 };
+
+// packets пакетов VW (адрес 0x53 0x2C); в spikePermille ‰ LOW-битов посреди
+// LOW стоит HIGH-иголка spikeUs. Между пакетами линия 30 ms в HIGH.
+inline std::vector<SynthPulse> synthVwStream(uint32_t packets, uint32_t spikePermille, uint32_t spikeUs,
+                                             uint32_t seed, SynthStats *st = nullptr) {
+    std::vector<SynthPulse> s;
+    uint32_t rng = seed ? seed : 1;
+    SynthStats local;
+    for (uint32_t n = 0; n < packets; ++n) {
+        uint8_t cmd = SYNTH_CMDS[n % sizeof(SYNTH_CMDS)];
+        const uint8_t pkt[4] = { 0x53, 0x2C, cmd, (uint8_t)~cmd };
+        s.push_back({ true, 30000 });
+        s.push_back({ false, 4570 });
+        for (uint8_t b = 0; b < 32; ++b) {
+            bool one = (pkt[b / 8] >> (7 - b % 8)) & 1;
+            uint32_t low = one ? 1770 : 650;
+            s.push_back({ true, 550 });
+            local.lowBits++;
+            rng = rng * 1664525u + 1013904223u;
+            if ((rng >> 8) % 1000 < spikePermille) {
+                // Иголка в случайном месте, куски LOW не короче 100 µs
+                rng = rng * 1664525u + 1013904223u;
+                uint32_t a = 100 + (rng >> 8) % (low - 200 - spikeUs);
+                s.push_back({ false, a });
+                s.push_back({ true, spikeUs });
+                s.push_back({ false, low - a - spikeUs });
+                local.spiked++;
+            } else {
+                s.push_back({ false, low });
+            }
+        }
+        local.packets++;
+    }
+    s.push_back({ true, 30000 });
+    if (st) *st = local;
+    return s;
+}
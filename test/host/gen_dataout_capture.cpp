@@ -0,0 +1,56 @@
+/**
+ * @file gen_dataout_capture.cpp
+ * @brief Writes a synthetic DataOut capture (Saleae CSV) for tools/cdc_capture
+ *
+ * VW button packets with HIGH noise spikes inside LOW bits (dataout_synth.h),
+ * one row per transition: "Time [s],SCK,MOSI,DataOut". SCK and MOSI stay
+ * idle. Replay with and without the deglitch filter:
+ *
+ *   gen_dataout_capture --packets=40 --spike-permille=30 > spiked.csv
+ *   cdc_capture --quiet --deglitch=0  spiked.csv
+ *   cdc_capture --quiet --deglitch=80 spiked.csv
+ *
+ * Build: make -C test/host   (build/gen_dataout_capture)
+ */
+
+#include "dataout_synth.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv) {
+    uint32_t packets = 40, permille = 10, spikeUs = 20, seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *v = strchr(a, '=');
+        v = v ? v + 1 : "";
+        if      (!strncmp(a, "--packets=", 10))        packets = (uint32_t)atoi(v);
+        else if (!strncmp(a, "--spike-permille=", 17)) permille = (uint32_t)atoi(v);
+        else if (!strncmp(a, "--spike-us=", 11))       spikeUs = (uint32_t)atoi(v);
+        else if (!strncmp(a, "--seed=", 7))            seed = (uint32_t)atoi(v);
+        else {
+            fprintf(stderr, "usage: gen_dataout_capture [--packets=40] [--spike-permille=10]"
+                            " [--spike-us=20] [--seed=1] > capture.csv\n");
+            return 2;
+        }
+    }
+    if (spikeUs == 0 || spikeUs > 400) {
+        fprintf(stderr, "--spike-us must be 1..400\n");
+        return 2;
+    }
+
+    SynthStats st;
+    std::vector<SynthPulse> s = synthVwStream(packets, permille, spikeUs, seed, &st);
+
+    // Строка = переход: время начала импульса и уровень на нём
+    printf("Time [s],SCK,MOSI,DataOut\n");
+    uint64_t tUs = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        printf("%.6f,0,0,%d\n", tUs / 1e6, s[i].level ? 1 : 0);
+        tUs += s[i].us;
+    }
+    printf("%.6f,0,0,1\n", tUs / 1e6);
+    fprintf(stderr, "%u packets, %u of %u LOW bits spiked (%u us)\n",
+            st.packets, st.spiked, st.lowBits, spikeUs);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the parts of the Arduino-ESP32 core the
+ *        transport-independent modules use (String, millis, Serial types)
+ *
+ * Only what web_api.cpp and the headers it includes need. String follows
+ * the core's formatting: integers in the given base, floats as "%.*f"
+ * (dtostrf) — so NaN/inf come out as "nan"/"inf", exactly as on the target.
+ * millis() is driven by the test (mock_setMillis()).
+ */
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define PROGMEM
+#define F(s) (s)
+#define HEX 16
+#define DEC 10
+
+class String {
+public:
+    String() {}
+    String(const char *c) : m_s(c ? c : "") {}
+    String(char c) : m_s(1, c) {}
+    String(int v, unsigned char base = 10)           { fmtSigned(v, base); }
+    String(long v, unsigned char base = 10)          { fmtSigned(v, base); }
+    String(unsigned char v, unsigned char base = 10) { fmtUnsigned(v, base); }
+    String(unsigned int v, unsigned char base = 10)  { fmtUnsigned(v, base); }
+    String(unsigned long v, unsigned char base = 10) { fmtUnsigned(v, base); }
+    String(long long v)                              { m_s = std::to_string(v); }
+    String(unsigned long long v)                     { m_s = std::to_string(v); }
+    String(float v, unsigned int decimals = 2)       { fmtFloat(v, decimals); }
+    String(double v, unsigned int decimals = 2)      { fmtFloat(v, decimals); }
+
+    unsigned int length() const { return (unsigned int)m_s.size(); }
+    const char  *c_str() const  { return m_s.c_str(); }
+    bool reserve(unsigned int n) { m_s.reserve(n); return true; }
+
+    char operator[](unsigned int i) const { return i < m_s.size() ? m_s[i] : 0; }
+    char charAt(unsigned int i) const     { return (*this)[i]; }
+
+    bool concat(const String &o)              { m_s += o.m_s; return true; }
+    bool concat(const char *c)                { if (c) m_s += c; return c != nullptr; }
+    bool concat(const char *c, unsigned int n){ m_s.append(c, n); return true; }
+    bool concat(char c)                       { m_s += c; return true; }
+
+    String &operator+=(const String &o) { concat(o); return *this; }
+    String &operator+=(const char *c)   { concat(c); return *this; }
+    String &operator+=(char c)          { concat(c); return *this; }
+
+    friend String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+    friend String operator+(const String &a, const char *b)   { String r(a); r += b; return r; }
+    friend String operator+(const char *a, const String &b)   { String r(a); r += b; return r; }
+    friend String operator+(const String &a, char b)          { String r(a); r += b; return r; }
+
+    bool operator==(const String &o) const { return m_s == o.m_s; }
+    bool operator==(const char *c) const   { return m_s == (c ? c : ""); }
+    bool operator!=(const String &o) const { return !(*this == o); }
+    bool operator!=(const char *c) const   { return !(*this == c); }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t p = m_s.find(c, from);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    int indexOf(const String &s, unsigned int from = 0) const {
+        size_t p = m_s.find(s.m_s, from);
+        return p == std::string::npos ? -1 : (int)p;
+    }
+    bool startsWith(const String &p) const { return m_s.compare(0, p.m_s.size(), p.m_s) == 0; }
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) { unsigned int t = from; from = to; to = t; }
+        if (from >= m_s.size()) return String();
+        if (to > m_s.size()) to = (unsigned int)m_s.size();
+        String r;
+        r.m_s = m_s.substr(from, to - from);
+        return r;
+    }
+    long toInt() const { return atol(m_s.c_str()); }
+
+private:
+    void fmtSigned(long v, unsigned char base) {
+        if (base == 10) { m_s = std::to_string(v); return; }
+        fmtUnsigned((unsigned long)v, base);
+    }
+    void fmtUnsigned(unsigned long v, unsigned char base) {
+        if (base < 2 || base > 36) base = 10;
+        char buf[8 * sizeof(long) + 1];
+        char *p = buf + sizeof(buf) - 1;
+        *p = 0;
+        do {
+            unsigned d = v % base;
+            *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+            v /= base;
+        } while (v);
+        m_s = p;
+    }
+    void fmtFloat(double v, unsigned int decimals) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+        m_s = buf;
+    }
+
+    std::string m_s;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t print(const char *s)   { size_t n = 0; while (*s) n += write((uint8_t)*s++); return n; }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+};
+
+class HardwareSerial : public Stream {};
+
+uint32_t millis();
+uint32_t micros();
@@ -0,0 +1,2 @@
+// Host stand-in: nothing from ElegantOTA is used by the host-built modules
+#pragma once
@@ -0,0 +1,3 @@
+// Host stand-in: bt_webui.h only declares `extern WebServer webServer;`
+#pragma once
+class WebServer;
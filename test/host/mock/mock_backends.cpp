@@ -0,0 +1,175 @@
+#include "mock_backends.h"
+#include "cdc_profile.h"
+#include "timer_wheel.h"
+#include "bt_scenarios.h"
+
+MockBackend g_mock;
+bool g_debugMode = false;
+
+static uint32_t g_millis = 0;
+
+uint32_t millis() { return g_millis; }
+uint32_t micros() { return g_millis * 1000; }
+void mock_setMillis(uint32_t ms) { g_millis = ms; }
+
+static void noStep() {}
+
+void mock_reset() {
+    g_mock = MockBackend();
+    g_mock.state = BTConnState::DISCONNECTED;
+    g_mock.identity.valid = false;
+    g_mock.stepCount = 1;
+    g_mock.steps[0] = SchedStep();
+    g_mock.steps[0].name = "cdc_frame";
+    g_mock.steps[0].fn = noStep;
+    g_mock.steps[0].cls = StepClass::HARD;
+    g_mock.timersNextMs = UINT32_MAX;
+    g_mock.lockedDecoder = -1;
+    g_mock.cpu.stepCount = 1;
+    for (uint8_t i = 0; i < 3; ++i) {
+        static const char *const NAMES[3] = { "pairing", "connect", "factory" };
+        g_mock.scenarios[i] = Scenario();
+        g_mock.scenarios[i].name = NAMES[i];
+        g_mock.scenarios[i].failReason = "";
+    }
+    g_debugMode = false;
+}
+
+// ---------- bt1036_at ----------
+BTConnState      bt1036_getState()                { return g_mock.state; }
+BtDevStat        bt1036_getDevStat()              { return g_mock.devStat; }
+BtModuleIdentity bt1036_getIdentity()             { return g_mock.identity; }
+String           bt1036_getUnsupportedCommands()  { return g_mock.unsupported; }
+TrackInfo        bt1036_getTrackInfo()            { return g_mock.track; }
+bool             bt1036_getBackgroundPoll()       { return !atb_active(); }
+
+void bt1036_setName(const String &name, bool)    { g_mock.lastName = name; }
+void bt1036_setBLEName(const String &name, bool) { g_mock.lastBleName = name; }
+void bt1036_setCod(const String &cod)            { g_mock.lastCod = cod; }
+void bt1036_setHfpSampleRate(uint32_t rate)      { g_mock.lastHfpRate = rate; }
+void bt1036_setHfpConfig(uint8_t)                {}
+void bt1036_setProfile(uint16_t mask)            { g_mock.lastProfile = mask; }
+void bt1036_setAutoconn(uint16_t)                {}
+void bt1036_setMicGain(uint8_t)                  {}
+void bt1036_setSpkVol(uint8_t, uint8_t)          {}
+void bt1036_setTxPower(uint8_t)                  {}
+void bt1036_nextTrack()                          { g_mock.commands++; }
+void bt1036_prevTrack()                          { g_mock.commands++; }
+void bt1036_connectLast()                        { g_mock.commands++; }
+void bt1036_disconnect()                         { g_mock.commands++; }
+void bt1036_startScan()                          { g_mock.commands++; }
+
+// ---------- at_bridge ----------
+bool                 atb_active()            { return g_mock.bridge.opens > g_mock.bridgeCloses; }
+void                 atb_close(const char *) { if (atb_active()) g_mock.bridgeCloses++; }
+const AtBridgeStats &atb_getStats()          { return g_mock.bridge; }
+uint8_t              atb_pending()           { return 0; }
+
+// ---------- play_state / track_sync ----------
+PlayState pstate_get()      { return PlayState::UNKNOWN; }
+PlayState pstate_reported() { return PlayState::UNKNOWN; }
+bool      pstate_pending()  { return false; }
+uint16_t  pstate_seq()      { return (uint16_t)g_mock.play.commands; }
+PlayState pstate_toggle()   { g_mock.toggles++; g_mock.play.commands++; return PlayState::PLAYING; }
+const PlayStateStats &pstate_getStats() { return g_mock.play; }
+const char *pstate_name(PlayState st) {
+    switch (st) {
+        case PlayState::STOPPED: return "STOPPED";
+        case PlayState::PAUSED:  return "PAUSED";
+        case PlayState::PLAYING: return "PLAYING";
+        default:                 return "UNKNOWN";
+    }
+}
+const TrackSyncStats &tsync_getStats() { return g_mock.tsync; }
+
+// ---------- vw_cdc / cdc_profile ----------
+static CdcProfileId g_profile = CdcProfileId::RNS_MFD;
+CdcProfileId cdc_getProfile()     { return g_profile; }
+const char  *cdc_getProfileName() { return "RNS-MFD"; }
+bool cdc_setProfile(CdcProfileId id) { g_profile = id; return true; }
+
+CdcBusStats              cdc_getBusStats()         { return g_mock.bus; }
+const CdcLatencyStats   &cdc_getLatencyStats()     { return g_mock.latency; }
+void                     cdc_resetLatencyStats()   { g_mock.latency = CdcLatencyStats(); }
+void                     cdc_setEventFrames(bool on) { g_mock.eventFrames = on; }
+bool                     cdc_getEventFrames()      { return g_mock.eventFrames; }
+uint32_t                 cdc_getMinFrameGapMs()    { return 10; }
+uint8_t cdc_latencyPercentileMs(uint8_t pct) {
+    const CdcLatencyStats &l = g_mock.latency;
+    if (!l.changes) return 0;
+    uint32_t need = (l.changes * pct + 99) / 100, seen = 0;
+    for (uint8_t b = 0; b < CDC_LAT_BINS; ++b) {
+        seen += l.hist[b];
+        if (seen >= need) return b + 1;
+    }
+    return CDC_LAT_BINS;
+}
+const VwDataOutDecoder &cdc_getVwDecoder()         { return g_mock.vw; }
+void                     cdc_resetSignalStats()    { g_mock.vw.resetSignalStats(); }
+uint8_t                  cdc_getDecoderCount()     { return 2; }
+int8_t                   cdc_getLockedDecoder()    { return g_mock.lockedDecoder; }
+uint32_t                 cdc_getEdgeOverflows()    { return g_mock.edgeOverflows; }
+bool cdc_getDecoderStats(uint8_t idx, const char *&name, DecoderStats &stats) {
+    const PulseDecoder *d = idx == 0 ? (const PulseDecoder *)&g_mock.vw : idx == 1 ? &g_mock.nec : nullptr;
+    if (!d) return false;
+    name  = d->name();
+    stats = d->stats;
+    return true;
+}
+uint32_t                 cdc_getDeglitchUs()       { return g_mock.deglitchUs; }
+uint32_t                 cdc_getDeglitchRepaired() { return 0; }
+void                     cdc_setDeglitchUs(uint16_t us) { g_mock.deglitchUs = us; }
+
+// ---------- loop_sched / timer_wheel ----------
+uint8_t          sched_getStepCount()     { return g_mock.stepCount; }
+const SchedStep *sched_getStep(uint8_t i) { return i < g_mock.stepCount ? &g_mock.steps[i] : nullptr; }
+uint32_t         sched_getPasses()        { return g_mock.steps[0].runs; }
+void             sched_resetStats()       {}
+uint32_t         sched_usUntilHard()      { return 0; }
+
+uint8_t  timer_getActiveCount()   { return 0; }
+uint8_t  timer_getPeak()          { return 0; }
+uint32_t timer_getFired()         { return 0; }
+uint32_t timer_getPoolExhausted() { return 0; }
+uint32_t timer_msUntilNext()      { return g_mock.timersNextMs; }
+
+// ---------- mem_governor / cpu_load ----------
+const MemStats &mem_getStats() { return g_mock.mem; }
+const char *mem_levelName(MemLevel level) {
+    static const char *const NAMES[MEM_LEVEL_COUNT] = { "NORMAL", "REPLAY", "NO_RAW", "NO_DEBUG", "NO_CLIENTS" };
+    return (uint8_t)level < MEM_LEVEL_COUNT ? NAMES[(uint8_t)level] : "?";
+}
+const CpuSample &cpu_getSample()   { return g_mock.cpu; }
+uint8_t          cpu_getLoopCore() { return 1; }
+uint32_t         cpu_getFreqMHz()  { return 240; }
+
+// ---------- scenario / bt_scenarios ----------
+uint8_t         sc_count()                     { return 3; }
+const Scenario *sc_get(uint8_t idx)            { return idx < 3 ? &g_mock.scenarios[idx] : nullptr; }
+bool            sc_running(const Scenario &sc) { return sc.status == ScStatus::RUNNING; }
+const char *sc_statusName(ScStatus s) {
+    switch (s) {
+        case ScStatus::IDLE:    return "IDLE";
+        case ScStatus::RUNNING: return "RUNNING";
+        case ScStatus::DONE:    return "DONE";
+        case ScStatus::FAILED:  return "FAILED";
+        case ScStatus::ABORTED: return "ABORTED";
+    }
+    return "?";
+}
+bool scen_pairing()              { return !g_mock.scenarioBusy; }
+bool scen_connectPlay(uint32_t)  { return !g_mock.scenarioBusy; }
+bool scen_factory()              { return !g_mock.scenarioBusy; }
+
+// ---------- session_log ----------
+bool sess_get(uint8_t age, SessionRecord &out) {
+    if (age >= g_mock.sessionCount) return false;
+    out = g_mock.sessions[age];
+    return true;
+}
+void        sess_clear()                   { g_mock.sessClears++; g_mock.sessionCount = 0; }
+uint32_t    sess_getWrites()               { return g_mock.sessionCount; }
+const char *sess_resetReasonName(uint8_t r) { return r == 1 ? "power-on" : "unknown"; }
+
+// ---------- bt_webui ----------
+void btWebUI_setDebug(bool on) { g_debugMode = on; }
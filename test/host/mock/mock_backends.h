@@ -0,0 +1,67 @@
+/**
+ * @file mock_backends.h
+ * @brief State behind the mocked bt1036_* / cdc_* / sched / mem / cpu /
+ *        scenario / session functions that web_api.cpp calls
+ *
+ * Tests fill g_mock (hostile strings, extreme counters) before calling
+ * webApi_dispatch() and read the recorded setter calls back from it.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include "bt1036_at.h"
+#include "vw_cdc.h"
+#include "dataout_decoder.h"
+#include "loop_sched.h"
+#include "mem_governor.h"
+#include "cpu_load.h"
+#include "track_sync.h"
+#include "play_state.h"
+#include "scenario.h"
+#include "at_bridge.h"
+#include "session_log.h"
+
+struct MockBackend {
+    // --- то, что отдают getter'ы ---
+    BTConnState      state;
+    BtDevStat        devStat;
+    BtModuleIdentity identity;
+    String           unsupported;
+    TrackInfo        track;
+    TrackSyncStats   tsync;
+    PlayStateStats   play;
+    AtBridgeStats    bridge;
+    CdcBusStats      bus;
+    CdcLatencyStats  latency;
+    VwDataOutDecoder vw;
+    NecDecoder       nec;
+    int8_t           lockedDecoder;  // -1 — автопоиск
+    uint32_t         edgeOverflows;
+    MemStats         mem;
+    CpuSample        cpu;
+    SchedStep        steps[4];
+    uint8_t          stepCount;
+    Scenario         scenarios[3];
+    SessionRecord    sessions[SESS_SLOTS];
+    uint8_t          sessionCount;   // sess_get(age) есть для age < sessionCount
+    uint32_t         timersNextMs;   // UINT32_MAX — таймеров нет
+    bool             scenarioBusy;   // scen_*() вернут false
+
+    // --- записанные вызовы ---
+    String   lastName, lastBleName, lastCod;
+    uint32_t lastHfpRate;
+    uint16_t lastProfile;
+    uint32_t deglitchUs;
+    bool     eventFrames;
+    uint32_t commands;               // bt1036_* действий (next/prev/…)
+    uint32_t toggles;
+    uint32_t sessClears;
+    uint32_t bridgeCloses;
+};
+
+extern MockBackend g_mock;
+extern bool g_debugMode;
+
+// Разумные значения по умолчанию (всё пусто/ноль, один шаг планировщика)
+void mock_reset();
+void mock_setMillis(uint32_t ms);
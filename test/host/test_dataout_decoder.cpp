@@ -0,0 +1,371 @@
+/**
+ * @file test_dataout_decoder.cpp
+ * @brief Host unit tests for src/dataout_decoder.cpp (Linux, g++)
+ *
+ * Pulse streams are built the way the DataOut edge ISR delivers them:
+ * levels strictly alternate, each pulse is (level, duration).
+ *
+ *   - VW DataOut and NEC frames through DataOutDecoderMux, the mux locking
+ *     onto the protocol that produces valid packets;
+ *   - NEC repeat code (counted, no packet) and a frame broken mid-way
+ *     (aborted, the next frame still decodes);
+ *   - PulseDeglitcher: '1' bits split by spikes below the limit are merged
+ *     and the packets recovered (`repaired` counted), a spike at the limit
+ *     is left alone, flushIdle() releases the last bit of a packet, limit 0
+ *     passes pulses through; replay of dataout_synth.h streams without and
+ *     with the filter.
+ *
+ * Build and run: make -C test/host
+ */
+
+#include "dataout_decoder.h"
+#include "dataout_synth.h"
+#include <cstdio>
+#include <vector>
+
+static int g_failed = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+    g_checks++; \
+    if (!(cond)) { g_failed++; std::printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); } \
+} while (0)
+
+struct Pulse {
+    bool     level;
+    uint32_t us;
+};
+typedef std::vector<Pulse> Stream;
+
+// Как vw_validatePacket() для RNS-MFD: адрес 0x53 0x2C, cmd + ~cmd = 0xFF
+static bool validate(const uint8_t pkt[4]) {
+    return pkt[0] == 0x53 && pkt[1] == 0x2C && (uint8_t)(pkt[2] + pkt[3]) == 0xFF;
+}
+
+static const uint8_t PKT_CD1[4]  = { 0x53, 0x2C, 0x0C, 0xF3 };
+static const uint8_t PKT_NEXT[4] = { 0x53, 0x2C, 0xF8, 0x07 };
+
+static uint8_t reverseBits(uint8_t b) {
+    uint8_t r = 0;
+    for (uint8_t i = 0; i < 8; ++i) if (b & (1 << i)) r |= (uint8_t)(0x80 >> i);
+    return r;
+}
+
+// VW DataOut: start LOW 4.57 ms, затем 32 бита MSB first (LOW 650 / 1770 µs),
+// между ними HIGH ~550 µs; после пакета линия в HIGH
+static void addVw(Stream &s, const uint8_t pkt[4]) {
+    s.push_back({ true, 20000 });
+    s.push_back({ false, 4570 });
+    for (uint8_t b = 0; b < 32; ++b) {
+        bool one = (pkt[b / 8] >> (7 - b % 8)) & 1;
+        s.push_back({ true, 550 });
+        s.push_back({ false, one ? 1770u : 650u });
+    }
+}
+
+// NEC: leader 9 ms HIGH → 4.5 ms LOW, затем 32 бита LSB first
+// (HIGH 560 / 1690 µs) с LOW ~560 µs между ними. Байты NEC — байты VW
+// с обратным порядком бит (0x53 0x2C ↔ addr 0xCA 0x34).
+// breakAt < 32 — бит с HIGH вне допуска (пакет обрывается)
+static void addNec(Stream &s, const uint8_t pkt[4], int breakAt = -1) {
+    s.push_back({ false, 20000 });
+    s.push_back({ true, 9000 });
+    s.push_back({ false, 4500 });
+    for (int b = 0; b < 32; ++b) {
+        bool one = (reverseBits(pkt[b / 8]) >> (b % 8)) & 1;
+        if (b > 0) s.push_back({ false, 560 });
+        s.push_back({ true, b == breakAt ? 3000u : (one ? 1690u : 560u) });
+    }
+}
+
+static void addNecRepeat(Stream &s) {
+    s.push_back({ false, 40000 });
+    s.push_back({ true, 9000 });
+    s.push_back({ false, 2250 });
+    s.push_back({ true, 560 });
+}
+
+struct Decoded {
+    std::vector<uint8_t> sources;
+    uint8_t last[4] = {};
+};
+
+static Decoded run(DataOutDecoderMux &mux, const Stream &s) {
+    Decoded d;
+    for (size_t i = 0; i < s.size(); ++i) {
+        uint8_t pkt[4], src = 0xFF;
+        if (mux.feed(s[i].level, s[i].us, pkt, src)) {
+            d.sources.push_back(src);
+            for (int k = 0; k < 4; ++k) d.last[k] = pkt[k];
+        }
+    }
+    return d;
+}
+
+static bool same(const uint8_t a[4], const uint8_t b[4]) {
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+}
+
+struct Rig {
+    VwDataOutDecoder  vw;
+    NecDecoder        nec;
+    DataOutDecoderMux mux;
+    Rig() {
+        mux.add(&vw);
+        mux.add(&nec);
+        mux.setValidator(validate);
+        mux.reset();
+    }
+};
+
+static void testVwFrames() {
+    Rig r;
+    Stream s;
+    addVw(s, PKT_CD1);
+    addVw(s, PKT_NEXT);
+    addVw(s, PKT_CD1);
+    Decoded d = run(r.mux, s);
+    CHECK(d.sources.size() == 3);
+    for (size_t i = 0; i < d.sources.size(); ++i) CHECK(d.sources[i] == 0);
+    CHECK(same(d.last, PKT_CD1));
+    CHECK(r.vw.stats.valid == 3);
+    CHECK(r.nec.stats.frames == 0);
+    CHECK(r.mux.locked() == 0);
+}
+
+static void testNecFrames() {
+    Rig r;
+    Stream s;
+    addNec(s, PKT_CD1);
+    Decoded d = run(r.mux, s);
+    CHECK(d.sources.size() == 1 && d.sources[0] == 1);
+    CHECK(same(d.last, PKT_CD1));
+    CHECK(r.nec.stats.frames == 1 && r.nec.stats.valid == 1);
+    CHECK(r.mux.locked() == -1);  // один пакет — ещё автопоиск
+
+    s.clear();
+    addNec(s, PKT_NEXT);
+    d = run(r.mux, s);
+    CHECK(d.sources.size() == 1);
+    CHECK(same(d.last, PKT_NEXT));
+    CHECK(r.mux.locked() == 1);
+    CHECK(r.mux.lockChanges() == 1);
+    CHECK(r.vw.stats.valid == 0);
+
+    // Залочен NEC — пакеты VW больше не отдаются
+    s.clear();
+    addVw(s, PKT_CD1);
+    d = run(r.mux, s);
+    CHECK(d.sources.empty());
+    CHECK(r.vw.stats.valid == 1);
+}
+
+static void testNecRepeat() {
+    Rig r;
+    Stream s;
+    addNec(s, PKT_CD1);
+    addNecRepeat(s);
+    addNecRepeat(s);
+    addNec(s, PKT_CD1);
+    Decoded d = run(r.mux, s);
+    CHECK(d.sources.size() == 2);
+    CHECK(r.nec.repeats == 2);
+    CHECK(r.nec.stats.frames == 2);
+    CHECK(r.nec.stats.aborted == 0);
+}
+
+static void testNecBroken() {
+    Rig r;
+    Stream s;
+    addNec(s, PKT_CD1, 17);  // HIGH 3 ms посреди пакета
+    Decoded d = run(r.mux, s);
+    CHECK(d.sources.empty());
+    CHECK(r.nec.stats.frames == 0);
+    CHECK(r.nec.stats.aborted == 1);
+
+    // Оборванный пакет не мешает следующему
+    s.clear();
+    addNec(s, PKT_NEXT);
+    d = run(r.mux, s);
+    CHECK(d.sources.size() == 1);
+    CHECK(same(d.last, PKT_NEXT));
+
+    // Битый разделитель между битами
+    s.clear();
+    addNec(s, PKT_CD1);
+    s[2 + 2 * 5].us = 1500;  // LOW перед битом 5
+    d = run(r.mux, s);
+    CHECK(d.sources.empty());
+    CHECK(r.nec.stats.aborted == 2);
+}
+
+// ---------- PulseDeglitcher ----------
+
+// Deglitch → mux, как vw_pollDecoders(). Без flushIdle(): в этих потоках
+// за последним LOW всегда идёт длинный HIGH, он и отдаёт отложенный LOW
+static Decoded runDeglitched(PulseDeglitcher &dg, DataOutDecoderMux &mux, const Stream &s) {
+    Decoded d;
+    for (size_t i = 0; i < s.size(); ++i) {
+        PulseDeglitcher::Pulse p[3];
+        uint8_t n = dg.feed(s[i].level, s[i].us, p);
+        for (uint8_t k = 0; k < n; ++k) {
+            uint8_t pkt[4], src = 0xFF;
+            if (mux.feed(p[k].level, p[k].us, pkt, src)) {
+                d.sources.push_back(src);
+                for (int j = 0; j < 4; ++j) d.last[j] = pkt[j];
+            }
+        }
+    }
+    return d;
+}
+
+// Каждый LOW '1' (1770 µs) разорван иголкой HIGH spikeUs
+static Stream splitOnes(const Stream &in, uint32_t spikeUs) {
+    Stream out;
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (!in[i].level && in[i].us == 1770) {
+            out.push_back({ false, 900 });
+            out.push_back({ true, spikeUs });
+            out.push_back({ false, 1770 - 900 - spikeUs });
+        } else {
+            out.push_back(in[i]);
+        }
+    }
+    return out;
+}
+
+static void testDeglitchRepairs() {
+    Stream clean;
+    addVw(clean, PKT_CD1);
+    addVw(clean, PKT_NEXT);
+    clean.push_back({ true, 30000 });
+    Stream s = splitOnes(clean, 20);
+    uint32_t ones = (uint32_t)(s.size() - clean.size()) / 2;
+    CHECK(ones > 0);
+
+    // Без фильтра пакеты теряются
+    Rig raw;
+    CHECK(run(raw.mux, s).sources.empty());
+
+    Rig r;
+    PulseDeglitcher dg;
+    dg.setLimit(80);
+    Decoded d = runDeglitched(dg, r.mux, s);
+    CHECK(d.sources.size() == 2);
+    CHECK(same(d.last, PKT_NEXT));
+    CHECK(dg.repaired == ones);
+    CHECK(r.vw.stats.invalid == 0);
+
+    // Склеенный LOW — сумма кусков и иголки
+    PulseDeglitcher::Pulse p[3];
+    PulseDeglitcher g2;
+    g2.setLimit(80);
+    CHECK(g2.feed(false, 900, p) == 0);
+    CHECK(g2.feed(true, 20, p) == 0);
+    CHECK(g2.feed(false, 850, p) == 0);
+    uint8_t n = g2.feed(true, 550, p);
+    CHECK(n == 2);
+    CHECK(n == 2 && !p[0].level && p[0].us == 1770 && p[1].level && p[1].us == 550);
+    CHECK(g2.repaired == 1);
+}
+
+static void testDeglitchAtLimit() {
+    PulseDeglitcher dg;
+    dg.setLimit(80);
+    PulseDeglitcher::Pulse p[3];
+    CHECK(dg.feed(false, 900, p) == 0);
+    uint8_t n = dg.feed(true, 80, p);  // не короче limit — настоящий HIGH
+    CHECK(n == 2);
+    CHECK(n == 2 && !p[0].level && p[0].us == 900 && p[1].level && p[1].us == 80);
+    CHECK(dg.feed(false, 790, p) == 0);
+    n = dg.feed(true, 550, p);
+    CHECK(n == 2 && p[0].us == 790);
+    CHECK(dg.repaired == 0);
+
+    // Поток с иголками ровно limit: пакеты так и остаются битыми
+    Stream clean;
+    addVw(clean, PKT_CD1);
+    clean.push_back({ true, 30000 });
+    Rig r;
+    PulseDeglitcher dg2;
+    dg2.setLimit(80);
+    CHECK(runDeglitched(dg2, r.mux, splitOnes(clean, 80)).sources.empty());
+    CHECK(dg2.repaired == 0);
+}
+
+static void testDeglitchFlushIdle() {
+    // Пакет без завершающего HIGH: последний LOW ждёт следующего фронта
+    Stream s;
+    addVw(s, PKT_CD1);
+    Rig r;
+    PulseDeglitcher dg;
+    dg.setLimit(80);
+    CHECK(runDeglitched(dg, r.mux, s).sources.empty());
+    CHECK(dg.pending());
+
+    PulseDeglitcher::Pulse p[1];
+    CHECK(dg.flushIdle(79, p) == 0);  // линия в HIGH меньше limit — ещё может быть иголка
+    CHECK(dg.pending());
+    uint8_t n = dg.flushIdle(80, p);
+    CHECK(n == 1);
+    CHECK(n == 1 && !p[0].level && p[0].us == 1770);  // бит 31 CD1: 0xF3 → '1'
+    CHECK(!dg.pending());
+    CHECK(dg.flushIdle(100000, p) == 0);
+
+    uint8_t pkt[4], src = 0xFF;
+    CHECK(r.mux.feed(p[0].level, p[0].us, pkt, src));
+    CHECK(same(pkt, PKT_CD1) && src == 0);
+}
+
+static void testDeglitchOff() {
+    PulseDeglitcher dg;
+    dg.setLimit(0);
+    Stream s = splitOnes([] { Stream c; addVw(c, PKT_CD1); return c; }(), 20);
+    for (size_t i = 0; i < s.size(); ++i) {
+        PulseDeglitcher::Pulse p[3];
+        uint8_t n = dg.feed(s[i].level, s[i].us, p);
+        CHECK(n == 1 && p[0].level == s[i].level && p[0].us == s[i].us);
+    }
+    CHECK(!dg.pending());
+    CHECK(dg.repaired == 0);
+}
+
+// Воспроизведение синтетических записей (как gen_dataout_capture +
+// cdc_capture): валидных пакетов без фильтра / с фильтром 80 µs
+static void testDeglitchReplay() {
+    static const uint32_t PERMILLE[3] = { 10, 30, 100 };
+    for (uint8_t i = 0; i < 3; ++i) {
+        SynthStats st;
+        std::vector<SynthPulse> syn = synthVwStream(40, PERMILLE[i], 20, 1, &st);
+        Stream s;
+        for (size_t k = 0; k < syn.size(); ++k) s.push_back({ syn[k].level, syn[k].us });
+
+        Rig off;
+        size_t without = run(off.mux, s).sources.size();
+        Rig on;
+        PulseDeglitcher dg;
+        dg.setLimit(80);
+        size_t with = runDeglitched(dg, on.mux, s).sources.size();
+
+        std::printf("  deglitch replay: %3u/1000 LOW bits spiked (%3u): valid packets without %2zu, with %2zu of %u\n",
+                    PERMILLE[i], st.spiked, without, with, st.packets);
+        CHECK(st.spiked > 0);
+        CHECK(with == st.packets);
+        CHECK(without < with);
+        CHECK(dg.repaired == st.spiked);
+    }
+}
+
+int main() {
+    testVwFrames();
+    testNecFrames();
+    testNecRepeat();
+    testNecBroken();
+    testDeglitchRepairs();
+    testDeglitchAtLimit();
+    testDeglitchFlushIdle();
+    testDeglitchOff();
+    testDeglitchReplay();
+    std::printf("dataout_decoder: %d checks, %d failed\n", g_checks, g_failed);
+    return g_failed ? 1 : 0;
+}
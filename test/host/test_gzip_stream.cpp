@@ -0,0 +1,206 @@
+/**
+ * @file test_gzip_stream.cpp
+ * @brief Host round-trip tests for src/gzip_stream.cpp (Linux, g++, zlib)
+ *
+ *   - round trip through zlib's gzip inflate: empty, random, repetitive
+ *     and log-like input, each written in chunks of 1, 7, 100, 2048, 4097
+ *     bytes and in one piece; bytesIn/bytesOut match;
+ *   - the output bound of one /api/logs/download pass (bt_webui.cpp,
+ *     LOG_DL_OUT): at most WINDOW input bytes per pass, finish() in a pass
+ *     of its own, on incompressible lines of any length.
+ *
+ * Build and run: make -C test/host
+ */
+
+#include "gzip_stream.h"
+#include <zlib.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int g_failed = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+    g_checks++; \
+    if (!(cond)) { g_failed++; std::printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); } \
+} while (0)
+
+typedef std::vector<uint8_t> Bytes;
+
+struct Capture {
+    Bytes    out;
+    size_t   pass = 0;     // байт в sink за текущий «проход»
+    size_t   maxPass = 0;
+};
+
+static void sink(const uint8_t *data, size_t len, void *ctx) {
+    Capture *c = (Capture *)ctx;
+    c->out.insert(c->out.end(), data, data + len);
+    c->pass += len;
+    if (c->pass > c->maxPass) c->maxPass = c->pass;
+}
+
+static bool gunzip(const Bytes &gz, Bytes &out) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) return false;
+    zs.next_in = const_cast<Bytes::value_type *>(gz.data());
+    zs.avail_in = (uInt)gz.size();
+    out.clear();
+    int rc;
+    do {
+        uint8_t buf[16384];
+        zs.next_out = buf;
+        zs.avail_out = sizeof(buf);
+        rc = inflate(&zs, Z_NO_FLUSH);
+        out.insert(out.end(), buf, buf + (sizeof(buf) - zs.avail_out));
+    } while (rc == Z_OK);
+    bool ok = rc == Z_STREAM_END && zs.avail_in == 0;
+    inflateEnd(&zs);
+    return ok;
+}
+
+static uint32_t g_rng = 1;
+static uint32_t rnd() {
+    g_rng = g_rng * 1664525u + 1013904223u;
+    return g_rng >> 8;
+}
+
+static Bytes randomBytes(size_t n) {
+    Bytes b(n);
+    for (size_t i = 0; i < n; ++i) b[i] = (uint8_t)rnd();
+    return b;
+}
+
+static Bytes repetitive(size_t n) {
+    Bytes b(n);
+    for (size_t i = 0; i < n; ++i) b[i] = i < n / 2 ? 'a' : "abcabd"[i % 6];
+    return b;
+}
+
+static Bytes logText(size_t n) {
+    static const char *const MSG[] = {
+        "[BT] +A2DPSTAT=3", "[CDC] === Transition: StatePlay (normal operation) ===",
+        "[PLAY] 34 be fe ff ff ff cf 3c", "[WEB] Client 2 connected", "[TRACK] sync hit 240 ms",
+    };
+    std::string s;
+    while (s.size() < n) {
+        char line[128];
+        snprintf(line, sizeof(line), "%10u %s\n", rnd() % 100000000, MSG[rnd() % 5]);
+        s += line;
+    }
+    s.resize(n);
+    return Bytes(s.begin(), s.end());
+}
+
+static Bytes compress(const Bytes &in, size_t chunk, GzipStream &gz, Capture &cap) {
+    gz.begin(sink, &cap);
+    for (size_t off = 0; off < in.size(); off += chunk) {
+        size_t n = in.size() - off < chunk ? in.size() - off : chunk;
+        gz.write(in.data() + off, n);
+    }
+    gz.finish();
+    return cap.out;
+}
+
+static void testRoundTrip() {
+    static GzipStream gz;  // ~6.5 KiB состояния — не на стеке
+    struct Input { const char *name; Bytes data; };
+    std::vector<Input> inputs;
+    inputs.push_back({ "empty", Bytes() });
+    inputs.push_back({ "one byte", Bytes(1, 'x') });
+    inputs.push_back({ "random", randomBytes(70000) });
+    inputs.push_back({ "repetitive", repetitive(70000) });
+    inputs.push_back({ "log", logText(70000) });
+    static const size_t CHUNKS[] = { 1, 7, 100, 2048, 4097, 1u << 30 };
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        for (size_t c = 0; c < sizeof(CHUNKS) / sizeof(CHUNKS[0]); ++c) {
+            Capture cap;
+            Bytes z = compress(inputs[i].data, CHUNKS[c], gz, cap);
+            Bytes back;
+            bool ok = gunzip(z, back);
+            if (!ok || back != inputs[i].data) {
+                std::printf("  round trip failed: %s, chunk %zu\n", inputs[i].name, CHUNKS[c]);
+            }
+            CHECK(ok);
+            CHECK(back == inputs[i].data);
+            CHECK(gz.bytesIn() == inputs[i].data.size());
+            CHECK(gz.bytesOut() == z.size());
+        }
+        Capture cap;
+        Bytes z = compress(inputs[i].data, 1u << 30, gz, cap);
+        std::printf("  %-10s %6zu -> %6zu B\n", inputs[i].name, inputs[i].data.size(), z.size());
+    }
+    // Сжатие реально работает
+    Capture a, b;
+    CHECK(compress(repetitive(70000), 100, gz, a).size() < 70000 / 20);
+    CHECK(compress(logText(70000), 100, gz, b).size() < 70000 / 2);
+}
+
+// Как logDownloadPoll(): за проход не больше WINDOW байт (строка режется),
+// finish() с 63-байтной строкой «overwritten» — отдельным проходом
+static const size_t NOTE_MAX = 64;
+static const size_t LOG_DL_OUT = (GzipStream::BUF_SIZE + NOTE_MAX) * 9 / 8 + GzipStream::OUT_SIZE + 1 + 8;
+
+static void testPassBound() {
+    static GzipStream gz;
+    for (uint32_t seed = 1; seed <= 50; ++seed) {
+        g_rng = seed;
+        std::vector<Bytes> lines;
+        for (int i = 0; i < 128; ++i) {
+            // Несжимаемые строки: байты ≥ 0x90 (9-битные литералы), длины до 5000
+            size_t len = rnd() % (seed & 1 ? 5000 : 300);
+            Bytes l(len);
+            for (size_t k = 0; k < len; ++k) l[k] = (uint8_t)(0x90 + rnd() % 0x6F);
+            lines.push_back(l);
+        }
+
+        Capture cap;
+        Bytes all;
+        gz.begin(sink, &cap);
+        size_t next = 0, off = 0;
+        while (next < lines.size()) {
+            cap.pass = 0;
+            size_t budget = GzipStream::WINDOW;
+            for (int k = 0; k < 8 && next < lines.size() && budget; ++k) {
+                const Bytes &l = lines[next];
+                if (off < l.size()) {
+                    size_t n = l.size() - off < budget ? l.size() - off : budget;
+                    gz.write(l.data() + off, n);
+                    all.insert(all.end(), l.data() + off, l.data() + off + n);
+                    off += n;
+                    budget -= n;
+                    if (off < l.size()) break;
+                }
+                if (!budget) break;
+                gz.write((const uint8_t *)"\n", 1);
+                all.push_back('\n');
+                budget--;
+                off = 0;
+                next++;
+            }
+        }
+        cap.pass = 0;
+        char note[NOTE_MAX];
+        memset(note, 0xFF, sizeof(note) - 1);
+        note[sizeof(note) - 1] = 0;
+        gz.write(note);
+        all.insert(all.end(), note, note + sizeof(note) - 1);
+        gz.finish();
+
+        if (cap.maxPass > LOG_DL_OUT) std::printf("  seed %u: pass output %zu > %zu\n", seed, cap.maxPass, LOG_DL_OUT);
+        CHECK(cap.maxPass <= LOG_DL_OUT);
+        Bytes back;
+        CHECK(gunzip(cap.out, back) && back == all);
+    }
+}
+
+int main() {
+    testRoundTrip();
+    testPassBound();
+    std::printf("gzip_stream: %d checks, %d failed\n", g_checks, g_failed);
+    return g_failed ? 1 : 0;
+}
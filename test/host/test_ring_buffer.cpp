@@ -0,0 +1,178 @@
+/**
+ * @file test_ring_buffer.cpp
+ * @brief Host unit tests for src/ring_buffer.h (Linux, g++)
+ *
+ *   - SpscRing: empty/full, wraparound (thousands of laps with every fill
+ *     level), overflow counting, front/drop/clear/reset;
+ *   - SpscRing: one producer thread, one consumer thread, order kept;
+ *   - MpscRing: full/empty and overflow counting, then a stress run —
+ *     several producer threads against one consumer, every element
+ *     delivered exactly once and in order per producer;
+ *   - OverwriteRing: oldest dropped, indexing oldest-first, pushed/oldestSeq.
+ *
+ * Build and run: make -C test/host
+ */
+
+#include "ring_buffer.h"
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static int g_failed = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+    g_checks++; \
+    if (!(cond)) { g_failed++; std::printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); } \
+} while (0)
+
+static void testSpscBasics() {
+    SpscRing<int, 4> r;
+    int v = -1;
+    CHECK(r.empty());
+    CHECK(!r.pop(v));
+    CHECK(r.front() == nullptr);
+    CHECK(!r.drop());
+
+    for (int i = 0; i < 4; ++i) CHECK(r.push(i));
+    CHECK(r.full());
+    CHECK(r.size() == 4);
+    CHECK(!r.push(99));
+    CHECK(!r.push(100));
+    CHECK(r.overflows() == 2);
+
+    CHECK(r.front() && *r.front() == 0);
+    CHECK(r.drop());
+    CHECK(r.pop(v) && v == 1);
+    CHECK(r.size() == 2);
+    r.clear();
+    CHECK(r.empty());
+    CHECK(r.pushed() == 4 && r.popped() == 4);
+
+    r.reset();
+    CHECK(r.pushed() == 0 && r.overflows() == 0);
+}
+
+static void testSpscWraparound() {
+    // Тысячи оборотов при любом заполнении: маска N-1 и разность head - tail
+    SpscRing<uint32_t, 8> r;
+    uint32_t next = 0, expect = 0;
+    for (int round = 0; round < 10000; ++round) {
+        uint32_t n = 1 + round % 8;
+        for (uint32_t i = 0; i < n; ++i) CHECK(r.push(next++));
+        CHECK(r.size() == n);
+        uint32_t v;
+        for (uint32_t i = 0; i < n; ++i) CHECK(r.pop(v) && v == expect++);
+        CHECK(r.empty());
+    }
+    CHECK(r.overflows() == 0);
+    CHECK(r.pushed() == next);
+}
+
+static void testSpscThreads() {
+    static SpscRing<uint32_t, 64> r;
+    const uint32_t COUNT = 2000000;
+    std::thread prod([] {
+        for (uint32_t i = 0; i < COUNT; ) {
+            if (r.push(i)) ++i;
+            else std::this_thread::yield();  // на одном ядре — отдать consumer'у
+        }
+    });
+    uint32_t expect = 0, v;
+    bool ordered = true;
+    while (expect < COUNT) {
+        if (!r.pop(v)) { std::this_thread::yield(); continue; }
+        if (v != expect) ordered = false;
+        expect++;
+    }
+    prod.join();
+    CHECK(ordered);
+    CHECK(r.empty());
+    CHECK(r.pushed() == COUNT && r.popped() == COUNT);
+}
+
+static void testMpscBasics() {
+    MpscRing<int, 4> r;
+    int v = -1;
+    CHECK(r.empty());
+    CHECK(!r.pop(v));
+    for (int i = 0; i < 4; ++i) CHECK(r.push(i));
+    CHECK(!r.push(4));
+    CHECK(r.overflows() == 1);
+    CHECK(r.size() == 4);
+    for (int i = 0; i < 4; ++i) CHECK(r.pop(v) && v == i);
+    CHECK(!r.pop(v));
+
+    // Через много оборотов (seq ячеек растут на N за оборот)
+    for (int i = 0; i < 100000; ++i) {
+        CHECK(r.push(i));
+        CHECK(r.pop(v) && v == i);
+    }
+    CHECK(r.empty());
+    CHECK(r.overflows() == 1);
+}
+
+// Элемент: номер producer'а в старших битах, порядковый — в младших
+static void testMpscStress() {
+    static MpscRing<uint32_t, 256> r;
+    const uint32_t PRODUCERS = 4;
+    const uint32_t PER = 500000;
+
+    std::vector<std::thread> prods;
+    for (uint32_t p = 0; p < PRODUCERS; ++p) {
+        prods.emplace_back([p] {
+            for (uint32_t i = 0; i < PER; ) {
+                if (r.push((p << 24) | i)) ++i;
+                else std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<uint32_t> next(PRODUCERS, 0);
+    uint32_t got = 0, v;
+    bool ordered = true, known = true;
+    while (got < PRODUCERS * PER) {
+        if (!r.pop(v)) { std::this_thread::yield(); continue; }
+        uint32_t p = v >> 24, i = v & 0xFFFFFF;
+        if (p >= PRODUCERS) { known = false; break; }
+        if (i != next[p]) ordered = false;
+        next[p] = i + 1;
+        got++;
+    }
+    for (auto &t : prods) t.join();
+
+    CHECK(known);
+    CHECK(ordered);  // ни потерь, ни повторов, порядок внутри producer'а
+    for (uint32_t p = 0; p < PRODUCERS; ++p) CHECK(next[p] == PER);
+    CHECK(!r.pop(v));
+    CHECK(r.overflows() > 0);  // кольцо на 256 при 4 producer'ах упиралось в full
+    std::printf("  mpsc stress: %u producers x %u, %u full-ring retries\n",
+                (unsigned)PRODUCERS, (unsigned)PER, (unsigned)r.overflows());
+}
+
+static void testOverwrite() {
+    OverwriteRing<int, 4> r;
+    CHECK(r.empty());
+    for (int i = 0; i < 3; ++i) r.push(i);
+    CHECK(r.size() == 3 && r[0] == 0 && r.newest() == 2);
+    for (int i = 3; i < 10; ++i) r.push(i);
+    CHECK(r.size() == 4);
+    CHECK(r[0] == 6 && r[3] == 9 && r.newest() == 9);
+    CHECK(r.pushed() == 10 && r.oldestSeq() == 6);
+    r.pushSlot() = 10;
+    CHECK(r[0] == 7 && r.newest() == 10);
+    r.clear();
+    CHECK(r.empty() && r.pushed() == 11);
+}
+
+int main() {
+    testSpscBasics();
+    testSpscWraparound();
+    testSpscThreads();
+    testMpscBasics();
+    testMpscStress();
+    testOverwrite();
+    std::printf("ring_buffer: %d checks, %d failed\n", g_checks, g_failed);
+    return g_failed ? 1 : 0;
+}
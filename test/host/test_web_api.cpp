@@ -0,0 +1,459 @@
+/**
+ * @file test_web_api.cpp
+ * @brief Host tests for src/web_api.cpp against mocked backends (Linux, g++)
+ *
+ *   - webApi_jsonEscape(): every byte value, control characters, quotes,
+ *     backslashes, valid and broken UTF-8 — the result embedded in "…"
+ *     must always be a valid JSON string;
+ *   - every route in webApi_routes(): called with no arguments, typical
+ *     arguments and hostile ones (quotes, control bytes, broken UTF-8,
+ *     huge/negative numbers, 4 KiB values), with hostile backend data
+ *     (track metadata, module version, scenario fail reasons) and extreme
+ *     counters. The answer must be 200 or 400, and every application/json
+ *     body must pass a strict RFC 8259 parser (UTF-8 checked, no NaN/inf,
+ *     nothing after the value);
+ *   - a few argument checks (400 on out-of-range values, setters reached).
+ *
+ * Build and run: make -C test/host
+ */
+
+#include "web_api.h"
+#include "mock_backends.h"
+#include <map>
+#include <string>
+#include <vector>
+
+static int g_failed = 0;
+static int g_checks = 0;
+
+#define CHECK(cond) do { \
+    g_checks++; \
+    if (!(cond)) { g_failed++; std::printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); } \
+} while (0)
+
+// ============================================================================
+// Строгий JSON (RFC 8259): true — разобрано всё, без хвоста
+// ============================================================================
+class JsonCheck {
+public:
+    explicit JsonCheck(const std::string &s) : m_s(s) {}
+
+    bool valid(std::string &why) {
+        m_pos = 0;
+        m_depth = 0;
+        m_why.clear();
+        bool ok = value() && (ws(), m_pos == m_s.size() || fail("trailing data"));
+        why = m_why + " at " + std::to_string(m_pos);
+        return ok;
+    }
+
+private:
+    bool fail(const char *why) {
+        if (m_why.empty()) m_why = why;
+        return false;
+    }
+    int peek() const { return m_pos < m_s.size() ? (uint8_t)m_s[m_pos] : -1; }
+    void ws() {
+        while (peek() == ' ' || peek() == '\t' || peek() == '\n' || peek() == '\r') m_pos++;
+    }
+    bool lit(const char *w) {
+        size_t n = strlen(w);
+        if (m_s.compare(m_pos, n, w) != 0) return fail("bad literal");
+        m_pos += n;
+        return true;
+    }
+
+    bool value() {
+        ws();
+        if (++m_depth > 64) return fail("too deep");
+        bool ok;
+        switch (peek()) {
+            case '{': ok = object(); break;
+            case '[': ok = array();  break;
+            case '"': ok = string(); break;
+            case 't': ok = lit("true");  break;
+            case 'f': ok = lit("false"); break;
+            case 'n': ok = lit("null");  break;
+            default:  ok = number();
+        }
+        m_depth--;
+        return ok;
+    }
+
+    bool object() {
+        m_pos++;
+        ws();
+        if (peek() == '}') { m_pos++; return true; }
+        for (;;) {
+            ws();
+            if (peek() != '"') return fail("key expected");
+            if (!string()) return false;
+            ws();
+            if (peek() != ':') return fail("':' expected");
+            m_pos++;
+            if (!value()) return false;
+            ws();
+            if (peek() == ',') { m_pos++; continue; }
+            if (peek() == '}') { m_pos++; return true; }
+            return fail("',' or '}' expected");
+        }
+    }
+
+    bool array() {
+        m_pos++;
+        ws();
+        if (peek() == ']') { m_pos++; return true; }
+        for (;;) {
+            if (!value()) return false;
+            ws();
+            if (peek() == ',') { m_pos++; continue; }
+            if (peek() == ']') { m_pos++; return true; }
+            return fail("',' or ']' expected");
+        }
+    }
+
+    bool number() {
+        size_t start = m_pos;
+        if (peek() == '-') m_pos++;
+        if (peek() == '0') m_pos++;
+        else if (peek() >= '1' && peek() <= '9') { while (isdigit(peek())) m_pos++; }
+        else return fail("value expected");
+        if (peek() == '.') {
+            m_pos++;
+            if (!isdigit(peek())) return fail("digit after '.'");
+            while (isdigit(peek())) m_pos++;
+        }
+        if (peek() == 'e' || peek() == 'E') {
+            m_pos++;
+            if (peek() == '+' || peek() == '-') m_pos++;
+            if (!isdigit(peek())) return fail("digit in exponent");
+            while (isdigit(peek())) m_pos++;
+        }
+        return m_pos > start;
+    }
+    static bool isdigit(int c) { return c >= '0' && c <= '9'; }
+    static bool isxdigit(int c) { return isdigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'); }
+
+    bool string() {
+        m_pos++;
+        for (;;) {
+            int c = peek();
+            if (c < 0) return fail("unterminated string");
+            if (c == '"') { m_pos++; return true; }
+            if (c < 0x20) return fail("raw control character in string");
+            if (c == '\\') {
+                m_pos++;
+                c = peek();
+                if (c == 'u') {
+                    for (int i = 1; i <= 4; ++i) {
+                        if (m_pos + i >= m_s.size() || !isxdigit((uint8_t)m_s[m_pos + i])) return fail("bad \\u escape");
+                    }
+                    m_pos += 5;
+                } else if (c >= 0 && strchr("\"\\/bfnrt", c)) {
+                    m_pos++;
+                } else {
+                    return fail("bad escape");
+                }
+                continue;
+            }
+            if (c < 0x80) { m_pos++; continue; }
+            if (!utf8()) return fail("invalid UTF-8");
+        }
+    }
+
+    // Одна кодовая точка UTF-8 (RFC 3629: без overlong, суррогатов, > U+10FFFF)
+    bool utf8() {
+        uint8_t c = (uint8_t)m_s[m_pos];
+        size_t n;
+        uint8_t lo = 0x80, hi = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF)      n = 1;
+        else if (c == 0xE0)              { n = 2; lo = 0xA0; }
+        else if (c == 0xED)              { n = 2; hi = 0x9F; }
+        else if (c >= 0xE1 && c <= 0xEF) n = 2;
+        else if (c == 0xF0)              { n = 3; lo = 0x90; }
+        else if (c == 0xF4)              { n = 3; hi = 0x8F; }
+        else if (c >= 0xF1 && c <= 0xF3) n = 3;
+        else return false;
+        if (m_pos + n >= m_s.size()) return false;
+        for (size_t i = 1; i <= n; ++i) {
+            uint8_t b = (uint8_t)m_s[m_pos + i];
+            if (i == 1 ? (b < lo || b > hi) : (b < 0x80 || b > 0xBF)) return false;
+        }
+        m_pos += n + 1;
+        return true;
+    }
+
+    const std::string &m_s;
+    size_t      m_pos = 0;
+    int         m_depth = 0;
+    std::string m_why;
+};
+
+static bool jsonValid(const String &body, const char *what) {
+    std::string s(body.c_str(), body.length());
+    std::string why;
+    if (JsonCheck(s).valid(why)) return true;
+    std::printf("  invalid JSON from %s: %s\n  %.300s\n", what, why.c_str(), s.c_str());
+    return false;
+}
+
+// ============================================================================
+// Запрос с аргументами из map
+// ============================================================================
+class MapRequest : public ApiRequest {
+public:
+    std::map<std::string, String> args;
+    String arg(const char *name) const override {
+        auto it = args.find(name);
+        return it == args.end() ? String() : it->second;
+    }
+    bool hasArg(const char *name) const override { return args.count(name) != 0; }
+};
+
+static String bytes(const char *s, size_t n) {
+    String r;
+    r.concat(s, n);
+    return r;
+}
+
+static std::vector<String> hostileStrings() {
+    std::vector<String> v;
+    v.push_back("");
+    v.push_back("plain");
+    v.push_back("\"quoted\" \\ back\\slash / slash");
+    v.push_back("line\nbreak\rcr\ttab\bbs\ffeed");
+    String ctl;
+    for (char c = 1; c < 0x20; ++c) ctl += c;
+    ctl += (char)0x7F;
+    v.push_back(ctl);
+    v.push_back(bytes("nul\0inside", 10));
+    v.push_back("\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 \xF0\x9F\x8E\xB5");  // "Привет 🎵"
+    v.push_back("caf\xE9 Latin-1");           // одиночный байт ≥0x80
+    v.push_back("cut \xD0");                  // обрезанная последовательность
+    v.push_back("\xC0\xAF overlong");
+    v.push_back("\xED\xA0\x80 surrogate");
+    v.push_back("\xF4\x90\x80\x80 > U+10FFFF");
+    v.push_back("\xFF\xFE\x80\xBF");
+    v.push_back("</script><script>alert(1)</script>");
+    v.push_back("-1");
+    v.push_back("99999999999999999999");
+    v.push_back("1e9");
+    v.push_back("0x10");
+    v.push_back("NaN");
+    String big;
+    for (int i = 0; i < 512; ++i) big += "\"\\\x01\xE9xyz";
+    v.push_back(big);
+    return v;
+}
+
+// ============================================================================
+// Тесты
+// ============================================================================
+static void testValidator() {
+    std::string why;
+    const char *good[] = { "{}", "[]", "{\"a\":[1,-0.5,2e10,true,null]}", "\"\\u00e9\xC3\xA9\"" };
+    const char *bad[]  = { "", "nan", "{\"a\":inf}", "{\"a\":1,}", "[01]", "\"\x01\"", "[1] x",
+                           "{\"a\" 1}", "\"\xE9\"", "\"\\x41\"", "1." };
+    for (const char *g : good) CHECK(JsonCheck(g).valid(why));
+    for (const char *b : bad)  CHECK(!JsonCheck(b).valid(why));
+}
+
+static void testEscapeAllBytes() {
+    // Каждый байт по отдельности и в окружении текста
+    for (int b = 1; b < 256; ++b) {
+        String s = bytes("a", 1);
+        s += (char)b;
+        s += "z";
+        String json = "\"" + webApi_jsonEscape(s) + "\"";
+        CHECK(jsonValid(json, "jsonEscape(byte)"));
+    }
+    String nul = "\"" + webApi_jsonEscape(bytes("\0", 1)) + "\"";
+    CHECK(nul == "\"\\u0000\"");
+
+    for (const String &s : hostileStrings()) {
+        CHECK(jsonValid("\"" + webApi_jsonEscape(s) + "\"", "jsonEscape(hostile)"));
+    }
+
+    // Обычный текст и корректный UTF-8 — без изменений
+    CHECK(webApi_jsonEscape("Track 01") == "Track 01");
+    String utf8 = "\xD0\x9F\xD1\x80\xD0\xB8 \xF0\x9F\x8E\xB5";
+    CHECK(webApi_jsonEscape(utf8) == utf8);
+    CHECK(webApi_jsonEscape("a\"b\\c\n") == "a\\\"b\\\\c\\n");
+    // Битый UTF-8 — U+FFFD на каждый негодный байт, остальное сохраняется
+    CHECK(webApi_jsonEscape("caf\xE9!") == "caf\\ufffd!");
+    CHECK(webApi_jsonEscape("\xD0") == "\\ufffd");
+    CHECK(webApi_jsonEscape("\xC0\xAF") == "\\ufffd\\ufffd");
+}
+
+static void fillHostileBackend(const String &s) {
+    g_mock.state = BTConnState::PLAYING;
+    g_mock.identity.valid = true;
+    g_mock.identity.version = s;
+    g_mock.identity.address = s;
+    g_mock.unsupported = s;
+    g_mock.track.title = s;
+    g_mock.track.artist = s;
+    g_mock.track.album = s;
+    g_mock.track.valid = true;
+    g_mock.scenarios[1].failReason = s.c_str();
+    g_mock.scenarios[1].status = ScStatus::FAILED;
+}
+
+static void fillExtremeCounters() {
+    const uint32_t MAX = 0xFFFFFFFFu;
+    g_mock.play.commands = MAX;
+    g_mock.tsync.hits = MAX;
+    g_mock.tsync.confirmMsSum = MAX;
+    g_mock.bridge.opens = 1;
+    g_mock.bridge.maxMs = MAX;
+    g_mock.bus.enabled = true;
+    g_mock.bus.framesChecked = MAX;
+    g_mock.bus.lastErrorMs = 1;
+    g_mock.latency.changes = 3;
+    g_mock.latency.sumUs = 0xFFFFFFFFFFull;
+    g_mock.latency.maxUs = MAX;
+    g_mock.latency.hist[0] = 1;
+    g_mock.latency.hist[CDC_LAT_BINS - 1] = 2;
+    g_mock.mem.freeHeap = MAX;
+    g_mock.mem.level = MemLevel::NO_CLIENTS;
+    g_mock.cpu.windowUs = MAX;
+    g_mock.cpu.load[0] = 100.0f;
+    g_mock.cpu.load[1] = 0.0f;
+    g_mock.cpu.dataOutIsrPct = 1e-7f;
+    g_mock.cpu.stepPct[0] = 99.99f;
+    g_mock.steps[0].runs = MAX;
+    g_mock.steps[0].totalRunUs = 0xFFFFFFFFFFFFull;
+    g_mock.timersNextMs = 0;
+    g_mock.sessionCount = 2;
+    g_mock.sessions[0].seq = MAX;
+    g_mock.sessions[0].timeToAudioMs = SESS_NO_AUDIO;
+    g_mock.sessions[1].resetReason = 0xFF;
+    g_mock.sessions[1].timeToAudioMs = 1234;
+    g_mock.lockedDecoder = 1;
+    g_mock.edgeOverflows = MAX;
+    g_mock.nec.stats.pulses = 1;
+    g_mock.nec.stats.cycles = MAX;
+    g_mock.nec.stats.maxCycles = MAX;
+    mock_setMillis(MAX);
+
+    // Настоящий декодер: классы импульсов с живыми mean/std/margins
+    uint8_t pkt[4];
+    uint32_t seed = 1;
+    for (int i = 0; i < 5000; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        g_mock.vw.feed((seed >> 16) & 1, (seed >> 8) % 12000, pkt);
+    }
+}
+
+static const char *const ARG_NAMES[] = {
+    "name", "ns", "lname", "ls", "cod", "rate", "cfg", "p", "a", "mg", "a2", "hf", "tx",
+    "act", "set", "event", "reset", "deglitch", "run", "n", "clear", "close"
+};
+
+static void callRoute(const ApiRoute &r, const MapRequest &req, const char *what) {
+    ApiResponse res;
+    CHECK(webApi_dispatch(r.path, req, res));
+    bool codeOk = res.code == 200 || res.code == 400;
+    if (!codeOk) std::printf("  %s %s: code %d\n", r.path, what, res.code);
+    CHECK(codeOk);
+    if (strcmp(res.contentType, "application/json") == 0) {
+        std::string label = std::string(r.path) + " " + what;
+        CHECK(jsonValid(res.body, label.c_str()));
+    } else {
+        CHECK(strcmp(res.contentType, "text/plain") == 0);
+        CHECK(res.body.length() > 0);
+    }
+}
+
+static void testRoutes() {
+    size_t count = 0;
+    const ApiRoute *routes = webApi_routes(count);
+    CHECK(count > 0);
+
+    std::vector<String> hostile = hostileStrings();
+    for (int backend = 0; backend < 3; ++backend) {
+        mock_reset();
+        mock_setMillis(1000);
+        if (backend == 1) fillExtremeCounters();
+        for (size_t h = 0; h < hostile.size(); ++h) {
+            if (backend == 2) fillHostileBackend(hostile[h]);
+            for (size_t i = 0; i < count; ++i) {
+                MapRequest none;
+                callRoute(routes[i], none, "no args");
+
+                // Аргумент за аргументом и все сразу
+                MapRequest all;
+                for (const char *a : ARG_NAMES) {
+                    MapRequest one;
+                    one.args[a] = hostile[h];
+                    callRoute(routes[i], one, a);
+                    all.args[a] = hostile[h];
+                }
+                callRoute(routes[i], all, "all args");
+            }
+        }
+    }
+
+    ApiResponse res;
+    MapRequest none;
+    CHECK(!webApi_dispatch("/api/nope", none, res));
+    CHECK(res.code == 0);
+}
+
+static ApiResponse call(const char *path, std::map<std::string, String> args = {}) {
+    MapRequest req;
+    req.args = args;
+    ApiResponse res;
+    webApi_dispatch(path, req, res);
+    return res;
+}
+
+static void testArguments() {
+    mock_reset();
+    CHECK(call("/api/cdc/signal", {{"deglitch", "401"}}).code == 400);
+    CHECK(call("/api/cdc/signal", {{"deglitch", "-1"}}).code == 400);
+    CHECK(call("/api/cdc/signal", {{"deglitch", "80"}}).code == 200 && g_mock.deglitchUs == 80);
+    CHECK(call("/api/cdc/profile", {{"set", "3"}}).code == 400);
+    CHECK(call("/api/sessions", {{"n", "0"}}).code == 400);
+    CHECK(call("/api/sessions", {{"n", "17"}}).code == 400);
+    CHECK(call("/api/sessions", {{"clear", "1"}}).code == 200 && g_mock.sessClears == 1);
+    CHECK(call("/api/scenarios", {{"run", "bogus"}}).code == 400);
+    g_mock.scenarioBusy = true;
+    CHECK(call("/api/scenarios", {{"run", "pairing"}}).body == "BUSY");
+
+    String name = "My \"Car\" \xE9";
+    CHECK(call("/api/set_basic", {{"name", name}, {"cod", "240404"}}).code == 200);
+    CHECK(g_mock.lastName == name && g_mock.lastCod == "240404");
+    CHECK(call("/api/cmd", {{"act", "playpause"}}).code == 200 && g_mock.toggles == 1);
+    CHECK(call("/api/cmd", {{"act", "rm -rf"}}).code == 200 && g_mock.commands == 0);
+
+    CHECK(call("/api/debug").body == "ON" && g_debugMode);
+    CHECK(call("/api/debug_status").body == "ON");
+
+    g_mock.bridge.opens = 1;
+    call("/api/bt/bridge", {{"close", "1"}});
+    CHECK(g_mock.bridgeCloses == 1);
+
+    // Событийные кадры: переключение сбрасывает статистику до/после
+    g_mock.latency.changes = 5;
+    CHECK(call("/api/cdc/latency", {{"event", "0"}}).code == 200);
+    CHECK(!g_mock.eventFrames && g_mock.latency.changes == 0);
+
+    // Декодеры DataOut: залоченный по имени, стоимость на импульс без переполнения
+    g_mock.lockedDecoder = 1;
+    g_mock.nec.stats.pulses = 2;
+    g_mock.nec.stats.cycles = 960;
+    ApiResponse dec = call("/api/cdc/decoders");
+    CHECK(dec.code == 200 && jsonValid(dec.body, "/api/cdc/decoders"));
+    CHECK(dec.body.indexOf("\"locked\":\"NEC\"") >= 0);
+    CHECK(dec.body.indexOf("\"cyclesPerEdge\":480,\"nsPerEdge\":2000") >= 0);
+}
+
+int main() {
+    testValidator();
+    testEscapeAllBytes();
+    testRoutes();
+    testArguments();
+    std::printf("web_api: %d checks, %d failed\n", g_checks, g_failed);
+    return g_failed ? 1 : 0;
+}
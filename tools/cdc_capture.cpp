@@ -0,0 +1,596 @@
+/**
+ * @file cdc_capture.cpp
+ * @brief Logic-analyzer capture importer and CDC bus timing validator (Linux)
+ *
+ * Reads a sigrok or Saleae CSV export of the SCK / MOSI / DataOut lines in a
+ * single streaming pass (one line in memory, any capture size) and checks it
+ * against the firmware's bus timing:
+ *   - SPI bytes from SCK/MOSI, SPI_MODE1 (sampled on the falling edge, MSB
+ *     first); SCK bit rate vs 62.5 kHz;
+ *   - gaps between bytes of a frame (last SCK edge of one byte to the
+ *     first of the next) vs the intended 874 µs;
+ *   - 8-byte frames, frame-to-frame period vs 50 ms, frames decoded the way
+ *     the firmware logs them (IDLE / PLAY CDx Tyy mm:ss / announce);
+ *   - DataOut button packets through the firmware's own decoders
+ *     (src/dataout_decoder.cpp: VW DataOut + NEC with the auto-detect mux),
+ *     plus the VW pulse-class margins shown on /api/cdc/signal.
+ *
+ * Accepted CSV:
+ *   - Saleae Logic: "Time [s],SCK,MOSI,DataOut", one row per transition;
+ *   - sigrok-cli -O csv (optionally :time=true): "; Samplerate: 1 MHz"
+ *     comment, channel header row, one row per sample.
+ * Without a time column the sample index and --rate (or the sigrok
+ * samplerate comment) give the time.
+ *
+ * Build:
+ *   g++ -O2 -std=gnu++11 -Isrc tools/cdc_capture.cpp src/dataout_decoder.cpp -o cdc_capture
+ *
+ * Usage:
+ *   cdc_capture [options] capture.csv        ("-" = stdin, e.g. from zcat)
+ *     --sck=COL --mosi=COL --dataout=COL    column name or 0-based index
+ *                                           (default: by name, else 0/1/2
+ *                                           after the time column)
+ *     --rate=HZ          sample rate when there is no time column
+ *     --spi-hz=62500     expected SCK rate (±5%)
+ *     --byte-gap=874     expected gap between bytes, µs
+ *     --gap-tol=150      allowed deviation of the byte gap, µs
+ *     --period=50        expected frame period, ms
+ *     --min-gap=20       closest allowed frame spacing, ms (event frames)
+ *     --deglitch=80      DataOut: merge LOW pulses split by HIGH spikes
+ *                        shorter than this, µs (0 = off; firmware default)
+ *     --frames           print every frame (default: only changed frames)
+ *     --quiet            summary only
+ *
+ * Exit status: 0 — everything within tolerance, 1 — violations, 2 — bad input.
+ */
+
+#include "dataout_decoder.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// Значения по умолчанию = профиль RNS-MFD (src/cdc_profile.h)
+struct Options {
+    const char *path       = nullptr;
+    const char *sckCol     = nullptr;
+    const char *mosiCol    = nullptr;
+    const char *dataOutCol = nullptr;
+    double      rateHz     = 0;
+    double      spiHz      = 62500;
+    uint32_t    byteGapUs  = 874;
+    uint32_t    gapTolUs   = 150;
+    uint32_t    periodMs   = 50;
+    uint32_t    minGapMs   = 20;
+    uint32_t    deglitchUs = 80;   // CDC_DEGLITCH_US
+    bool        allFrames  = false;
+    bool        quiet      = false;
+};
+
+static Options g_opt;
+static const int64_t NS_PER_US = 1000;
+static const int64_t NS_PER_MS = 1000000;
+
+// ---------------- Гистограмма (фиксированные бины) ----------------
+template <uint32_t BINS>
+struct Histogram {
+    uint32_t binWidth;
+    uint64_t count = 0;
+    uint64_t sum   = 0;
+    uint64_t min   = 0;
+    uint64_t max   = 0;
+    uint64_t bins[BINS] = {};
+
+    explicit Histogram(uint32_t width) : binWidth(width) {}
+
+    void add(uint64_t v) {
+        if (count == 0 || v < min) min = v;
+        if (v > max) max = v;
+        count++;
+        sum += v;
+        uint64_t b = v / binWidth;
+        bins[b < BINS ? b : BINS - 1]++;
+    }
+    double avg() const { return count ? (double)sum / count : 0; }
+    // Верхняя граница бина, в который попал перцентиль
+    uint64_t percentile(uint32_t pct) const {
+        if (!count) return 0;
+        uint64_t acc = 0;
+        for (uint32_t i = 0; i < BINS; ++i) {
+            acc += bins[i];
+            if (acc * 100 >= count * pct) return (uint64_t)(i + 1) * binWidth;
+        }
+        return max;
+    }
+};
+
+// ---------------- SPI + кадры ----------------
+struct SpiState {
+    // текущий байт
+    uint8_t  bit       = 0;
+    uint8_t  value     = 0;
+    int64_t  byteStart = 0;
+    int64_t  lastFall  = -1;
+    int64_t  prevByteEnd = -1;
+
+    // текущий кадр
+    uint8_t  frame[16];
+    uint8_t  frameLen   = 0;
+    int64_t  frameStart = 0;
+    int64_t  prevFrameStart = -1;
+    uint8_t  lastShown[16];
+    uint8_t  lastShownLen = 0;
+
+    // статистика
+    uint64_t bytes        = 0;
+    uint64_t partialBytes = 0;   // байт оборван (SCK замолчал посреди байта)
+    uint64_t gapViolations = 0;
+    uint64_t frames       = 0;
+    uint64_t badLength    = 0;
+    uint64_t badTrailer   = 0;
+    uint64_t idleFrames   = 0;
+    uint64_t playFrames   = 0;
+    uint64_t tooClose     = 0;   // ближе --min-gap
+    uint64_t late         = 0;   // дольше period + 50%
+
+    Histogram<400> bitNs{100};      // период SCK, нс (бины 100 нс, до 40 мкс)
+    Histogram<300> gapUs{10};       // пауза между байтами, мкс (бины 10 мкс, до 3 мс)
+    Histogram<250> periodMs{1};     // период кадров, мс
+};
+
+static SpiState g_spi;
+
+static uint8_t fromBCD(uint8_t bcd) { return (bcd >> 4) * 10 + (bcd & 0x0F); }
+
+static void printTime(int64_t ns) {
+    printf("%12.6f s  ", (double)ns / 1e9);
+}
+
+// Расшифровка как в логе прошивки (cdc_sendPackage)
+static void describeFrame(const uint8_t *f, uint8_t len, char *out, size_t outLen) {
+    out[0] = 0;
+    if (len != 8) {
+        snprintf(out, outLen, "BAD LENGTH %u", len);
+        return;
+    }
+    if (f[0] == 0x74) {
+        snprintf(out, outLen, "IDLE");
+    } else if (f[0] == 0x34) {
+        uint8_t b1 = f[1];
+        if (b1 >= 0x20 && b1 <= 0x2F) {
+            snprintf(out, outLen, "ANNOUNCE disc=0x%02X", b1);
+        } else if (f[3] == 0xFF && f[4] == 0xFF) {
+            snprintf(out, outLen, "PLAY CD%d T%d (init)", 0xBF - b1, 0xFF - f[2]);
+        } else {
+            snprintf(out, outLen, "PLAY CD%d T%d %02d:%02d mode=%02X",
+                     0xBF - b1, fromBCD(0xFF - f[2]), fromBCD(0xFF - f[3]),
+                     fromBCD(0xFF - f[4]), f[5]);
+        }
+    } else {
+        snprintf(out, outLen, "cmd 0x%02X", f[0]);
+    }
+}
+
+static void finishFrame() {
+    SpiState &s = g_spi;
+    if (s.frameLen == 0) return;
+    s.frames++;
+
+    bool ok = true;
+    if (s.frameLen != 8) {
+        s.badLength++;
+        ok = false;
+    } else if (s.frame[0] == 0x74) {
+        s.idleFrames++;
+        if (s.frame[7] != 0x7C) { s.badTrailer++; ok = false; }
+    } else if (s.frame[0] == 0x34) {
+        s.playFrames++;
+        if (s.frame[7] != 0x3C) { s.badTrailer++; ok = false; }
+    }
+
+    if (s.prevFrameStart >= 0) {
+        int64_t dt = s.frameStart - s.prevFrameStart;
+        s.periodMs.add((uint64_t)(dt / NS_PER_MS));
+        if (dt < (int64_t)g_opt.minGapMs * NS_PER_MS) s.tooClose++;
+        if (dt > (int64_t)g_opt.periodMs * NS_PER_MS * 3 / 2) s.late++;
+    }
+    s.prevFrameStart = s.frameStart;
+
+    bool changed = s.frameLen != s.lastShownLen || memcmp(s.frame, s.lastShown, s.frameLen) != 0;
+    if (!g_opt.quiet && (g_opt.allFrames || changed || !ok)) {
+        char desc[64];
+        describeFrame(s.frame, s.frameLen, desc, sizeof(desc));
+        printTime(s.frameStart);
+        printf("SPI ");
+        for (uint8_t i = 0; i < s.frameLen; ++i) printf("%02X ", s.frame[i]);
+        printf(" %s%s\n", desc, ok ? "" : "  <-- !");
+    }
+    memcpy(s.lastShown, s.frame, s.frameLen);
+    s.lastShownLen = s.frameLen;
+    s.frameLen = 0;
+}
+
+static void spiByte(uint8_t b, int64_t start, int64_t end) {
+    SpiState &s = g_spi;
+    s.bytes++;
+
+    // Пауза между байтами одного кадра; длинная пауза — новый кадр
+    int64_t frameGapNs = (int64_t)g_opt.periodMs * NS_PER_MS / 5;  // 10 мс при 50 мс
+    if (s.prevByteEnd < 0 || start - s.prevByteEnd > frameGapNs) {
+        finishFrame();
+        s.frameStart = start;
+    } else {
+        uint64_t gap = (uint64_t)((start - s.prevByteEnd) / NS_PER_US);
+        s.gapUs.add(gap);
+        if (gap + g_opt.gapTolUs < g_opt.byteGapUs || gap > g_opt.byteGapUs + g_opt.gapTolUs) {
+            s.gapViolations++;
+        }
+    }
+    s.prevByteEnd = end;
+    if (s.frameLen < sizeof(s.frame)) s.frame[s.frameLen++] = b;
+}
+
+// SPI_MODE1 (CPOL=0, CPHA=1): данные выставляются по фронту, читаются по спаду
+static void sckEdge(bool level, bool mosi, int64_t t) {
+    SpiState &s = g_spi;
+    // Больше 10 битовых периодов без тактов посреди байта — байт оборван
+    int64_t stallNs = (int64_t)(10e9 / g_opt.spiHz);
+
+    if (level) {
+        if (s.bit > 0 && s.lastFall >= 0 && t - s.lastFall > stallNs) {
+            s.partialBytes++;
+            s.bit = 0;
+        }
+        if (s.bit == 0) {
+            s.byteStart = t;
+            s.value = 0;
+        }
+        return;
+    }
+    if (s.bit > 0 && s.lastFall >= 0) s.bitNs.add((uint64_t)(t - s.lastFall));
+    s.lastFall = t;
+    s.value = (uint8_t)((s.value << 1) | (mosi ? 1 : 0));
+    if (++s.bit == 8) {
+        s.bit = 0;
+        spiByte(s.value, s.byteStart, t);
+    }
+}
+
+// ---------------- DataOut (декодеры прошивки) ----------------
+static PulseDeglitcher   g_deglitch;
+static VwDataOutDecoder  g_vw;
+static NecDecoder        g_nec;
+static DataOutDecoderMux g_mux;
+static int64_t           g_lastDoEdge = -1;
+static uint64_t          g_doPackets  = 0;
+
+// Как vw_validatePacket<CdcProfileRnsMfd>
+static bool validatePacket(const uint8_t pkt[4]) {
+    if (pkt[0] != 0x53 || pkt[1] != 0x2C) return false;
+    if ((uint8_t)(pkt[2] + pkt[3]) != 0xFF) return false;
+    return (pkt[2] & 0x03) == 0;
+}
+
+// Таблица CdcProfileRnsMfd::decode
+static const char *buttonName(uint8_t code) {
+    switch (code) {
+        case 0xF8: return "NEXT_TRACK";
+        case 0x78: return "PREV_TRACK";
+        case 0x0C: return "DISC_1";
+        case 0x8C: return "DISC_2";
+        case 0x4C: return "DISC_3";
+        case 0xCC: return "DISC_4";
+        case 0x2C: return "DISC_5";
+        case 0xAC: return "DISC_6";
+        case 0xA0: return "SCAN_TOGGLE";
+        case 0xE0: return "RANDOM_TOGGLE";
+        case 0x08: return "PLAY (Gamma)";
+        case 0x10: return "STOP (Gamma/Skoda)";
+        default:   return "?";
+    }
+}
+
+static void feedDecoders(const PulseDeglitcher::Pulse *p, uint8_t n, int64_t t) {
+    for (uint8_t i = 0; i < n; ++i) {
+        uint8_t pkt[4];
+        uint8_t source = 0;
+        if (!g_mux.feed(p[i].level, p[i].us, pkt, source)) continue;
+        g_doPackets++;
+        if (!g_opt.quiet) {
+            printTime(t);
+            printf("DataOut %02X %02X %02X %02X  %s via %s\n", pkt[0], pkt[1], pkt[2], pkt[3],
+                   buttonName(pkt[2]), g_mux.decoder(source)->name());
+        }
+    }
+}
+
+// Фронт DataOut: закончился импульс уровня !level
+static void dataOutEdge(bool level, int64_t t) {
+    if (g_lastDoEdge >= 0) {
+        int64_t us = (t - g_lastDoEdge) / NS_PER_US;
+        if (us > 0x7FFFFFFF) us = 0x7FFFFFFF;
+        PulseDeglitcher::Pulse p[3];
+        uint8_t n = g_deglitch.feed(!level, (uint32_t)us, p);
+        feedDecoders(p, n, t);
+    }
+    g_lastDoEdge = t;
+}
+
+// ---------------- CSV ----------------
+static const int MAX_COLS = 64;
+
+static int splitCsv(char *line, char **fields) {
+    int n = 0;
+    char *p = line;
+    while (n < MAX_COLS) {
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '"') {  // Saleae берёт имена в кавычки
+            p++;
+            fields[n++] = p;
+            while (*p && *p != '"') p++;
+            if (*p) *p++ = 0;
+            while (*p && *p != ',') p++;
+        } else {
+            fields[n++] = p;
+            while (*p && *p != ',') p++;
+        }
+        if (!*p) break;
+        *p++ = 0;
+    }
+    // хвостовые пробелы
+    for (int i = 0; i < n; ++i) {
+        char *e = fields[i] + strlen(fields[i]);
+        while (e > fields[i] && isspace((unsigned char)e[-1])) *--e = 0;
+    }
+    return n;
+}
+
+static bool isNumber(const char *s) {
+    if (*s == '-' || *s == '+') s++;
+    return isdigit((unsigned char)*s) || (*s == '.' && isdigit((unsigned char)s[1]));
+}
+
+// "; Samplerate: 1 MHz" (sigrok)
+static void parseSigrokComment(const char *line) {
+    const char *p = strstr(line, "Samplerate:");
+    if (!p || g_opt.rateHz > 0) return;
+    p += 11;
+    char *end;
+    double v = strtod(p, &end);
+    while (*end == ' ') end++;
+    if (!strncasecmp(end, "GHz", 3))      v *= 1e9;
+    else if (!strncasecmp(end, "MHz", 3)) v *= 1e6;
+    else if (!strncasecmp(end, "kHz", 3)) v *= 1e3;
+    if (v > 0) g_opt.rateHz = v;
+}
+
+static int findColumn(const char *want, char **names, int n, const char *const *guesses, int fallback) {
+    if (want) {
+        if (isNumber(want)) return atoi(want);
+        for (int i = 0; i < n; ++i) {
+            if (names && !strcasecmp(names[i], want)) return i;
+        }
+        return -2;  // задано, но не найдено
+    }
+    if (names) {
+        for (const char *const *g = guesses; *g; ++g) {
+            for (int i = 0; i < n; ++i) {
+                if (strcasestr(names[i], *g)) return i;
+            }
+        }
+    }
+    return fallback < n ? fallback : -1;
+}
+
+static void usage() {
+    fprintf(stderr,
+            "usage: cdc_capture [--sck=COL] [--mosi=COL] [--dataout=COL] [--rate=HZ]\n"
+            "                   [--spi-hz=62500] [--byte-gap=874] [--gap-tol=150]\n"
+            "                   [--period=50] [--min-gap=20] [--deglitch=80] [--frames] [--quiet]\n"
+            "                   capture.csv|-\n");
+}
+
+static bool parseArgs(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *eq = strchr(a, '=');
+        const char *v = eq ? eq + 1 : "";
+        if (!strncmp(a, "--sck=", 6))           g_opt.sckCol = v;
+        else if (!strncmp(a, "--mosi=", 7))     g_opt.mosiCol = v;
+        else if (!strncmp(a, "--dataout=", 10)) g_opt.dataOutCol = v;
+        else if (!strncmp(a, "--rate=", 7))     g_opt.rateHz = atof(v);
+        else if (!strncmp(a, "--spi-hz=", 9))   g_opt.spiHz = atof(v);
+        else if (!strncmp(a, "--byte-gap=", 11)) g_opt.byteGapUs = (uint32_t)atoi(v);
+        else if (!strncmp(a, "--gap-tol=", 10)) g_opt.gapTolUs = (uint32_t)atoi(v);
+        else if (!strncmp(a, "--period=", 9))   g_opt.periodMs = (uint32_t)atoi(v);
+        else if (!strncmp(a, "--min-gap=", 10)) g_opt.minGapMs = (uint32_t)atoi(v);
+        else if (!strncmp(a, "--deglitch=", 11)) g_opt.deglitchUs = (uint32_t)atoi(v);
+        else if (!strcmp(a, "--frames"))        g_opt.allFrames = true;
+        else if (!strcmp(a, "--quiet"))         g_opt.quiet = true;
+        else if (a[0] == '-' && a[1])           return false;
+        else                                    g_opt.path = a;
+    }
+    return g_opt.path && g_opt.spiHz > 0 && g_opt.periodMs > 0;
+}
+
+// ---------------- Отчёт ----------------
+static bool report() {
+    bool pass = true;
+    const SpiState &s = g_spi;
+
+    printf("\n== SPI clock ==\n");
+    if (s.bitNs.count) {
+        double avgHz = 1e9 / s.bitNs.avg();
+        double minHz = 1e9 / (double)s.bitNs.max;
+        double maxHz = 1e9 / (double)s.bitNs.min;
+        bool ok = fabs(avgHz - g_opt.spiHz) <= g_opt.spiHz * 0.05;
+        pass &= ok;
+        printf("bits %llu, rate avg %.2f kHz (min %.2f, max %.2f), target %.2f kHz ±5%%  %s\n",
+               (unsigned long long)s.bitNs.count, avgHz / 1e3, minHz / 1e3, maxHz / 1e3,
+               g_opt.spiHz / 1e3, ok ? "OK" : "FAIL");
+    } else {
+        printf("no SCK activity\n");
+    }
+    printf("bytes %llu, partial %llu\n", (unsigned long long)s.bytes, (unsigned long long)s.partialBytes);
+
+    printf("\n== Inter-byte gap (target %u us ±%u) ==\n", g_opt.byteGapUs, g_opt.gapTolUs);
+    if (s.gapUs.count) {
+        bool ok = s.gapViolations == 0;
+        pass &= ok;
+        printf("gaps %llu, min %llu, avg %.1f, p50 <=%llu, p99 <=%llu, max %llu us; out of range %llu  %s\n",
+               (unsigned long long)s.gapUs.count, (unsigned long long)s.gapUs.min, s.gapUs.avg(),
+               (unsigned long long)s.gapUs.percentile(50), (unsigned long long)s.gapUs.percentile(99),
+               (unsigned long long)s.gapUs.max, (unsigned long long)s.gapViolations, ok ? "OK" : "FAIL");
+    } else {
+        printf("no multi-byte frames\n");
+    }
+
+    printf("\n== Frames (period %u ms, min spacing %u ms) ==\n", g_opt.periodMs, g_opt.minGapMs);
+    printf("frames %llu (IDLE %llu, PLAY %llu), bad length %llu, bad trailer %llu\n",
+           (unsigned long long)s.frames, (unsigned long long)s.idleFrames, (unsigned long long)s.playFrames,
+           (unsigned long long)s.badLength, (unsigned long long)s.badTrailer);
+    if (s.periodMs.count) {
+        printf("period min %llu, avg %.1f, p50 <=%llu, p99 <=%llu, max %llu ms; closer than %u ms: %llu, late (>%u ms): %llu\n",
+               (unsigned long long)s.periodMs.min, s.periodMs.avg(),
+               (unsigned long long)s.periodMs.percentile(50), (unsigned long long)s.periodMs.percentile(99),
+               (unsigned long long)s.periodMs.max, g_opt.minGapMs, (unsigned long long)s.tooClose,
+               g_opt.periodMs * 3 / 2, (unsigned long long)s.late);
+    }
+    bool framesOk = s.badLength == 0 && s.badTrailer == 0 && s.tooClose == 0;
+    pass &= framesOk;
+    printf("frames %s\n", framesOk ? "OK" : "FAIL");
+
+    printf("\n== DataOut ==\n");
+    printf("packets %llu, locked decoder: %s, deglitch <%u us: %u repaired\n",
+           (unsigned long long)g_doPackets,
+           g_mux.locked() >= 0 ? g_mux.decoder(g_mux.locked())->name() : "none",
+           g_deglitch.limit(), g_deglitch.repaired);
+    for (uint8_t i = 0; i < g_mux.count(); ++i) {
+        const DecoderStats &d = g_mux.decoder(i)->stats;
+        printf("  %-10s pulses %u, frames %u, valid %u, invalid %u, aborted %u\n",
+               g_mux.decoder(i)->name(), d.pulses, d.frames, d.valid, d.invalid, d.aborted);
+    }
+    static const char *const CLASS_NAMES[PC_COUNT] = { "glitch", "noise", "zero", "one", "start" };
+    static const char *const HEALTH[] = { "NO_DATA", "GOOD", "MARGINAL", "BAD" };
+    printf("  VW signal %s, long LOW %u\n", HEALTH[(int)g_vw.health()], g_vw.longLow);
+    for (uint8_t c = 0; c < PC_COUNT; ++c) {
+        const PulseClassStats &st = g_vw.pulseClass[c];
+        if (!st.count) continue;
+        printf("    %-6s n=%u mean %.1f std %.1f [%u..%u] us, margin %d/%d us\n", CLASS_NAMES[c],
+               st.count, st.mean(), st.stddev(), st.min, st.max,
+               g_vw.marginLowUs((PulseClass)c), g_vw.marginHighUs((PulseClass)c));
+    }
+
+    printf("\nRESULT: %s\n", pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+int main(int argc, char **argv) {
+    if (!parseArgs(argc, argv)) {
+        usage();
+        return 2;
+    }
+    FILE *in = strcmp(g_opt.path, "-") ? fopen(g_opt.path, "r") : stdin;
+    if (!in) {
+        perror(g_opt.path);
+        return 2;
+    }
+    static char iobuf[1 << 20];
+    setvbuf(in, iobuf, _IOFBF, sizeof(iobuf));
+
+    g_mux.add(&g_vw);
+    g_mux.add(&g_nec);
+    g_mux.setValidator(validatePacket);
+    g_mux.reset();
+    g_deglitch.setLimit(g_opt.deglitchUs);
+
+    static char line[4096];
+    char *fields[MAX_COLS];
+    bool     haveLayout = false;
+    int      timeCol = -1, sckCol = -1, mosiCol = -1, doCol = -1;
+    bool     havePrev = false;
+    bool     prevSck = false, prevDo = false;
+    uint64_t sample = 0;
+    uint64_t rows = 0;
+
+    while (fgets(line, sizeof(line), in)) {
+        size_t len = strlen(line);
+        while (len && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = 0;
+        if (!len) continue;
+        if (line[0] == ';' || line[0] == '#') {
+            parseSigrokComment(line);
+            continue;
+        }
+        int n = splitCsv(line, fields);
+
+        if (!haveLayout) {
+            haveLayout = true;
+            bool header = !isNumber(fields[0]);
+            char **names = header ? fields : nullptr;
+            if (header && !strncasecmp(fields[0], "time", 4)) timeCol = 0;
+            int base = timeCol + 1;
+            static const char *const SCK[]  = { "sck", "clk", "clock", nullptr };
+            static const char *const MOSI[] = { "mosi", nullptr };
+            static const char *const DOUT[] = { "dataout", "data_out", "dout", nullptr };
+            sckCol  = findColumn(g_opt.sckCol,     names, n, SCK,  base);
+            mosiCol = findColumn(g_opt.mosiCol,    names, n, MOSI, base + 1);
+            doCol   = findColumn(g_opt.dataOutCol, names, n, DOUT, base + 2);
+            if (sckCol == -2 || mosiCol == -2 || doCol == -2) {
+                fprintf(stderr, "column not found (see --sck/--mosi/--dataout)\n");
+                return 2;
+            }
+            if (timeCol < 0 && g_opt.rateHz <= 0) {
+                fprintf(stderr, "no time column: pass --rate=HZ\n");
+                return 2;
+            }
+            fprintf(stderr, "columns: time=%d sck=%d mosi=%d dataout=%d%s\n",
+                    timeCol, sckCol, mosiCol, doCol,
+                    timeCol < 0 ? " (time from sample index)" : "");
+            if (header) continue;
+        }
+
+        int64_t t;
+        if (timeCol >= 0) {
+            if (timeCol >= n) continue;
+            t = (int64_t)llround(strtod(fields[timeCol], nullptr) * 1e9);
+        } else {
+            t = (int64_t)((double)sample * 1e9 / g_opt.rateHz);
+        }
+        sample++;
+        rows++;
+
+        bool sck  = sckCol  >= 0 && sckCol  < n && atoi(fields[sckCol])  != 0;
+        bool mosi = mosiCol >= 0 && mosiCol < n && atoi(fields[mosiCol]) != 0;
+        bool dout = doCol   >= 0 && doCol   < n && atoi(fields[doCol])   != 0;
+        if (!havePrev) {
+            havePrev = true;
+            prevSck = sck; prevDo = dout;
+            continue;
+        }
+        // В одной строке спад SCK читает уже новый MOSI
+        if (sckCol >= 0 && sck != prevSck) {
+            sckEdge(sck, mosi, t);
+            prevSck = sck;
+        }
+        if (doCol >= 0 && dout != prevDo) {
+            dataOutEdge(dout, t);
+            prevDo = dout;
+        }
+    }
+    if (in != stdin) fclose(in);
+
+    if (g_spi.bit) g_spi.partialBytes++;
+    finishFrame();
+    {
+        // Конец записи: линия "в HIGH навсегда" — отложенный LOW окончателен
+        PulseDeglitcher::Pulse p[1];
+        feedDecoders(p, g_deglitch.flushIdle(UINT32_MAX, p), g_lastDoEdge);
+    }
+
+    fprintf(stderr, "%llu rows\n", (unsigned long long)rows);
+    if (!rows) return 2;
+    return report() ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Stand-in UDP syslog collector for the firmware's log shipping.
+
+Listens for the datagrams sent by src/syslog_ship.cpp (several RFC 3164
+lines per datagram, '\\n'-separated), prints every line with the receive
+time and optionally appends it to a file. The PID field of each line is
+the firmware's running line number, so the collector can tell:
+
+  lost      lines missing between two received ones (dropped on the
+            device because its queue was full, or a datagram lost on
+            the network / failed to send)
+  reboots   the line number went back to a small value
+  [MET]     metrics lines are counted separately
+
+A summary is printed every --stats seconds and on Ctrl-C.
+
+Usage:
+  tools/syslog_collector.py                   # port 5514, no root needed
+  tools/syslog_collector.py --port 514 --out shop.log
+  then on the WiFi page: Collector IP = this machine, Port = 5514
+
+Standard library only.
+"""
+
+import argparse
+import re
+import signal
+import socket
+import sys
+import time
+
+LINE_RE = re.compile(rb"^<(\d{1,3})>(\S+) (\S+?)\[(\d+)\]: ?(.*)$")
+SEVERITY = ["emerg", "alert", "crit", "err", "warning", "notice", "info", "debug"]
+
+
+class Sender:
+    """Per-source counters: lines, datagrams, gaps in the line number."""
+
+    def __init__(self):
+        self.datagrams = 0
+        self.bytes = 0
+        self.lines = 0
+        self.metrics = 0
+        self.unparsed = 0
+        self.lost = 0
+        self.reordered = 0
+        self.reboots = 0
+        self.next_seq = None
+        self.max_per_datagram = 0
+
+    def seen(self, seq):
+        if self.next_seq is None:
+            pass
+        elif seq == self.next_seq:
+            pass
+        elif seq > self.next_seq:
+            self.lost += seq - self.next_seq
+        elif seq < 16 and self.next_seq > 64:
+            self.reboots += 1        # номер строки начался заново
+        else:
+            self.reordered += 1
+            return
+        self.next_seq = seq + 1
+
+
+def summary(senders, started):
+    secs = max(time.time() - started, 1e-9)
+    for addr, s in senders.items():
+        total = s.lines + s.lost
+        loss = 100.0 * s.lost / total if total else 0.0
+        print(f"# {addr}: {s.datagrams} datagrams ({s.bytes / secs:.0f} B/s), "
+              f"{s.lines} lines (max {s.max_per_datagram}/datagram), "
+              f"metrics {s.metrics}, lost {s.lost} ({loss:.2f}%), "
+              f"reordered {s.reordered}, reboots {s.reboots}, unparsed {s.unparsed}",
+              file=sys.stderr, flush=True)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("--bind", default="0.0.0.0")
+    ap.add_argument("--port", type=int, default=5514)
+    ap.add_argument("--out", help="append received lines to this file")
+    ap.add_argument("--stats", type=float, default=60.0, help="summary period, s (0 = only at exit)")
+    ap.add_argument("--quiet", action="store_true", help="don't print lines, only summaries")
+    args = ap.parse_args()
+
+    # Ctrl-C and kill (SIGTERM, SIGINT of a background job) both end with a summary
+    def stop(*_):
+        raise KeyboardInterrupt
+    signal.signal(signal.SIGTERM, stop)
+    signal.signal(signal.SIGINT, stop)
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+    sock.bind((args.bind, args.port))
+    sock.settimeout(1.0)
+    out = open(args.out, "a", encoding="utf-8") if args.out else None
+    print(f"# listening on udp {args.bind}:{args.port}", file=sys.stderr, flush=True)
+
+    senders = {}
+    started = last_stats = time.time()
+    try:
+        while True:
+            try:
+                data, (host, _) = sock.recvfrom(65535)
+            except socket.timeout:
+                data = None
+            now = time.time()
+            if data:
+                s = senders.setdefault(host, Sender())
+                s.datagrams += 1
+                s.bytes += len(data)
+                stamp = time.strftime("%Y-%m-%d %H:%M:%S", time.localtime(now)) + f".{int(now * 1000) % 1000:03d}"
+                count = 0
+                for raw in data.split(b"\n"):
+                    if not raw:
+                        continue
+                    count += 1
+                    s.lines += 1
+                    m = LINE_RE.match(raw)
+                    if m:
+                        pri, seq, msg = int(m.group(1)), int(m.group(4)), m.group(5)
+                        s.seen(seq)
+                        if msg.startswith(b"[MET]"):
+                            s.metrics += 1
+                        sev = SEVERITY[pri & 7]
+                        text = f"{stamp} {host} {sev:<5} #{seq} {msg.decode('utf-8', 'replace')}"
+                    else:
+                        s.unparsed += 1
+                        text = f"{stamp} {host} ?     {raw.decode('utf-8', 'replace')}"
+                    if not args.quiet:
+                        print(text, flush=True)
+                    if out:
+                        out.write(text + "\n")
+                s.max_per_datagram = max(s.max_per_datagram, count)
+                if out:
+                    out.flush()
+            if args.stats and now - last_stats >= args.stats:
+                last_stats = now
+                summary(senders, started)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        summary(senders, started)
+        if out:
+            out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""WebSocket fan-out benchmark: a swarm of WS clients against /api/bench/ws.
+
+Opens N WebSocket clients to the firmware (or any server implementing the
+same /api/bench/ws endpoint), starts a benchmark run for each requested
+rate and reports, per client count and rate:
+
+  lost      messages a client never received (sequence gaps), worst client
+  delay     per-message delay above the best-case one (p50/p99/max, ms),
+            worst client; the firmware stamps micros(), the client its own
+            clock, the minimum difference is taken as the fixed offset
+  bcast     firmware-side cost of one broadcast to all clients (avg/max, us)
+  fails     sendTXT() failures on the firmware side
+  loop Hz   main loop passes per second: before / average / worst second
+
+Usage:
+  tools/ws_swarm.py 192.168.4.1 --clients 1,2,3,5 --rates 10,50,200 --secs 10
+
+Hardware only: the WebSocket fan-out lives in bt_webui.cpp (WebSocketsServer),
+which the host build in test/host does not include, and what is measured here
+(lwIP buffers, WiFi driver, loop rate) exists only on the ESP32.
+
+Standard library only (minimal RFC 6455 client, text frames).
+"""
+
+import argparse
+import asyncio
+import base64
+import json
+import os
+import struct
+import sys
+import time
+import urllib.request
+
+
+class WsClient:
+    """Minimal WebSocket client: handshake, unmasked server frames, ping/close."""
+
+    def __init__(self, idx):
+        self.idx = idx
+        self.reader = None
+        self.writer = None
+        self.received = {}          # seq -> delay (s, includes clock offset)
+        self.closed = False
+
+    async def connect(self, host, port):
+        self.reader, self.writer = await asyncio.open_connection(host, port)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.writer.write((
+            "GET / HTTP/1.1\r\n"
+            f"Host: {host}:{port}\r\n"
+            "Upgrade: websocket\r\n"
+            "Connection: Upgrade\r\n"
+            f"Sec-WebSocket-Key: {key}\r\n"
+            "Sec-WebSocket-Version: 13\r\n\r\n").encode())
+        await self.writer.drain()
+        status = await self.reader.readline()
+        if b" 101 " not in status:
+            raise ConnectionError(f"client {self.idx}: handshake failed: {status!r}")
+        while (await self.reader.readline()) not in (b"\r\n", b""):
+            pass
+
+    def _send_frame(self, opcode, payload=b""):
+        mask = os.urandom(4)
+        hdr = bytes([0x80 | opcode, 0x80 | len(payload)]) + mask
+        self.writer.write(hdr + bytes(b ^ mask[i % 4] for i, b in enumerate(payload)))
+
+    async def run(self):
+        try:
+            while True:
+                b0, b1 = await self.reader.readexactly(2)
+                n = b1 & 0x7F
+                if n == 126:
+                    n = struct.unpack(">H", await self.reader.readexactly(2))[0]
+                elif n == 127:
+                    n = struct.unpack(">Q", await self.reader.readexactly(8))[0]
+                if b1 & 0x80:
+                    await self.reader.readexactly(4)   # сервер не маскирует, но на всякий случай
+                payload = await self.reader.readexactly(n)
+                now = time.monotonic()
+                opcode = b0 & 0x0F
+                if opcode == 0x9:
+                    self._send_frame(0xA, payload)
+                elif opcode == 0x8:
+                    break
+                elif opcode == 0x1 and payload.startswith(b"[WSB] "):
+                    parts = payload.split(b" ", 3)
+                    seq, fw_us = int(parts[1]), int(parts[2])
+                    self.received[seq] = now - fw_us / 1e6
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        self.closed = True
+
+    def close(self):
+        if self.writer and not self.closed:
+            try:
+                self._send_frame(0x8)
+                self.writer.close()
+            except Exception:
+                pass
+
+
+def http_get_json(url):
+    with urllib.request.urlopen(url, timeout=5) as r:
+        return json.loads(r.read().decode())
+
+
+def percentile(sorted_vals, p):
+    if not sorted_vals:
+        return 0.0
+    return sorted_vals[min(len(sorted_vals) - 1, int(len(sorted_vals) * p / 100))]
+
+
+def client_stats(client, sent):
+    """(lost, p50, p99, max) delay above the client's best message, ms."""
+    got = [d for s, d in client.received.items() if s < sent]
+    lost = sent - len(got)
+    if not got:
+        return lost, 0.0, 0.0, 0.0
+    base = min(got)
+    rel = sorted((d - base) * 1000 for d in got)
+    return lost, percentile(rel, 50), percentile(rel, 99), rel[-1]
+
+
+async def run_step(args, clients, rate):
+    loop = asyncio.get_running_loop()
+    base = f"http://{args.host}:{args.http_port}/api/bench/ws"
+    for c in clients:
+        c.received.clear()
+    await loop.run_in_executor(
+        None, http_get_json, f"{base}?start={args.secs}&rate={rate}&size={args.size}")
+    await asyncio.sleep(args.secs)
+    while True:
+        res = await loop.run_in_executor(None, http_get_json, base)
+        if not res["running"]:
+            break
+        await asyncio.sleep(0.5)
+    await asyncio.sleep(args.drain)    # хвост ещё в TCP
+    return res
+
+
+def print_row(n, rate, res, clients):
+    sent = res["sent"]
+    worst = [client_stats(c, sent) for c in clients]
+    lost = max(w[0] for w in worst)
+    p50 = max(w[1] for w in worst)
+    p99 = max(w[2] for w in worst)
+    dmax = max(w[3] for w in worst)
+    f = res["fanout"]
+    dead = sum(1 for c in clients if c.closed)
+    print(f"{n:7d} {rate:5d} {sent:6d} {lost:6d} "
+          f"{p50:7.1f} {p99:7.1f} {dmax:7.1f} "
+          f"{f['avgUs']:7d} {f['maxUs']:7d} {f['sendFails']:6d} "
+          f"{res['loopHzBefore']:7d} {res['loopHzAvg']:7d} {res['loopHzMin']:7d}"
+          + (f"  ({dead} dropped)" if dead else ""))
+    sys.stdout.flush()
+
+
+async def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("host")
+    ap.add_argument("--clients", default="1,2,3,5", help="client counts, comma separated")
+    ap.add_argument("--rates", default="10,50,200", help="messages/s, comma separated")
+    ap.add_argument("--size", type=int, default=128, help="message size, bytes")
+    ap.add_argument("--secs", type=int, default=10, help="seconds per run")
+    ap.add_argument("--drain", type=float, default=1.0, help="wait after a run, s")
+    ap.add_argument("--http-port", type=int, default=80)
+    ap.add_argument("--ws-port", type=int, default=81)
+    args = ap.parse_args()
+
+    counts = [int(x) for x in args.clients.split(",")]
+    rates = [int(x) for x in args.rates.split(",")]
+
+    print(f"# {args.host}, {args.size} B messages, {args.secs} s per run")
+    print("clients  rate   sent   lost  p50 ms  p99 ms  max ms  "
+          "bcastUs  maxUs  fails  loopHz    avg     min")
+    clients = []
+    tasks = []
+    try:
+        for n in counts:
+            while len(clients) < n:
+                c = WsClient(len(clients))
+                await c.connect(args.host, args.ws_port)
+                clients.append(c)
+                tasks.append(asyncio.create_task(c.run()))
+            await asyncio.sleep(1.0)        # повтор истории лога при подключении
+            for rate in rates:
+                res = await run_step(args, clients[:n], rate)
+                print_row(n, rate, res, clients[:n])
+    finally:
+        for c in clients:
+            c.close()
+        for t in tasks:
+            t.cancel()
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass